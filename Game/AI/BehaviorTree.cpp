@@ -0,0 +1,137 @@
+#include "BehaviorTree.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+namespace
+{
+
+/**
+ * Returns the index of a name in a list of names, or the size of the list if it isn't there
+ */
+size_t FindName(std::vector<std::string> const& names, std::string const& name)
+{
+    return std::find(names.begin(), names.end(), name) - names.begin();
+}
+
+} // namespace
+
+BehaviorTree::Blackboards::Blackboards(size_t capacity)
+    : _running(capacity, NONE),
+    _runningTicks(capacity, 0)
+{}
+
+void BehaviorTree::Blackboards::Reset(size_t agent)
+{
+    _running[agent] = NONE;
+    _runningTicks[agent] = 0;
+}
+
+void BehaviorTree::Blackboards::Save(ByteBuffer& buffer, size_t agent) const
+{
+    buffer.Write(_running[agent]);
+    buffer.Write(_runningTicks[agent]);
+}
+
+void BehaviorTree::Blackboards::Load(ByteBuffer& buffer, size_t agent)
+{
+    _running[agent] = buffer.Read<uint32_t>();
+    _runningTicks[agent] = buffer.Read<uint32_t>();
+}
+
+BehaviorTree::BehaviorTree(
+    std::string const& filename,
+    std::vector<std::string> const& conditionNames,
+    std::vector<std::string> const& actionNames)
+{
+    std::ifstream file(filename);
+    if (!file)
+    {
+        throw "Error: Cannot load behavior tree from file: " + filename;
+    }
+
+    // Nodes whose subtrees are still open, and the indentation of each
+    std::vector<uint32_t> open;
+    std::vector<size_t> indents;
+    std::string line;
+    while (std::getline(file, line))
+    {
+        std::istringstream lineStream(line);
+        std::string kind;
+        if (!(lineStream >> kind) || kind[0] == '#')
+        {
+            continue;
+        }
+
+        // Subtrees indented as deep as this line, or deeper, end before it
+        size_t const indent = line.find_first_not_of(" \t");
+        while (!indents.empty() && indents.back() >= indent)
+        {
+            _nodes[open.back()].end = (uint32_t)_nodes.size();
+            open.pop_back();
+            indents.pop_back();
+        }
+        if (open.empty() && !_nodes.empty())
+        {
+            throw "Error: Behavior tree has more than one root: " + filename;
+        }
+
+        Node node{Type::Selector, 0, 0.f, open.empty() ? NONE : open.back(), 0};
+        if (node.parent != NONE
+            && _nodes[node.parent].type != Type::Selector && _nodes[node.parent].type != Type::Sequence)
+        {
+            throw "Error: Behavior tree has a child under a leaf: " + filename;
+        }
+
+        if (kind == "sequence")
+        {
+            node.type = Type::Sequence;
+        }
+        else if (kind == "if" || kind == "unless" || kind == "do")
+        {
+            std::string name;
+            lineStream >> name;
+            std::vector<std::string> const& names = kind == "do" ? actionNames : conditionNames;
+            size_t const leaf = FindName(names, name);
+            if (leaf == names.size())
+            {
+                throw "Error: Unknown condition or action " + name + " in behavior tree: " + filename;
+            }
+            node.type = kind == "do" ? Type::Action : kind == "if" ? Type::Condition : Type::InvertedCondition;
+            node.leaf = (uint8_t)leaf;
+            lineStream >> node.argument;
+        }
+        else if (kind != "selector")
+        {
+            throw "Error: Unknown node " + kind + " in behavior tree: " + filename;
+        }
+
+        open.push_back((uint32_t)_nodes.size());
+        indents.push_back(indent);
+        _nodes.push_back(node);
+    }
+    while (!open.empty())
+    {
+        _nodes[open.back()].end = (uint32_t)_nodes.size();
+        open.pop_back();
+    }
+
+    if (_nodes.empty())
+    {
+        throw "Error: Behavior tree has no nodes: " + filename;
+    }
+    // Ticking goes down into the first child of every composite, so there has to be one
+    for (uint32_t n = 0; n < _nodes.size(); n++)
+    {
+        if ((_nodes[n].type == Type::Selector || _nodes[n].type == Type::Sequence) && _nodes[n].end == n + 1)
+        {
+            throw "Error: Behavior tree has a composite node without children: " + filename;
+        }
+    }
+}
+
+size_t BehaviorTree::GetNodesCount() const
+{
+    return _nodes.size();
+}
@@ -0,0 +1,241 @@
+#pragma once
+
+#include "../Serialization/ByteBuffer.h"
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * A class for a behavior tree shared by many agents, loaded from a data file.
+ * 
+ * The tree is compiled into a single array of nodes in depth-first order,
+ * where the children of a composite node follow it, each child's subtree right after the previous one's,
+ * so ticking walks forward through contiguous memory, and leaves are dispatched with a switch,
+ * without any virtual calls.
+ * The state of each agent lives in blackboards, which hold one array per field, indexed by agent.
+ * An action that takes several ticks leaves its index in its agent's blackboard,
+ * and the next tick resumes from it, instead of entering the tree at the root again.
+ * 
+ * Each line of the file is either empty, a comment starting with '#', or a node,
+ * whose children are the lines below it that are indented deeper:
+ * 
+ *  - "selector" tries its children in order, until one of them doesn't fail,
+ *  - "sequence" runs its children in order, until one of them doesn't succeed,
+ *  - "if <condition> [argument]" succeeds if the condition holds, and fails otherwise,
+ *  - "unless <condition> [argument]" succeeds if the condition doesn't hold,
+ *  - "do <action> [argument]" runs an action, which may take several ticks.
+ * 
+ * Names of conditions and actions are given by whoever ticks the tree, and so is their meaning.
+ */
+class BehaviorTree
+{
+
+  public:
+
+    /// Result of ticking a node
+    enum class Status : uint8_t
+    {
+        Success,
+        Failure,
+        Running
+    };
+
+    /// Index of no node, for agents that aren't running any action
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    /**
+     * States of agents ticking a tree, with an array for each field.
+     * Agents are numbered from 0, up to the capacity.
+     */
+    class Blackboards
+    {
+
+        friend class BehaviorTree;
+
+      public:
+
+        /**
+         * Creates blackboards of agents that aren't running any action
+         * 
+         * @param[in] capacity
+         *  Number of agents
+         */
+        Blackboards(size_t capacity);
+
+        /**
+         * Forgets what an agent was running, so it enters the tree at the root on its next tick
+         * 
+         * @param[in] agent
+         *  Index of the agent
+         */
+        void Reset(size_t agent);
+
+        /**
+         * Writes the state of an agent to a buffer
+         * 
+         * @param[in] buffer
+         *  Buffer to write to
+         * @param[in] agent
+         *  Index of the agent
+         */
+        void Save(ByteBuffer& buffer, size_t agent) const;
+
+        /**
+         * Reads the state of an agent from a buffer
+         * 
+         * @param[in] buffer
+         *  Buffer to read from, positioned where Save wrote
+         * @param[in] agent
+         *  Index of the agent
+         */
+        void Load(ByteBuffer& buffer, size_t agent);
+
+      private: /* variables */
+
+        /// Action that each agent is running, or NONE
+        std::vector<uint32_t> _running;
+
+        /// Number of ticks for which each agent has been running its action
+        std::vector<uint32_t> _runningTicks;
+    };
+
+  public:
+
+    /**
+     * Loads a tree from a file
+     * 
+     * @param[in] filename
+     *  Name of the file with the tree
+     * @param[in] conditionNames
+     *  Names of the conditions, the index of a name being the condition passed to the context
+     * @param[in] actionNames
+     *  Names of the actions, the index of a name being the action passed to the context
+     */
+    BehaviorTree(
+        std::string const& filename,
+        std::vector<std::string> const& conditionNames,
+        std::vector<std::string> const& actionNames);
+
+    /**
+     * Ticks the tree for an agent, from the action it is running, or from the root.
+     * 
+     * @param[in] blackboards
+     *  Blackboards of the agents ticking the tree
+     * @param[in] agent
+     *  Index of the agent
+     * @param[in] context
+     *  Object giving leaves their meaning, which has the functions
+     *  bool Check(uint8_t condition, float argument),
+     *  and Status Act(uint8_t action, float argument, uint32_t ticks),
+     *  where ticks is the number of ticks for which the action has already been running
+     * 
+     * @return status of the root, or Running if an action is still running
+     */
+    template <class Context>
+    Status Tick(Blackboards& blackboards, size_t agent, Context& context) const;
+
+    /**
+     * Returns the number of nodes of the tree
+     */
+    size_t GetNodesCount() const;
+
+  private:
+
+    /// Kinds of nodes
+    enum class Type : uint8_t
+    {
+        Selector,
+        Sequence,
+        Condition,
+        InvertedCondition,
+        Action
+    };
+
+    /// A node of the tree, whose subtree is the range of nodes from it to its end
+    struct Node
+    {
+        Type type;
+
+        /// Condition or action of a leaf
+        uint8_t leaf;
+
+        /// Argument of a leaf
+        float argument;
+
+        /// Index of the parent, NONE for the root
+        uint32_t parent;
+
+        /// Index after the last node of the subtree, where the next sibling starts
+        uint32_t end;
+    };
+
+  private: /* variables */
+
+    /// Nodes in depth-first order, the root being the first one
+    std::vector<Node> _nodes;
+};
+
+template <class Context>
+BehaviorTree::Status BehaviorTree::Tick(Blackboards& blackboards, size_t agent, Context& context) const
+{
+    // A running action is resumed, otherwise the tree is entered at the root
+    uint32_t node = blackboards._running[agent];
+    uint32_t ticks = blackboards._runningTicks[agent];
+    if (node == NONE)
+    {
+        node = 0;
+        ticks = 0;
+    }
+    blackboards._running[agent] = NONE;
+    blackboards._runningTicks[agent] = 0;
+
+    for (;;)
+    {
+        // Composites start with their first child, which follows them
+        while (_nodes[node].type == Type::Selector || _nodes[node].type == Type::Sequence)
+        {
+            node++;
+        }
+
+        Node const& leaf = _nodes[node];
+        Status status;
+        if (leaf.type == Type::Action)
+        {
+            status = context.Act(leaf.leaf, leaf.argument, ticks);
+            if (status == Status::Running)
+            {
+                blackboards._running[agent] = node;
+                blackboards._runningTicks[agent] = ticks + 1;
+                return status;
+            }
+            // Only the resumed action has been running before, the following ones start fresh
+            ticks = 0;
+        }
+        else
+        {
+            bool const holds = context.Check(leaf.leaf, leaf.argument);
+            status = holds == (leaf.type == Type::Condition) ? Status::Success : Status::Failure;
+        }
+
+        // Go up until a composite has the next child to try, or the root decides
+        for (;;)
+        {
+            uint32_t const parent = _nodes[node].parent;
+            if (parent == NONE)
+            {
+                return status;
+            }
+            // Selectors are decided by a success, sequences by a failure
+            bool const decided = (_nodes[parent].type == Type::Selector) == (status == Status::Success);
+            uint32_t const next = _nodes[node].end;
+            if (!decided && next < _nodes[parent].end)
+            {
+                node = next;
+                break;
+            }
+            node = parent;
+        }
+    }
+}
@@ -0,0 +1,333 @@
+#include "MctsPlanner.h"
+
+#include "../Geometry/Geometry.hpp"
+#include "../Random/RandomPurposes.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+
+// The opponent moves in one of eight directions or stands still, and punches or waits, on each step
+size_t const MOVE_DIRECTIONS_COUNT = 9;
+size_t const ACTIONS_COUNT = MOVE_DIRECTIONS_COUNT * 2;
+
+// Action taken when nothing has been planned, standing still and waiting
+uint8_t const IDLE_ACTION = 0;
+
+// Number of ticks for which an action is taken
+size_t const STEP_TICKS = 6;
+
+// Number of random steps played after the tree runs out in a rollout
+size_t const ROLLOUT_STEPS = 4;
+
+// The search goes at most this many steps down the tree
+size_t const MAX_DEPTH = 16;
+
+// Maximum number of nodes in the tree
+size_t const MAX_NODES = 1 << 15;
+
+// How much the search explores actions that haven't been tried much, against the best actions so far
+float const EXPLORATION = 1.4f;
+
+// How much the distance between the fighters at the end of a rollout counts against it, so the opponent closes in
+float const DISTANCE_WEIGHT = 0.1f;
+
+// In rollouts the player is assumed to punch on every this many ticks
+uint64_t const PLAYER_PUNCH_PERIOD = 20;
+
+// Memory of a snapshot of the planned match, which has a single enemy
+size_t const PLANNER_SNAPSHOT_CAPACITY = 1024 * 1024;
+
+/**
+ * Returns the unit vector of a direction of movement, or a zero vector for standing still
+ */
+sf::Vector2f GetDirection(size_t direction)
+{
+    if (direction == 0)
+    {
+        return sf::Vector2f(0.f, 0.f);
+    }
+    float const angle = (direction - 1) * 3.14159265f / 4.f;
+    return sf::Vector2f(std::cos(angle), std::sin(angle));
+}
+
+} // namespace
+
+namespace FaceFight
+{
+
+MctsPlanner::MctsPlanner(MatchSettings const& settings, MatchAssets const& assets, std::chrono::microseconds budget)
+    : _budget(budget),
+    _cloneAssets(assets),
+    _speed(settings.parameters.enemySpeed),
+    _threadPool(settings.workersCount),
+    _state(PLANNER_SNAPSHOT_CAPACITY),
+    _nodes(MAX_NODES),
+    _spareNodes(MAX_NODES),
+    _nodesCount(0),
+    _rolloutValues(_threadPool.GetThreadsCount()),
+    _playerHealth(0),
+    _opponentHealth(0),
+    _size(settings.size),
+    _action(IDLE_ACTION),
+    _tickOfStep(0),
+    _random(settings.seed),
+    _tick(0),
+    _tickRollouts(0),
+    _stats{}
+{
+    _cloneAssets.playerFaceTexture = nullptr;
+    _cloneAssets.enemyFaceTexture = nullptr;
+    _cloneAssets.fistTexture = nullptr;
+
+    // Each thread plays its rollouts on its own clone, which only has to hold the same pools as the match
+    MatchSettings cloneSettings = settings;
+    cloneSettings.workersCount = 0;
+    for (size_t t = 0; t < _threadPool.GetThreadsCount(); t++)
+    {
+        _clones.emplace_back(new Match(cloneSettings, _cloneAssets));
+        _cloneStates.emplace_back(new ByteBuffer(PLANNER_SNAPSHOT_CAPACITY));
+    }
+
+    Reset();
+}
+
+FighterInput MctsPlanner::Plan(Match const& match)
+{
+    sf::Clock thinkClock;
+
+    if (_tickOfStep == STEP_TICKS)
+    {
+        TakeStep();
+    }
+
+    // Every clone starts from the match as it is on this tick
+    _state.Clear();
+    match.SaveSnapshot(_state);
+    for (std::unique_ptr<ByteBuffer>& cloneState : _cloneStates)
+    {
+        cloneState->Clear();
+        cloneState->WriteArray(_state.GetData(), _state.GetSize());
+    }
+    _playerHealth = match.GetPlayer().GetHealth();
+    _opponentHealth = match.GetOpponent().GetHealth();
+    _tick = match.GetTick();
+    _tickRollouts = 0;
+
+    // At least one iteration is run, so the tree grows however small the budget is
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point const deadline = Clock::now() + _budget;
+    do
+    {
+        Iterate();
+    }
+    while (Clock::now() < deadline && match.GetOpponent().IsAlive() && match.GetPlayer().IsAlive());
+
+    FighterInput const input = GetInput(match, _action, _tickOfStep);
+    _tickOfStep++;
+
+    _stats.rolloutsCount = _tickRollouts;
+    _stats.nodesCount = _nodesCount;
+    _stats.thinkTime = thinkClock.getElapsedTime();
+    return input;
+}
+
+void MctsPlanner::Reset()
+{
+    _nodes[0] = Node{0, 0, 0.f, false};
+    _nodesCount = 1;
+    // The next tick starts a new step
+    _tickOfStep = STEP_TICKS;
+}
+
+MctsPlanner::Stats const& MctsPlanner::GetStats() const
+{
+    return _stats;
+}
+
+void MctsPlanner::Iterate()
+{
+    // Go down the tree, and expand the leaf where it ends, if there is room
+    uint8_t path[MAX_DEPTH];
+    uint32_t pathNodes[MAX_DEPTH + 1];
+    size_t depth = 0;
+    uint32_t node = 0;
+    pathNodes[0] = node;
+    while (depth < MAX_DEPTH)
+    {
+        if (!_nodes[node].expanded)
+        {
+            if (_nodesCount + ACTIONS_COUNT > _nodes.size())
+            {
+                break;
+            }
+            _nodes[node].firstChild = (uint32_t)_nodesCount;
+            _nodes[node].expanded = true;
+            for (size_t a = 0; a < ACTIONS_COUNT; a++)
+            {
+                _nodes[_nodesCount++] = Node{0, 0, 0.f, false};
+            }
+        }
+
+        uint32_t const child = SelectChild(node);
+        path[depth] = (uint8_t)(child - _nodes[node].firstChild);
+        depth++;
+        pathNodes[depth] = child;
+        node = child;
+
+        // The rollout starts from a node that hasn't been tried yet
+        if (_nodes[child].visits == 0)
+        {
+            break;
+        }
+    }
+
+    // Every thread runs a rollout from the leaf
+    size_t const rolloutsCount = _rolloutValues.size();
+    _threadPool.ParallelFor(rolloutsCount, [&](size_t begin, size_t end) {
+        for (size_t r = begin; r < end; r++)
+        {
+            _rolloutValues[r] = Rollout(r, path, depth);
+        }
+    }, 1);
+
+    float totalValue = 0.f;
+    for (float const value : _rolloutValues)
+    {
+        totalValue += value;
+    }
+    for (size_t d = 0; d <= depth; d++)
+    {
+        _nodes[pathNodes[d]].visits += (uint32_t)rolloutsCount;
+        _nodes[pathNodes[d]].totalValue += totalValue;
+    }
+    _tickRollouts += rolloutsCount;
+}
+
+float MctsPlanner::Rollout(size_t rollout, uint8_t const* path, size_t depth)
+{
+    // Clones are picked by the planner's thread index, while a clone's update counts its thread as the clone's 0
+    size_t const thread = ThreadPool::GetCurrentThreadIndex();
+    Match& clone = *_clones[thread];
+    ByteBuffer& cloneState = *_cloneStates[thread];
+    cloneState.Rewind();
+    clone.LoadSnapshot(cloneState);
+
+    Entity const& player = clone.GetPlayer();
+    Entity const& opponent = clone.GetOpponent();
+    auto const playStep = [&](uint8_t action, size_t fromTick) {
+        for (size_t t = fromTick; t < STEP_TICKS && player.IsAlive() && opponent.IsAlive(); t++)
+        {
+            // Player is assumed to stay where they are, and keep punching
+            FighterInput playerInput;
+            playerInput.target = player.GetPosition();
+            playerInput.punch = clone.GetTick() % PLAYER_PUNCH_PERIOD == 0;
+            playerInput.throwFist = false;
+            clone.Update(playerInput, GetInput(clone, action, t));
+        }
+    };
+
+    // Rest of the current step, then the steps down the tree, then random steps
+    playStep(_action, _tickOfStep);
+    for (size_t d = 0; d < depth; d++)
+    {
+        playStep(path[d], 0);
+    }
+    CounterRandom::Stream random = _random.GetStream(
+        (uint32_t)(_tickRollouts + rollout), _tick, (uint32_t)RandomPurpose::PlannerRollout);
+    for (size_t s = 0; s < ROLLOUT_STEPS; s++)
+    {
+        playStep((uint8_t)random.NextUInt(ACTIONS_COUNT), 0);
+    }
+
+    // Damage dealt counts for the opponent, damage taken against it, and a kill counts the most
+    float value = (float)((_playerHealth - player.GetHealth()) - (_opponentHealth - opponent.GetHealth()))
+        / Entity::MAX_HEALTH;
+    value += player.IsAlive() ? 0.f : 1.f;
+    value -= opponent.IsAlive() ? 0.f : 1.f;
+    value -= DISTANCE_WEIGHT * Geometry::CalcDist(player.GetPosition(), opponent.GetPosition())
+        / std::hypot(_size.x, _size.y);
+    return value;
+}
+
+FighterInput MctsPlanner::GetInput(Match const& match, uint8_t action, size_t tickOfStep) const
+{
+    FighterInput input;
+    input.target = match.GetOpponent().GetPosition()
+        + _speed * GetDirection(action % MOVE_DIRECTIONS_COUNT);
+    // A punch only lands when the button gets pressed, so it is pressed on the first tick of the step
+    input.punch = action >= MOVE_DIRECTIONS_COUNT && tickOfStep == 0;
+    input.throwFist = false;
+    return input;
+}
+
+void MctsPlanner::TakeStep()
+{
+    Node const& root = _nodes[0];
+    if (!root.expanded)
+    {
+        _action = IDLE_ACTION;
+        _tickOfStep = 0;
+        _stats.reusedVisits = 0;
+        return;
+    }
+
+    uint32_t best = root.firstChild;
+    for (uint32_t child = root.firstChild; child < root.firstChild + ACTIONS_COUNT; child++)
+    {
+        if (_nodes[child].visits > _nodes[best].visits)
+        {
+            best = child;
+        }
+    }
+    _action = (uint8_t)(best - root.firstChild);
+    _tickOfStep = 0;
+
+    // Subtree of the action is copied to the spare nodes, the node's children staying next to each other
+    _spareNodes[0] = _nodes[best];
+    size_t count = 1;
+    for (size_t n = 0; n < count; n++)
+    {
+        Node& copy = _spareNodes[n];
+        if (copy.expanded)
+        {
+            uint32_t const firstChild = copy.firstChild;
+            copy.firstChild = (uint32_t)count;
+            std::copy(&_nodes[firstChild], &_nodes[firstChild] + ACTIONS_COUNT, &_spareNodes[count]);
+            count += ACTIONS_COUNT;
+        }
+    }
+    _nodes.swap(_spareNodes);
+    _nodesCount = count;
+    _stats.reusedVisits = _nodes[0].visits;
+}
+
+uint32_t MctsPlanner::SelectChild(uint32_t node) const
+{
+    // Actions that haven't been tried are tried first, the others by their upper confidence bounds
+    Node const& parent = _nodes[node];
+    float const logVisits = std::log((float)std::max(parent.visits, 1u));
+    uint32_t best = parent.firstChild;
+    float bestScore = -std::numeric_limits<float>::max();
+    for (uint32_t child = parent.firstChild; child < parent.firstChild + ACTIONS_COUNT; child++)
+    {
+        Node const& candidate = _nodes[child];
+        if (candidate.visits == 0)
+        {
+            return child;
+        }
+        float const score = candidate.totalValue / candidate.visits
+            + EXPLORATION * std::sqrt(logVisits / candidate.visits);
+        if (score > bestScore)
+        {
+            bestScore = score;
+            best = child;
+        }
+    }
+    return best;
+}
+
+} // namespace FaceFight
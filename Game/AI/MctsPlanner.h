@@ -0,0 +1,204 @@
+#pragma once
+
+#include "../Match.h"
+
+#include "../Input/FighterInput.hpp"
+#include "../Parallel/ThreadPool.h"
+#include "../Random/CounterRandom.h"
+#include "../Serialization/ByteBuffer.h"
+
+#include <SFML/System.hpp>
+
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace FaceFight
+{
+
+/**
+ * A class for an enemy AI that plans the opponent's moves with Monte Carlo tree search.
+ * 
+ * The opponent acts in steps of a few ticks, each step being one of a small set of actions,
+ * which are a direction to move in, or standing still, combined with punching or waiting.
+ * The search tree is rooted at the moment the current step ends,
+ * and every rollout restores a clone of the match from a snapshot, plays the rest of the current step,
+ * goes down the tree by its upper confidence bounds, and then plays a few random steps.
+ * Meanwhile the player is assumed to stand still and punch at a steady pace.
+ * 
+ * Each iteration runs one rollout on every thread of a pool, each on its own clone of the match,
+ * and thinking stops once the time budget of the tick is used up.
+ * When a step ends, the most visited action is taken, and its subtree becomes the new tree,
+ * so the rollouts of previous ticks keep counting.
+ * All nodes and clones are allocated when the planner is created, so planning doesn't allocate.
+ */
+class MctsPlanner
+{
+
+  public:
+
+    /// Performance counters of the last tick
+    struct Stats
+    {
+        /// Number of rollouts run, and the time they took
+        size_t rolloutsCount;
+        sf::Time thinkTime;
+
+        /// Number of nodes in the tree
+        size_t nodesCount;
+
+        /// Number of rollouts kept from previous ticks, the last time a step was taken
+        uint64_t reusedVisits;
+    };
+
+  public:
+
+    /**
+     * Creates a planner with clones of a match, one for each thread
+     * 
+     * @param[in] settings
+     *  Settings with which the planned match was set up
+     * @param[in] assets
+     *  Resources of the planned match, which have to outlive the planner
+     * @param[in] budget
+     *  Time that the planner may spend thinking on each tick
+     */
+    MctsPlanner(MatchSettings const& settings, MatchAssets const& assets, std::chrono::microseconds budget);
+
+    MctsPlanner(MctsPlanner const&) = delete;
+    MctsPlanner& operator=(MctsPlanner const&) = delete;
+
+    /**
+     * Thinks about the match for the rest of the budget, and returns the opponent's input for this tick.
+     * Supposed to be called every tick, before the match is updated.
+     * 
+     * @param[in] match
+     *  The planned match, in which the opponent is controlled by the planner
+     */
+    FighterInput Plan(Match const& match);
+
+    /**
+     * Forgets the search tree, meant for when the match jumps to another state
+     */
+    void Reset();
+
+    /**
+     * Returns the performance counters of the last tick
+     */
+    Stats const& GetStats() const;
+
+  private:
+
+    /// A node of the search tree, the state reached by taking an action from its parent's state
+    struct Node
+    {
+        /// Index of the first of the node's children, which are next to each other, one for every action
+        uint32_t firstChild;
+
+        /// Number of rollouts that went through the node, and the sum of their values
+        uint32_t visits;
+        float totalValue;
+
+        /// Tells whether the node has children
+        bool expanded;
+    };
+
+  private: /* functions */
+
+    /**
+     * Runs a single iteration of the search: selects a leaf, runs a rollout from it on every thread,
+     * and backs the values of the rollouts up the tree
+     */
+    void Iterate();
+
+    /**
+     * Plays a rollout on a clone of the match and returns how good it turned out for the opponent
+     * 
+     * @param[in] rollout
+     *  Index of the rollout among the rollouts of this iteration
+     * @param[in] path
+     *  Actions that lead from the root to the leaf
+     * @param[in] depth
+     *  Number of actions in the path
+     */
+    float Rollout(size_t rollout, uint8_t const* path, size_t depth);
+
+    /**
+     * Returns the opponent's input on a tick of a step
+     * 
+     * @param[in] match
+     *  The match, either the planned one or a clone
+     * @param[in] action
+     *  The action of the step
+     * @param[in] tickOfStep
+     *  Number of ticks of the step played so far
+     */
+    FighterInput GetInput(Match const& match, uint8_t action, size_t tickOfStep) const;
+
+    /**
+     * Takes the most visited action of the root, and makes its subtree the new tree
+     */
+    void TakeStep();
+
+    /**
+     * Returns the child of a node that the search goes to next
+     * 
+     * @param[in] node
+     *  Index of an expanded node
+     */
+    uint32_t SelectChild(uint32_t node) const;
+
+  private: /* variables */
+
+    /// Time that the planner may spend thinking on each tick
+    std::chrono::microseconds _budget;
+
+    /// Resources of the clones, which are never drawn, so they have no textures
+    MatchAssets _cloneAssets;
+
+    /// Distance that the opponent moves on each tick
+    float _speed;
+
+    /// Threads among which rollouts are spread
+    ThreadPool _threadPool;
+
+    /// Clone of the match of each thread, and the snapshot from which it is restored
+    std::vector<std::unique_ptr<Match>> _clones;
+    std::vector<std::unique_ptr<ByteBuffer>> _cloneStates;
+
+    /// Snapshot of the planned match on the current tick
+    ByteBuffer _state;
+
+    /// Nodes of the tree, where the root is the first one, and nodes into which the tree is moved
+    std::vector<Node> _nodes;
+    std::vector<Node> _spareNodes;
+    size_t _nodesCount;
+
+    /// Value of each rollout of the current iteration
+    std::vector<float> _rolloutValues;
+
+    /// Health of the player and of the opponent on the current tick
+    int _playerHealth;
+    int _opponentHealth;
+
+    /// Size of the arena, to which distances are compared
+    sf::Vector2f _size;
+
+    /// Action of the current step, and the number of its ticks played so far
+    uint8_t _action;
+    size_t _tickOfStep;
+
+    /// Random generator of the rollouts
+    CounterRandom _random;
+
+    /// Tick of the planned match, and the number of rollouts run on it
+    uint64_t _tick;
+    size_t _tickRollouts;
+
+    /// Performance counters of the last tick
+    Stats _stats;
+};
+
+} // namespace FaceFight
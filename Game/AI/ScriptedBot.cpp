@@ -0,0 +1,47 @@
+#include "ScriptedBot.h"
+
+#include "../Geometry/Geometry.hpp"
+
+#include <cmath>
+
+namespace
+{
+
+// Distance at which a bot circles around the other fighter
+float const BOT_CIRCLE_RADIUS = 200.f;
+
+// Angle by which a bot goes around the other fighter on each tick, in radians
+float const BOT_CIRCLE_SPEED = 0.03f;
+
+} // namespace
+
+namespace FaceFight
+{
+
+FighterInput ScriptedBot::GetInput(Match const& match, size_t side)
+{
+    Entity const& self = side == 0 ? match.GetPlayer() : match.GetOpponent();
+    Entity const& other = side == 0 ? match.GetOpponent() : match.GetPlayer();
+    GameplayParameters const& parameters = match.GetParameters();
+    uint64_t const tick = match.GetTick();
+
+    // Bot circles around the other fighter, the sides going round in opposite directions
+    float const angle = BOT_CIRCLE_SPEED * tick * (side == 0 ? 1.f : -1.f);
+    sf::Vector2f const spot = other.GetPosition()
+        + BOT_CIRCLE_RADIUS * sf::Vector2f(std::cos(angle), std::sin(angle));
+
+    // but only walks toward its spot as fast as an enemy walks
+    FighterInput input;
+    input.target = Geometry::CalcDist(self.GetPosition(), spot) > parameters.enemySpeed
+        ? self.GetPosition() + Geometry::NormaliseVector(Geometry::GetVector(self.GetPosition(), spot)) * parameters.enemySpeed
+        : spot;
+
+    /* Like an enemy, it punches once it is within punch distance, and throws fists only from farther away.
+       Buttons are pressed for a single tick, since only pressing them does anything, once per enemy cooldown */
+    bool const withinPunchDist = Geometry::CalcDist(self.GetPosition(), other.GetPosition()) <= parameters.punchDist;
+    input.punch = withinPunchDist && tick % (uint64_t)parameters.enemyPunchFreq == side;
+    input.throwFist = !withinPunchDist && tick % (uint64_t)parameters.enemyThrowFreq == side;
+    return input;
+}
+
+} // namespace FaceFight
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "../Match.h"
+
+#include "../Input/FighterInput.hpp"
+
+#include <cstddef>
+
+namespace FaceFight
+{
+
+/**
+ * A class for a scripted bot that plays a side of a match in place of a player.
+ * The bot circles around the other fighter, punches it when within punch distance
+ * and throws its fist at it from farther away.
+ * It is held to the same limits as the enemies' AI, by the match's gameplay parameters:
+ * it walks no farther than an enemy on each tick, and punches and throws no more often.
+ * It has no state of its own, so it plays the same way in any match it is given.
+ */
+class ScriptedBot
+{
+
+  public:
+
+    /**
+     * Returns the input of the bot for the current tick of a match
+     * 
+     * @param[in] match
+     *  The match in which the bot plays, which has to be against another player
+     * @param[in] side
+     *  Side that the bot plays, 0 for the player and 1 for the opponent
+     */
+    static FighterInput GetInput(Match const& match, size_t side);
+};
+
+} // namespace FaceFight
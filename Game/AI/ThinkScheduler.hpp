@@ -0,0 +1,223 @@
+#pragma once
+
+#include "../Serialization/ByteBuffer.h"
+
+#include <chrono>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * A template class for spreading expensive "think" updates of agents across ticks.
+ * 
+ * Agents wait in queues, one queue per priority level.
+ * Each tick, agents are taken from the most important queue first,
+ * and thinking stops once as many agents as allowed have thought,
+ * or once the time budget of the tick is used up, if there is one.
+ * Only a limit on the number of thinks gives the same order of thinking on any machine.
+ * Agents that didn't get to think stay at the front of their queue,
+ * so they are the first ones to think on the next tick.
+ * Each agent thinks at most once per tick,
+ * and after thinking it tells in which queue it should wait for the next time.
+ * 
+ * Queues are allocated once, so scheduling never allocates.
+ * 
+ * @param[in] Agent
+ *  Type identifying an agent, such as a handle to it.
+ *  The think function is responsible for detecting agents that no longer exist.
+ */
+template <class Agent>
+class ThinkScheduler
+{
+
+  public:
+
+    /// Priority returned by a think function for an agent that shouldn't think again
+    static constexpr size_t DROP = SIZE_MAX;
+
+  public:
+
+    /**
+     * Creates a scheduler with empty queues
+     * 
+     * @param[in] capacity
+     *  Maximum number of agents that can wait in each queue at the same time
+     * @param[in] prioritiesCount
+     *  Number of priority levels, 0 being the most important one
+     */
+    ThinkScheduler(size_t capacity, size_t prioritiesCount);
+
+    /**
+     * Puts an agent at the end of the queue with the given priority
+     * 
+     * @param[in] agent
+     *  The agent to be scheduled
+     * @param[in] priority
+     *  Priority of the agent, less than the number of priority levels
+     */
+    void Enqueue(Agent const& agent, size_t priority);
+
+    /**
+     * Lets waiting agents think, in the order of their priority,
+     * until the limits are reached or every agent has thought once.
+     * 
+     * @param[in] maxThinks
+     *  Maximum number of agents that may think on this tick
+     * @param[in] budget
+     *  Time that thinking may take on this tick, or zero for no time limit.
+     *  It is checked every few agents, so it can be overrun by a few thinks.
+     * @param[in] think
+     *  Function taking in an agent, and returning the priority
+     *  with which the agent should wait for its next think, or DROP
+     * 
+     * @return number of agents that thought
+     */
+    template <class Think>
+    size_t Run(size_t maxThinks, std::chrono::microseconds budget, Think const& think);
+
+    /**
+     * Returns the number of agents waiting in all queues
+     */
+    size_t GetWaitingCount() const;
+
+    /**
+     * Writes the agents waiting in each queue, in their order, to a buffer
+     * 
+     * @param[in] buffer
+     *  Buffer to which the queues are written
+     */
+    void Save(ByteBuffer& buffer) const;
+
+    /**
+     * Reads queues written by Save() from a buffer, replacing the waiting agents
+     * 
+     * @param[in] buffer
+     *  Buffer from which the queues are read
+     */
+    void Load(ByteBuffer& buffer);
+
+  private:
+
+    /// Number of agents that think between two reads of the clock
+    static constexpr size_t THINKS_PER_CLOCK_CHECK = 16;
+
+    /// A fixed-capacity circular queue of agents
+    struct Queue
+    {
+        std::vector<Agent> agents;
+        size_t head;
+        size_t size;
+    };
+
+  private: /* variables */
+
+    /// A queue for each priority level
+    std::vector<Queue> _queues;
+
+    /// Number of agents in each queue that may still think on the current tick
+    std::vector<size_t> _waiting;
+};
+
+template <class Agent>
+ThinkScheduler<Agent>::ThinkScheduler(size_t capacity, size_t prioritiesCount)
+    : _queues(prioritiesCount, Queue{std::vector<Agent>(capacity), 0, 0}),
+    _waiting(prioritiesCount)
+{}
+
+template <class Agent>
+void ThinkScheduler<Agent>::Enqueue(Agent const& agent, size_t priority)
+{
+    Queue& queue = _queues[priority];
+    if (queue.size == queue.agents.size())
+    {
+        throw "Error: Think scheduler queue is full";
+    }
+    queue.agents[(queue.head + queue.size) % queue.agents.size()] = agent;
+    queue.size++;
+}
+
+template <class Agent>
+template <class Think>
+size_t ThinkScheduler<Agent>::Run(size_t maxThinks, std::chrono::microseconds budget, Think const& think)
+{
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point const deadline = Clock::now() + budget;
+
+    /* Only agents that were waiting when the tick began may think,
+       agents that are enqueued again after thinking wait for the next tick */
+    for (size_t p = 0; p < _queues.size(); p++)
+    {
+        _waiting[p] = _queues[p].size;
+    }
+
+    size_t thinks = 0;
+    for (size_t p = 0; p < _queues.size(); p++)
+    {
+        Queue& queue = _queues[p];
+        for (; _waiting[p] > 0; _waiting[p]--)
+        {
+            if (thinks == maxThinks)
+            {
+                return thinks;
+            }
+            // Without a budget the clock is never read, so thinking doesn't depend on the machine
+            if (budget != std::chrono::microseconds::zero()
+                && thinks % THINKS_PER_CLOCK_CHECK == 0 && thinks > 0 && Clock::now() >= deadline)
+            {
+                return thinks;
+            }
+
+            Agent const agent = queue.agents[queue.head];
+            queue.head = (queue.head + 1) % queue.agents.size();
+            queue.size--;
+
+            size_t const nextPriority = think(agent);
+            if (nextPriority != DROP)
+            {
+                Enqueue(agent, nextPriority);
+            }
+            thinks++;
+        }
+    }
+    return thinks;
+}
+
+template <class Agent>
+size_t ThinkScheduler<Agent>::GetWaitingCount() const
+{
+    size_t count = 0;
+    for (Queue const& queue : _queues)
+    {
+        count += queue.size;
+    }
+    return count;
+}
+
+template <class Agent>
+void ThinkScheduler<Agent>::Save(ByteBuffer& buffer) const
+{
+    for (Queue const& queue : _queues)
+    {
+        buffer.Write(queue.size);
+        for (size_t a = 0; a < queue.size; a++)
+        {
+            buffer.Write(queue.agents[(queue.head + a) % queue.agents.size()]);
+        }
+    }
+}
+
+template <class Agent>
+void ThinkScheduler<Agent>::Load(ByteBuffer& buffer)
+{
+    for (Queue& queue : _queues)
+    {
+        size_t const size = buffer.Read<size_t>();
+        if (size > queue.agents.size())
+        {
+            throw "Error: Loading more agents than a think scheduler queue can hold";
+        }
+        buffer.ReadArray(queue.agents.data(), size);
+        queue.head = 0;
+        queue.size = size;
+    }
+}
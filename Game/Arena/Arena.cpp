@@ -0,0 +1,354 @@
+#include "Arena.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+namespace
+{
+
+/// Maximum number of obstacles in a leaf of the hierarchy
+uint32_t const LEAF_SIZE = 2;
+
+/// Maximum depth of the hierarchy that queries can descend to
+size_t const MAX_DEPTH = 64;
+
+/// Maximum number of times a movement slides along obstacles
+int const MAX_SLIDES = 3;
+
+/// Distance kept from obstacles, so that a stopped movement doesn't start inside them
+float const SKIN = 0.01f;
+
+sf::Color const OBSTACLE_COLOR(90, 90, 100);
+
+/**
+ * Returns the smallest rectangle containing both rectangles
+ */
+sf::FloatRect Unite(sf::FloatRect const& a, sf::FloatRect const& b)
+{
+    float const left = std::min(a.left, b.left);
+    float const top = std::min(a.top, b.top);
+    float const right = std::max(a.left + a.width, b.left + b.width);
+    float const bottom = std::max(a.top + a.height, b.top + b.height);
+    return {left, top, right - left, bottom - top};
+}
+
+/**
+ * Returns the rectangle grown by the given amount on each side
+ */
+sf::FloatRect Grow(sf::FloatRect const& rect, float amount)
+{
+    return {rect.left - amount, rect.top - amount, rect.width + 2 * amount, rect.height + 2 * amount};
+}
+
+/**
+ * Intersects the line of a segment with a rectangle, with the slab method.
+ * Times are fractions of the segment, the segment itself being between 0 and 1.
+ * 
+ * @param[out] enter
+ *  Time when the line enters the rectangle
+ * @param[out] exit
+ *  Time when the line leaves the rectangle
+ * @param[out] vertical
+ *  Tells whether the line enters through one of the vertical sides
+ * 
+ * @return whether the line crosses the rectangle
+ */
+bool IntersectLine(
+    sf::FloatRect const& rect,
+    sf::Vector2f const& from,
+    sf::Vector2f const& delta,
+    float& enter,
+    float& exit,
+    bool& vertical)
+{
+    enter = -std::numeric_limits<float>::infinity();
+    exit = std::numeric_limits<float>::infinity();
+    vertical = false;
+
+    if (delta.x == 0.f)
+    {
+        if (from.x <= rect.left || from.x >= rect.left + rect.width)
+        {
+            return false;
+        }
+    }
+    else
+    {
+        float near = (rect.left - from.x) / delta.x;
+        float far = (rect.left + rect.width - from.x) / delta.x;
+        if (near > far)
+        {
+            std::swap(near, far);
+        }
+        enter = near;
+        exit = far;
+        vertical = true;
+    }
+
+    if (delta.y == 0.f)
+    {
+        if (from.y <= rect.top || from.y >= rect.top + rect.height)
+        {
+            return false;
+        }
+    }
+    else
+    {
+        float near = (rect.top - from.y) / delta.y;
+        float far = (rect.top + rect.height - from.y) / delta.y;
+        if (near > far)
+        {
+            std::swap(near, far);
+        }
+        if (near > enter)
+        {
+            enter = near;
+            vertical = false;
+        }
+        exit = std::min(exit, far);
+    }
+
+    return enter < exit;
+}
+
+/**
+ * Checks if a segment overlaps a rectangle, up to the given time
+ */
+bool OverlapsSegment(
+    sf::FloatRect const& rect,
+    sf::Vector2f const& from,
+    sf::Vector2f const& delta,
+    float maxTime)
+{
+    float enter, exit;
+    bool vertical;
+    return IntersectLine(rect, from, delta, enter, exit, vertical)
+        && enter <= maxTime && exit >= 0.f;
+}
+
+} // namespace
+
+Arena::Arena(sf::Vector2f const& size)
+    : _size(size),
+    _vertices(sf::Quads)
+{}
+
+void Arena::Load(std::string const& filename)
+{
+    std::ifstream file(filename);
+    if (!file)
+    {
+        throw "Error: Cannot load arena from file: " + filename;
+    }
+
+    _obstacles.clear();
+    std::string line;
+    while (std::getline(file, line))
+    {
+        std::istringstream lineStream(line);
+        std::string kind;
+        if (!(lineStream >> kind) || kind[0] == '#')
+        {
+            continue;
+        }
+
+        sf::FloatRect rect;
+        if (kind != "rect" || !(lineStream >> rect.left >> rect.top >> rect.width >> rect.height))
+        {
+            throw "Error: Invalid obstacle in arena file: " + filename;
+        }
+        _obstacles.push_back({
+            rect.left * _size.x, rect.top * _size.y,
+            rect.width * _size.x, rect.height * _size.y
+        });
+    }
+
+    _nodes.clear();
+    if (!_obstacles.empty())
+    {
+        _nodes.reserve(2 * _obstacles.size());
+        _nodes.push_back(Node{});
+        Build(0, 0, (uint32_t)_obstacles.size());
+    }
+
+    _vertices.clear();
+    for (sf::FloatRect const& obstacle : _obstacles)
+    {
+        float const right = obstacle.left + obstacle.width;
+        float const bottom = obstacle.top + obstacle.height;
+        _vertices.append(sf::Vertex({obstacle.left, obstacle.top}, OBSTACLE_COLOR));
+        _vertices.append(sf::Vertex({right, obstacle.top}, OBSTACLE_COLOR));
+        _vertices.append(sf::Vertex({right, bottom}, OBSTACLE_COLOR));
+        _vertices.append(sf::Vertex({obstacle.left, bottom}, OBSTACLE_COLOR));
+    }
+}
+
+sf::Vector2f Arena::ClampMove(
+    sf::Vector2f const& from,
+    sf::Vector2f const& delta,
+    float radius) const
+{
+    sf::Vector2f position = from;
+    sf::Vector2f remaining = delta;
+    for (int s = 0; s < MAX_SLIDES && remaining != sf::Vector2f(0.f, 0.f); s++)
+    {
+        Hit hit;
+        if (!Sweep(position, remaining, radius, hit))
+        {
+            position += remaining;
+            break;
+        }
+
+        // Stop just before the obstacle
+        float const length = std::hypot(remaining.x, remaining.y);
+        float const time = std::max(0.f, hit.time - SKIN / length);
+        position += remaining * time;
+        remaining *= 1.f - time;
+
+        // and slide along it, dropping the part of the movement that goes into it
+        if (hit.vertical)
+        {
+            remaining.x = 0.f;
+        }
+        else
+        {
+            remaining.y = 0.f;
+        }
+    }
+
+    // Arena's bounds are walls too
+    position.x = std::max(radius, std::min(position.x, _size.x - radius));
+    position.y = std::max(radius, std::min(position.y, _size.y - radius));
+    return position;
+}
+
+bool Arena::HasLineOfSight(
+    sf::Vector2f const& from,
+    sf::Vector2f const& to) const
+{
+    if (_nodes.empty())
+    {
+        return true;
+    }
+
+    sf::Vector2f const delta = to - from;
+    uint32_t stack[MAX_DEPTH];
+    size_t stackSize = 0;
+    stack[stackSize++] = 0;
+    while (stackSize > 0)
+    {
+        Node const& node = _nodes[stack[--stackSize]];
+        if (!OverlapsSegment(node.bounds, from, delta, 1.f))
+        {
+            continue;
+        }
+        if (node.count == 0)
+        {
+            stack[stackSize++] = node.first;
+            stack[stackSize++] = node.first + 1;
+            continue;
+        }
+        for (uint32_t o = node.first; o < node.first + node.count; o++)
+        {
+            if (OverlapsSegment(_obstacles[o], from, delta, 1.f))
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+std::vector<sf::FloatRect> const& Arena::GetObstacles() const
+{
+    return _obstacles;
+}
+
+void Arena::Draw(sf::RenderTarget& renderTarget) const
+{
+    renderTarget.draw(_vertices);
+}
+
+void Arena::Build(uint32_t node, uint32_t begin, uint32_t end)
+{
+    sf::FloatRect bounds = _obstacles[begin];
+    for (uint32_t o = begin + 1; o < end; o++)
+    {
+        bounds = Unite(bounds, _obstacles[o]);
+    }
+
+    if (end - begin <= LEAF_SIZE)
+    {
+        _nodes[node] = {bounds, begin, end - begin};
+        return;
+    }
+
+    // Split at the median of the obstacles' centers, along the longer side
+    bool const splitX = (bounds.width >= bounds.height);
+    uint32_t const middle = begin + (end - begin) / 2;
+    std::nth_element(
+        _obstacles.begin() + begin, _obstacles.begin() + middle, _obstacles.begin() + end,
+        [splitX](sf::FloatRect const& a, sf::FloatRect const& b) {
+            return splitX
+                ? (2 * a.left + a.width < 2 * b.left + b.width)
+                : (2 * a.top + a.height < 2 * b.top + b.height);
+        });
+
+    // Children are next to each other, so a node only stores the first one
+    uint32_t const children = (uint32_t)_nodes.size();
+    _nodes.push_back(Node{});
+    _nodes.push_back(Node{});
+    _nodes[node] = {bounds, children, 0};
+    Build(children, begin, middle);
+    Build(children + 1, middle, end);
+}
+
+bool Arena::Sweep(
+    sf::Vector2f const& from,
+    sf::Vector2f const& delta,
+    float radius,
+    Hit& hit) const
+{
+    if (_nodes.empty())
+    {
+        return false;
+    }
+
+    // Moving a square against rectangles is the same as moving a point against grown rectangles
+    bool found = false;
+    hit.time = 1.f;
+    uint32_t stack[MAX_DEPTH];
+    size_t stackSize = 0;
+    stack[stackSize++] = 0;
+    while (stackSize > 0)
+    {
+        Node const& node = _nodes[stack[--stackSize]];
+        if (!OverlapsSegment(Grow(node.bounds, radius), from, delta, hit.time))
+        {
+            continue;
+        }
+        if (node.count == 0)
+        {
+            stack[stackSize++] = node.first;
+            stack[stackSize++] = node.first + 1;
+            continue;
+        }
+        for (uint32_t o = node.first; o < node.first + node.count; o++)
+        {
+            float enter, exit;
+            bool vertical;
+            // Obstacles that the square already overlaps don't stop it, so it can get out of them
+            if (IntersectLine(Grow(_obstacles[o], radius), from, delta, enter, exit, vertical)
+                && enter >= 0.f && enter <= hit.time)
+            {
+                hit.time = enter;
+                hit.vertical = vertical;
+                found = true;
+            }
+        }
+    }
+    return found;
+}
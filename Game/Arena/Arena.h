@@ -0,0 +1,166 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+/**
+ * A class for the static geometry of an arena:
+ * its bounds, and rectangular obstacles inside them.
+ * 
+ * Obstacles are loaded from a data file, and indexed in a bounding volume hierarchy,
+ * which is built once, when the arena is loaded.
+ * Queries only descend into the parts of the hierarchy that they touch,
+ * so their cost grows logarithmically with the number of obstacles.
+ */
+class Arena
+{
+
+  public:
+
+    /**
+     * Creates an empty arena of the given size
+     * 
+     * @param[in] size
+     *  Size of the arena, starting at (0, 0)
+     */
+    Arena(sf::Vector2f const& size);
+
+    /**
+     * Loads the obstacles of the arena from a file,
+     * replacing any obstacles loaded before,
+     * and builds the hierarchy over them.
+     * 
+     * Each line of the file is either empty, a comment starting with '#',
+     * or an obstacle "rect <left> <top> <width> <height>",
+     * with coordinates given as fractions of the arena's size.
+     * 
+     * @param[in] filename
+     *  Name of the file with the obstacles
+     */
+    void Load(std::string const& filename);
+
+    /**
+     * Clamps a movement of a circle, so that it doesn't go into any obstacle
+     * or out of the arena's bounds.
+     * When the circle hits an obstacle, it slides along it.
+     * The circle is treated as its bounding square.
+     * 
+     * @param[in] from
+     *  Center of the circle before the movement
+     * @param[in] delta
+     *  Movement of the circle
+     * @param[in] radius
+     *  Radius of the circle
+     * 
+     * @return center of the circle after the clamped movement
+     */
+    sf::Vector2f ClampMove(
+        sf::Vector2f const& from,
+        sf::Vector2f const& delta,
+        float radius
+    ) const;
+
+    /**
+     * Checks if there are no obstacles on the segment between two points
+     * 
+     * @param[in] from
+     *  First point of the segment
+     * @param[in] to
+     *  Second point of the segment
+     */
+    bool HasLineOfSight(
+        sf::Vector2f const& from,
+        sf::Vector2f const& to
+    ) const;
+
+    /**
+     * Returns the obstacles of the arena
+     */
+    std::vector<sf::FloatRect> const& GetObstacles() const;
+
+    /**
+     * Draws the obstacles of the arena on the given render target
+     * 
+     * @param[in] renderTarget
+     *  Render target on which to draw the obstacles
+     */
+    void Draw(sf::RenderTarget& renderTarget) const;
+
+  private:
+
+    /// A node of the bounding volume hierarchy
+    struct Node
+    {
+        /// Bounds of all obstacles under the node
+        sf::FloatRect bounds;
+
+        /// First obstacle of a leaf, or the first of the two children of an inner node
+        uint32_t first;
+
+        /// Number of obstacles of a leaf, 0 for inner nodes
+        uint32_t count;
+    };
+
+    /// Result of a swept movement hitting an obstacle
+    struct Hit
+    {
+        /// Fraction of the movement done before the hit
+        float time;
+
+        /// Tells whether the obstacle was hit on one of its vertical sides
+        bool vertical;
+    };
+
+  private: /* functions */
+
+    /**
+     * Builds the hierarchy over a range of obstacles,
+     * splitting the range at the median along the longer side of its bounds
+     * 
+     * @param[in] node
+     *  Index of the node that covers the range
+     * @param[in] begin
+     *  First obstacle of the range
+     * @param[in] end
+     *  One past the last obstacle of the range
+     */
+    void Build(uint32_t node, uint32_t begin, uint32_t end);
+
+    /**
+     * Finds the first obstacle hit by a square moving along a segment
+     * 
+     * @param[in] from
+     *  Center of the square before the movement
+     * @param[in] delta
+     *  Movement of the square
+     * @param[in] radius
+     *  Half of the size of the square
+     * @param[out] hit
+     *  The first hit, if there is one
+     * 
+     * @return whether an obstacle is hit
+     */
+    bool Sweep(
+        sf::Vector2f const& from,
+        sf::Vector2f const& delta,
+        float radius,
+        Hit& hit
+    ) const;
+
+  private: /* variables */
+
+    /// Size of the arena
+    sf::Vector2f _size;
+
+    /// Obstacles, ordered so that each leaf covers a contiguous range of them
+    std::vector<sf::FloatRect> _obstacles;
+
+    /// Nodes of the hierarchy, the root being the first one
+    std::vector<Node> _nodes;
+
+    /// Quads of all obstacles, drawn at once
+    sf::VertexArray _vertices;
+};
@@ -0,0 +1,241 @@
+#include "BalanceSweep.h"
+
+#include "../AI/ScriptedBot.h"
+#include "../Random/RandomPurposes.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+
+/// A gameplay parameter that can be tuned by a sweep
+struct TunableParameter
+{
+    char const* name;
+    void (*set)(FaceFight::GameplayParameters& parameters, double value);
+};
+
+// Parameters that can be tuned, named as their members
+TunableParameter const TUNABLE_PARAMETERS[] = {
+    {"punchPower", [](FaceFight::GameplayParameters& p, double v) { p.punchPower = (float)v; }},
+    {"fistDistPunch", [](FaceFight::GameplayParameters& p, double v) { p.fistDistPunch = (float)v; }},
+    {"punchAnimationDuration", [](FaceFight::GameplayParameters& p, double v) {
+        p.punchAnimationDuration = (size_t)std::max(2.0, v); }},
+    {"getPunchedAnimationDuration", [](FaceFight::GameplayParameters& p, double v) {
+        p.getPunchedAnimationDuration = (size_t)std::max(2.0, v); }},
+    {"enemySpeed", [](FaceFight::GameplayParameters& p, double v) { p.enemySpeed = (float)v; }},
+    {"punchDist", [](FaceFight::GameplayParameters& p, double v) { p.punchDist = (float)v; }},
+    {"enemyPunchFreq", [](FaceFight::GameplayParameters& p, double v) { p.enemyPunchFreq = (int)v; }},
+    {"enemyThrowFreq", [](FaceFight::GameplayParameters& p, double v) { p.enemyThrowFreq = (int)v; }}
+};
+
+// Matches of this many parameter sets are played at the same time
+size_t const SETS_PER_BATCH = 64;
+
+// Maximum number of fists in flight in a single duel
+size_t const SWEEP_MAX_PROJECTILES = 64;
+
+// Percentiles of the time to kill written for each parameter set
+double const TIME_TO_KILL_PERCENTILES[] = {0.1, 0.5, 0.9};
+
+} // namespace
+
+namespace FaceFight
+{
+
+BalanceSweep::BalanceSweep(BalanceSweepSettings const& settings, MatchAssets const& assets)
+    : _settings(settings),
+    _assets(assets),
+    _threadPool(settings.workersCount)
+{
+    for (SweepAxis const& axis : _settings.axes)
+    {
+        auto const parameter = std::find_if(std::begin(TUNABLE_PARAMETERS), std::end(TUNABLE_PARAMETERS),
+            [&axis](TunableParameter const& tunable) { return axis.parameter == tunable.name; });
+        if (parameter == std::end(TUNABLE_PARAMETERS))
+        {
+            throw "Error: Unknown gameplay parameter: " + axis.parameter;
+        }
+        _axisParameters.push_back(parameter - std::begin(TUNABLE_PARAMETERS));
+    }
+
+    // Everything a batch needs is allocated once, only the matches themselves allocate while running
+    _batchParameters.resize(SETS_PER_BATCH);
+    _batchValues.resize(SETS_PER_BATCH * _settings.axes.size());
+    _batchOutcomes.resize(SETS_PER_BATCH * _settings.matchesPerSet);
+    _row.resize(GetColumns().size());
+}
+
+std::vector<std::string> BalanceSweep::GetColumns() const
+{
+    std::vector<std::string> columns = {"set"};
+    for (SweepAxis const& axis : _settings.axes)
+    {
+        columns.push_back(axis.parameter);
+    }
+    columns.insert(columns.end(), {
+        "matches", "winRate", "lossRate", "drawRate",
+        "timeToKillMean", "timeToKillP10", "timeToKillP50", "timeToKillP90"
+    });
+    return columns;
+}
+
+size_t BalanceSweep::GetSetsCount() const
+{
+    if (_settings.search == BalanceSweepSettings::Search::Random)
+    {
+        return _settings.samplesCount;
+    }
+
+    size_t count = 1;
+    for (SweepAxis const& axis : _settings.axes)
+    {
+        count *= axis.steps;
+    }
+    return count;
+}
+
+void BalanceSweep::Run(ColumnWriter& output)
+{
+    size_t const setsCount = GetSetsCount();
+    size_t const axesCount = _settings.axes.size();
+    size_t const matchesPerSet = _settings.matchesPerSet;
+
+    for (size_t batchBegin = 0; batchBegin < setsCount; batchBegin += SETS_PER_BATCH)
+    {
+        size_t const batchSize = std::min(SETS_PER_BATCH, setsCount - batchBegin);
+        for (size_t s = 0; s < batchSize; s++)
+        {
+            GetParameterSet(batchBegin + s, _batchParameters[s], &_batchValues[s * axesCount]);
+        }
+
+        // Matches of all sets of the batch are spread together, so that small sets still keep every thread busy
+        _threadPool.ParallelFor(batchSize * matchesPerSet, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++)
+            {
+                size_t const s = i / matchesPerSet;
+                _batchOutcomes[i] = PlayMatch(_batchParameters[s],
+                    _settings.seed + (batchBegin + s) * matchesPerSet + i % matchesPerSet);
+            }
+        }, 1);
+
+        for (size_t s = 0; s < batchSize; s++)
+        {
+            WriteRow(batchBegin + s, &_batchValues[s * axesCount], &_batchOutcomes[s * matchesPerSet], output);
+        }
+    }
+    output.Flush();
+}
+
+void BalanceSweep::GetParameterSet(size_t set, GameplayParameters& parameters, double* values) const
+{
+    parameters = _settings.baseParameters;
+
+    // Random values are drawn from the set's own stream, so that each set is the same no matter the batch
+    CounterRandom const random(_settings.seed);
+    CounterRandom::Stream stream = random.GetStream((uint32_t)set, 0, (uint32_t)RandomPurpose::BalanceSample);
+
+    // In a grid, the last axis changes the fastest
+    size_t gridIndex = set;
+    for (size_t a = _settings.axes.size(); a-- > 0;)
+    {
+        SweepAxis const& axis = _settings.axes[a];
+        double value = axis.min;
+        if (_settings.search == BalanceSweepSettings::Search::Random)
+        {
+            value = axis.min + (axis.max - axis.min) * stream.NextFloat();
+        }
+        else
+        {
+            size_t const step = gridIndex % axis.steps;
+            gridIndex /= axis.steps;
+            if (axis.steps > 1)
+            {
+                value = axis.min + (axis.max - axis.min) * step / (axis.steps - 1);
+            }
+        }
+        values[a] = value;
+        TUNABLE_PARAMETERS[_axisParameters[a]].set(parameters, value);
+    }
+}
+
+BalanceSweep::MatchOutcome BalanceSweep::PlayMatch(GameplayParameters const& parameters, uint64_t seed) const
+{
+    /* Each match is played on a single thread, so it has no workers of its own,
+       and its updates count the sweep's worker playing it as the match's thread 0 */
+    MatchSettings matchSettings;
+    matchSettings.mode = GameMode::Duel;
+    matchSettings.seed = seed;
+    matchSettings.size = _settings.size;
+    matchSettings.maxEnemies = 1;
+    matchSettings.maxProjectiles = SWEEP_MAX_PROJECTILES;
+    matchSettings.workersCount = 0;
+    matchSettings.parameters = parameters;
+    Match match(matchSettings, _assets);
+
+    Entity const& bot = match.GetPlayer();
+    Entity const& enemy = match.GetOpponent();
+    while (match.GetTick() < _settings.maxTicks)
+    {
+        match.Update(ScriptedBot::GetInput(match, 0), FighterInput{});
+
+        bool const botDied = !bot.IsAlive();
+        bool const enemyDied = !enemy.IsAlive();
+        if (botDied || enemyDied)
+        {
+            MatchOutcome::Result const result = botDied && enemyDied ? MatchOutcome::Result::Draw
+                : enemyDied ? MatchOutcome::Result::Win : MatchOutcome::Result::Loss;
+            return {result, match.GetTick()};
+        }
+    }
+    return {MatchOutcome::Result::Draw, match.GetTick()};
+}
+
+void BalanceSweep::WriteRow(size_t set, double const* values, MatchOutcome* outcomes, ColumnWriter& output)
+{
+    size_t const matchesCount = _settings.matchesPerSet;
+    size_t wins = 0;
+    size_t losses = 0;
+    double totalTicks = 0.0;
+    for (size_t m = 0; m < matchesCount; m++)
+    {
+        wins += outcomes[m].result == MatchOutcome::Result::Win;
+        losses += outcomes[m].result == MatchOutcome::Result::Loss;
+        if (outcomes[m].result != MatchOutcome::Result::Draw)
+        {
+            totalTicks += outcomes[m].ticks;
+        }
+    }
+    size_t const kills = wins + losses;
+
+    // Matches that someone won come first, ordered by how long they took
+    std::sort(outcomes, outcomes + matchesCount, [](MatchOutcome const& a, MatchOutcome const& b) {
+        bool const aDraw = a.result == MatchOutcome::Result::Draw;
+        bool const bDraw = b.result == MatchOutcome::Result::Draw;
+        return aDraw != bDraw ? bDraw : a.ticks < b.ticks;
+    });
+
+    // Times to kill are in seconds, and undefined when no one won any match
+    double const noKills = std::numeric_limits<double>::quiet_NaN();
+    size_t c = 0;
+    _row[c++] = (double)set;
+    for (size_t a = 0; a < _settings.axes.size(); a++)
+    {
+        _row[c++] = values[a];
+    }
+    _row[c++] = (double)matchesCount;
+    _row[c++] = (double)wins / matchesCount;
+    _row[c++] = (double)losses / matchesCount;
+    _row[c++] = (double)(matchesCount - kills) / matchesCount;
+    _row[c++] = kills > 0 ? totalTicks / kills / Match::TICK_RATE : noKills;
+    for (double const percentile : TIME_TO_KILL_PERCENTILES)
+    {
+        _row[c++] = kills > 0
+            ? (double)outcomes[(size_t)(percentile * (kills - 1) + 0.5)].ticks / Match::TICK_RATE
+            : noKills;
+    }
+    output.WriteRow(_row.data());
+}
+
+} // namespace FaceFight
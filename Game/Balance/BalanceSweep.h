@@ -0,0 +1,198 @@
+#pragma once
+
+#include "GameplayParameters.hpp"
+
+#include "../Match.h"
+
+#include "../Parallel/ThreadPool.h"
+#include "../Serialization/ColumnWriter.h"
+
+#include <SFML/System.hpp>
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace FaceFight
+{
+
+/// A gameplay parameter that a sweep varies, and the range of its values
+struct SweepAxis
+{
+    /// Name of the parameter, as the member of GameplayParameters is named
+    std::string parameter;
+
+    /// Smallest and largest value of the parameter
+    double min = 0.0;
+    double max = 0.0;
+
+    /// Number of evenly spaced values in a grid search, from the smallest to the largest
+    size_t steps = 1;
+};
+
+/// How a balance sweep searches through gameplay parameters
+struct BalanceSweepSettings
+{
+    /// Kinds of search
+    enum class Search
+    {
+        /// Every combination of the values of all axes
+        Grid,
+        /// Values drawn uniformly from the range of each axis
+        Random
+    };
+
+    /// Kind of the search
+    Search search = Search::Grid;
+
+    /// Parameters that are varied, the others keep the values of the base parameters
+    std::vector<SweepAxis> axes;
+
+    /// Parameters from which every parameter set starts
+    GameplayParameters baseParameters;
+
+    /// Number of parameter sets drawn in a random search
+    size_t samplesCount = 100;
+
+    /// Number of matches played with each parameter set
+    size_t matchesPerSet = 100;
+
+    /// Seed of the search, from which the seed of every match is taken
+    uint64_t seed = 0;
+
+    /// Size of the arena of every match
+    sf::Vector2f size;
+
+    /// Number of ticks after which a match that no one has won is a draw
+    uint64_t maxTicks = 60 * Match::TICK_RATE;
+
+    /// Number of worker threads playing matches, besides the calling thread
+    size_t workersCount = ThreadPool::GetDefaultWorkersCount();
+};
+
+/**
+ * A class for a search through gameplay parameters, which plays many matches with each parameter set,
+ * and measures how the match turns out with it.
+ * 
+ * Each match is a duel, in which a scripted bot plays the player against an enemy of the game's AI.
+ * For each parameter set, a row is written with the values of the varied parameters,
+ * the rates of the bot's wins, losses and draws,
+ * and the mean and the 10th, 50th and 90th percentile of the time it took to kill either fighter.
+ * 
+ * Matches of a batch of parameter sets are spread across a pool of threads,
+ * each match played start to finish on a single thread,
+ * and rows are written as soon as their batch is done.
+ */
+class BalanceSweep
+{
+
+  public:
+
+    /**
+     * Sets up the search
+     * 
+     * @param[in] settings
+     *  How the search is done
+     * @param[in] assets
+     *  Resources of the matches, loaded without textures, which have to outlive the sweep
+     */
+    BalanceSweep(BalanceSweepSettings const& settings, MatchAssets const& assets);
+
+    BalanceSweep(BalanceSweep const&) = delete;
+    BalanceSweep& operator=(BalanceSweep const&) = delete;
+
+    /**
+     * Returns the names of the columns of the rows that the sweep writes
+     */
+    std::vector<std::string> GetColumns() const;
+
+    /**
+     * Returns the number of parameter sets that the sweep goes through
+     */
+    size_t GetSetsCount() const;
+
+    /**
+     * Plays the matches of every parameter set, and writes a row for each set
+     * 
+     * @param[in] output
+     *  Table to which the rows are written, with the columns returned by GetColumns()
+     */
+    void Run(ColumnWriter& output);
+
+  private:
+
+    /// How a single match turned out
+    struct MatchOutcome
+    {
+        enum class Result : uint8_t { Win, Loss, Draw };
+
+        /// Whether the bot won, lost, or no one won in time
+        Result result;
+
+        /// Tick on which the match ended
+        uint64_t ticks;
+    };
+
+  private: /* functions */
+
+    /**
+     * Writes the parameters of a set, and the values of its varied parameters
+     * 
+     * @param[in] set
+     *  Index of the set
+     * @param[in] parameters
+     *  Where the parameters are written
+     * @param[in] values
+     *  Where the values of the varied parameters are written, one for each axis
+     */
+    void GetParameterSet(size_t set, GameplayParameters& parameters, double* values) const;
+
+    /**
+     * Plays a match from start to finish
+     * 
+     * @param[in] parameters
+     *  Gameplay parameters of the match
+     * @param[in] seed
+     *  Seed of the match
+     */
+    MatchOutcome PlayMatch(GameplayParameters const& parameters, uint64_t seed) const;
+
+    /**
+     * Writes a row summarizing the matches of a parameter set
+     * 
+     * @param[in] set
+     *  Index of the set
+     * @param[in] values
+     *  Values of the varied parameters of the set
+     * @param[in] outcomes
+     *  Outcomes of the matches of the set, which get reordered
+     * @param[in] output
+     *  Table to which the row is written
+     */
+    void WriteRow(size_t set, double const* values, MatchOutcome* outcomes, ColumnWriter& output);
+
+  private: /* variables */
+
+    /// How the search is done
+    BalanceSweepSettings _settings;
+
+    /// Resources of the matches
+    MatchAssets const& _assets;
+
+    /// Index of each axis' parameter in the table of tunable parameters
+    std::vector<size_t> _axisParameters;
+
+    /// Threads among which matches are spread
+    ThreadPool _threadPool;
+
+    /// Parameters, values of the varied parameters and outcomes of the matches, of the current batch
+    std::vector<GameplayParameters> _batchParameters;
+    std::vector<double> _batchValues;
+    std::vector<MatchOutcome> _batchOutcomes;
+
+    /// Values of a row being written
+    std::vector<double> _row;
+};
+
+} // namespace FaceFight
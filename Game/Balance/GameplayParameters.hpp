@@ -0,0 +1,39 @@
+/* A file containing the gameplay parameters that balance a match */
+
+#pragma once
+
+#include <cstddef>
+
+namespace FaceFight
+{
+
+/**
+ * Numbers that decide how fighters fight, which can be tuned without rebuilding the game.
+ * A match holds its own parameters, and its entities read them through a pointer,
+ * so matches with different parameters can run side by side.
+ * Parameters hold no pointers, so they can be copied byte by byte.
+ */
+struct GameplayParameters
+{
+    /// Damage of a punch, and the distance by which it knocks back, on each shake
+    float punchPower = 5.f;
+
+    /// Distance to the fist that is reached when punching
+    float fistDistPunch = 150.f;
+
+    /// Durations of the punch and the get punched animations, in ticks
+    size_t punchAnimationDuration = 15;
+    size_t getPunchedAnimationDuration = 10;
+
+    /// Distance that an enemy walks on each tick
+    float enemySpeed = 5.f;
+
+    /// Distance at which enemies stop chasing the player and start punching
+    float punchDist = 250.f;
+
+    /// Time between enemy punches, and between enemy throws, in ticks
+    int enemyPunchFreq = 30;
+    int enemyThrowFreq = 120;
+};
+
+} // namespace FaceFight
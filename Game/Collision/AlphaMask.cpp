@@ -0,0 +1,121 @@
+#include "AlphaMask.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+
+int const BITS_PER_WORD = 64;
+
+/**
+ * Counts the set bits of a word
+ */
+int CountBits(uint64_t word)
+{
+    return __builtin_popcountll(word);
+}
+
+} // namespace
+
+AlphaMask::AlphaMask()
+    : _width(0),
+    _height(0),
+    _wordsPerRow(0)
+{}
+
+AlphaMask::AlphaMask(
+    sf::Image const& image,
+    sf::Vector2f const& scale,
+    sf::Uint8 alphaThreshold)
+{
+    sf::Vector2u const imageSize = image.getSize();
+    _width = (int)std::round(imageSize.x * std::abs(scale.x));
+    _height = (int)std::round(imageSize.y * std::abs(scale.y));
+    _wordsPerRow = (_width + BITS_PER_WORD - 1) / BITS_PER_WORD;
+    _words.assign((size_t)_wordsPerRow * _height, 0);
+
+    for (int y = 0; y < _height; y++)
+    {
+        // Each pixel of the mask takes the nearest pixel of the image
+        unsigned const imageY = std::min(
+            (unsigned)((y + 0.5f) * imageSize.y / _height), imageSize.y - 1);
+        for (int x = 0; x < _width; x++)
+        {
+            unsigned const imageX = std::min(
+                (unsigned)((x + 0.5f) * imageSize.x / _width), imageSize.x - 1);
+            if (image.getPixel(imageX, imageY).a >= alphaThreshold)
+            {
+                _words[(size_t)y * _wordsPerRow + x / BITS_PER_WORD] |=
+                    uint64_t(1) << (x % BITS_PER_WORD);
+            }
+        }
+    }
+}
+
+size_t AlphaMask::CountOverlap(
+    AlphaMask const& a, sf::Vector2i const& aPosition,
+    AlphaMask const& b, sf::Vector2i const& bPosition)
+{
+    // Bounding boxes are tested first, most pairs are rejected right here
+    int const left = std::max(aPosition.x, bPosition.x);
+    int const top = std::max(aPosition.y, bPosition.y);
+    int const right = std::min(aPosition.x + a._width, bPosition.x + b._width);
+    int const bottom = std::min(aPosition.y + a._height, bPosition.y + b._height);
+    if (left >= right || top >= bottom)
+    {
+        return 0;
+    }
+
+    // Overlapping rows are AND-ed 64 pixels at a time, in the columns of the first mask
+    size_t overlap = 0;
+    int const shift = bPosition.x - aPosition.x;
+    for (int y = top; y < bottom; y++)
+    {
+        int const aY = y - aPosition.y;
+        int const bY = y - bPosition.y;
+        for (int aX = left - aPosition.x; aX < right - aPosition.x; aX += BITS_PER_WORD)
+        {
+            uint64_t bits = a.GetBits(aY, aX) & b.GetBits(bY, aX - shift);
+            // Last word of the overlap may reach past its right edge
+            int const remaining = right - aPosition.x - aX;
+            if (remaining < BITS_PER_WORD)
+            {
+                bits &= (uint64_t(1) << remaining) - 1;
+            }
+            overlap += CountBits(bits);
+        }
+    }
+    return overlap;
+}
+
+sf::Vector2i AlphaMask::GetSize() const
+{
+    return {_width, _height};
+}
+
+bool AlphaMask::IsOpaque(int x, int y) const
+{
+    if (x < 0 || y < 0 || x >= _width || y >= _height)
+    {
+        return false;
+    }
+    return (_words[(size_t)y * _wordsPerRow + x / BITS_PER_WORD] >> (x % BITS_PER_WORD)) & 1;
+}
+
+uint64_t AlphaMask::GetBits(int y, int x) const
+{
+    uint64_t const* row = &_words[(size_t)y * _wordsPerRow];
+
+    // Floor division, since the column may be negative
+    int const word = (x >= 0) ? x / BITS_PER_WORD : -((-x + BITS_PER_WORD - 1) / BITS_PER_WORD);
+    int const offset = x - word * BITS_PER_WORD;
+
+    uint64_t const low = (word >= 0 && word < _wordsPerRow) ? row[word] : 0;
+    if (offset == 0)
+    {
+        return low;
+    }
+    uint64_t const high = (word + 1 >= 0 && word + 1 < _wordsPerRow) ? row[word + 1] : 0;
+    return (low >> offset) | (high << (BITS_PER_WORD - offset));
+}
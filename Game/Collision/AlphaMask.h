@@ -0,0 +1,109 @@
+#pragma once
+
+#include <SFML/Graphics/Image.hpp>
+#include <SFML/System/Vector2.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * A class for a 1-bit mask of the opaque pixels of an image,
+ * used for pixel-accurate collision tests.
+ * 
+ * The mask is built once, at the size at which the image is drawn,
+ * and each row is packed into 64-bit words, one bit per pixel.
+ * Two masks are tested against each other by rejecting them
+ * if their bounding boxes don't overlap, and otherwise by AND-ing
+ * the overlapping rows 64 pixels at a time and counting the set bits.
+ */
+class AlphaMask
+{
+
+  public:
+
+    /**
+     * Creates an empty mask, which never overlaps anything
+     */
+    AlphaMask();
+
+    /**
+     * Creates a mask of the opaque pixels of an image
+     * 
+     * @param[in] image
+     *  The image from which the mask is built
+     * @param[in] scale (optional)
+     *  Scale at which the image is drawn, the mask is built at that size
+     * @param[in] alphaThreshold (optional)
+     *  Pixels with at least this alpha are considered opaque
+     */
+    AlphaMask(
+        sf::Image const& image,
+        sf::Vector2f const& scale = {1.f, 1.f},
+        sf::Uint8 alphaThreshold = ALPHA_THRESHOLD_DEFAULT
+    );
+
+    /**
+     * Returns the number of pixels at which two masks are both opaque
+     * 
+     * @param[in] a
+     *  The first mask
+     * @param[in] aPosition
+     *  Position of the top left corner of the first mask
+     * @param[in] b
+     *  The second mask
+     * @param[in] bPosition
+     *  Position of the top left corner of the second mask
+     */
+    static size_t CountOverlap(
+        AlphaMask const& a, sf::Vector2i const& aPosition,
+        AlphaMask const& b, sf::Vector2i const& bPosition
+    );
+
+    /**
+     * Returns the size of the mask, in pixels
+     */
+    sf::Vector2i GetSize() const;
+
+    /**
+     * Checks if the pixel at the given position of the mask is opaque
+     * 
+     * @param[in] x
+     *  Column of the pixel
+     * @param[in] y
+     *  Row of the pixel
+     */
+    bool IsOpaque(int x, int y) const;
+
+  private:
+
+    /// The default alpha, from which a pixel is considered opaque
+    static constexpr sf::Uint8 ALPHA_THRESHOLD_DEFAULT = 128;
+
+  private: /* functions */
+
+    /**
+     * Returns 64 bits of a row, starting at the given column.
+     * Bits of pixels outside the mask are 0.
+     * 
+     * @param[in] y
+     *  Row of the mask
+     * @param[in] x
+     *  Column of the first bit, which may be outside the mask
+     */
+    uint64_t GetBits(int y, int x) const;
+
+  private: /* variables */
+
+    /// Size of the mask, in pixels
+    int _width;
+    int _height;
+
+    /// Number of 64-bit words in a single row
+    int _wordsPerRow;
+
+    /* Bits of all rows, one row after the other.
+       Bit i of word w of a row is the pixel in column 64 * w + i.
+       Bits past the width of the mask are 0. */
+    std::vector<uint64_t> _words;
+};
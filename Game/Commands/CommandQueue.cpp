@@ -0,0 +1,49 @@
+#include "CommandQueue.h"
+
+#include "../Entities/Entity.h"
+#include "../Parallel/ThreadPool.h"
+
+#include <algorithm>
+#include <tuple>
+
+namespace FaceFight
+{
+
+CommandQueue::CommandQueue(size_t threadsCount)
+    : _buffers(threadsCount)
+{
+    for (std::vector<Commands::Command>& buffer : _buffers)
+    {
+        buffer.reserve(BUFFER_CAPACITY_DEFAULT);
+    }
+    _merged.reserve(BUFFER_CAPACITY_DEFAULT * threadsCount);
+}
+
+void CommandQueue::Record(Commands::Command const& command)
+{
+    _buffers[ThreadPool::GetCurrentThreadIndex()].push_back(command);
+}
+
+void CommandQueue::Apply()
+{
+    _merged.clear();
+    for (std::vector<Commands::Command>& buffer : _buffers)
+    {
+        _merged.insert(_merged.end(), buffer.begin(), buffer.end());
+        buffer.clear();
+    }
+
+    // The order depends only on the commands themselves, never on the threads that recorded them
+    std::sort(_merged.begin(), _merged.end(),
+        [](Commands::Command const& a, Commands::Command const& b) {
+            return std::tie(a.targetId, a.type, a.sourceId, a.sequence)
+                < std::tie(b.targetId, b.type, b.sourceId, b.sequence);
+        });
+
+    for (Commands::Command const& command : _merged)
+    {
+        command.target->Execute(command);
+    }
+}
+
+} // namespace FaceFight
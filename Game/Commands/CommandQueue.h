@@ -0,0 +1,65 @@
+#pragma once
+
+#include "Commands.hpp"
+
+#include <cstddef>
+#include <vector>
+
+namespace FaceFight
+{
+
+/**
+ * A class for deferring changes that entities make to other entities.
+ * 
+ * While entities are updated, possibly on several threads,
+ * they don't change each other directly, they record commands instead.
+ * Each thread records into its own buffer, so recording needs no locks.
+ * Afterwards, all buffers are merged and sorted in a deterministic order,
+ * and commands are applied one by one on a single thread.
+ * That way updates can run in parallel,
+ * and the result doesn't depend on the order in which entities were updated.
+ */
+class CommandQueue
+{
+
+  public:
+
+    /**
+     * Creates a command queue with a buffer for each thread
+     * 
+     * @param[in] threadsCount
+     *  Number of threads that will record commands,
+     *  as given by ThreadPool::GetThreadsCount()
+     */
+    CommandQueue(size_t threadsCount);
+
+    /**
+     * Records a command into the buffer of the calling thread,
+     * indexed by ThreadPool::GetCurrentThreadIndex() within the pool the threads were counted from.
+     * Callers running outside of that pool's loops have to open a ThreadPool::CallerScope.
+     * 
+     * @param[in] command
+     *  The command to be recorded
+     */
+    void Record(Commands::Command const& command);
+
+    /**
+     * Merges the buffers of all threads, sorts the commands,
+     * applies them to their target entities, and empties the buffers.
+     * Must not be called while commands are being recorded.
+     */
+    void Apply();
+
+  private: /* variables */
+
+    /// The default capacity of each buffer. Buffers grow if needed, and keep their capacity.
+    static constexpr size_t BUFFER_CAPACITY_DEFAULT = 1024;
+
+    /// A buffer of recorded commands for each thread
+    std::vector<std::vector<Commands::Command>> _buffers;
+
+    /// Commands of all buffers, merged and sorted
+    std::vector<Commands::Command> _merged;
+};
+
+} // namespace FaceFight
@@ -0,0 +1,56 @@
+/* A file containing the commands that entities record for other entities */
+
+#pragma once
+
+#include <SFML/System/Vector2.hpp>
+
+#include <cstdint>
+
+namespace FaceFight
+{
+
+class Entity;
+
+    namespace Commands
+    {
+
+        /// Animations that can be played on an entity by a command
+        enum class Animation : uint8_t { Punch, GetPunched };
+
+        /**
+         * A deferred change to an entity, recorded by another entity.
+         * Commands are applied in the order of their target, type, source and sequence,
+         * so the result doesn't depend on which thread recorded them or when.
+         */
+        struct Command
+        {
+            enum class Type : uint8_t { Damage, Knockback, PlayAnimation };
+
+            /// Type of the command, telling which of the data fields is used
+            Type type;
+
+            /// ID of the entity that the command changes
+            uint32_t targetId;
+
+            /// ID of the entity that recorded the command
+            uint32_t sourceId;
+
+            /// Number of commands the source entity had recorded before this one
+            uint32_t sequence;
+
+            /// The entity that the command changes
+            Entity* target;
+
+            /// Health points taken, for damage commands
+            int damage;
+
+            /// Unit vector of the direction of the push, for knockback commands
+            sf::Vector2f direction;
+
+            /// The animation to be played, for play animation commands
+            Animation animation;
+        };
+
+    } // namespace Commands
+
+} // namespace FaceFight
@@ -0,0 +1,176 @@
+#include "CrowdSeparation.h"
+
+#include <algorithm>
+#include <cmath>
+
+CrowdSeparation::CrowdSeparation(
+    size_t capacity,
+    int iterations,
+    int maxNeighbours)
+    : _iterations(iterations),
+    _maxNeighbours(maxNeighbours),
+    _cellSize(1.f),
+    _bucketsCount(1),
+    _buckets(capacity),
+    _sortedIndices(capacity),
+    _sortedXs(capacity),
+    _sortedYs(capacity),
+    _pushXs(capacity),
+    _pushYs(capacity)
+{
+    // Twice as many buckets as circles keeps hash collisions rare
+    while (_bucketsCount < capacity * 2)
+    {
+        _bucketsCount *= 2;
+    }
+    _bucketStarts.resize(_bucketsCount + 1);
+}
+
+void CrowdSeparation::Resolve(
+    float* xs,
+    float* ys,
+    size_t count,
+    float radius,
+    ThreadPool& threadPool)
+{
+    if (count < 2 || radius <= 0.f)
+    {
+        return;
+    }
+    _cellSize = 2 * radius;
+
+    // Circles move less than a cell in a single step, so the grid is built only once per step
+    BuildGrid(xs, ys, count);
+
+    for (int iteration = 0; iteration < _iterations; iteration++)
+    {
+        threadPool.ParallelFor(count, [this](size_t begin, size_t end) {
+            ComputePushes(begin, end);
+        });
+        threadPool.ParallelFor(count, [this](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++)
+            {
+                _sortedXs[i] += _pushXs[i];
+                _sortedYs[i] += _pushYs[i];
+            }
+        });
+    }
+
+    // Write the new positions back in the original order
+    threadPool.ParallelFor(count, [this, xs, ys](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+        {
+            xs[_sortedIndices[i]] = _sortedXs[i];
+            ys[_sortedIndices[i]] = _sortedYs[i];
+        }
+    });
+}
+
+uint32_t CrowdSeparation::GetBucket(int32_t cellX, int32_t cellY) const
+{
+    /* Row-major order, wrapped around the number of buckets.
+       Neighbouring cells of a row get neighbouring buckets, so their circles are close in memory */
+    return ((uint32_t)cellY * ROW_STRIDE + (uint32_t)cellX) & (_bucketsCount - 1);
+}
+
+void CrowdSeparation::BuildGrid(float const* xs, float const* ys, size_t count)
+{
+    // Counting sort of the circles by bucket. It keeps the original order within a bucket,
+    // so the neighbours of each circle are always visited in the same order.
+    std::fill(_bucketStarts.begin(), _bucketStarts.end(), 0);
+    for (size_t i = 0; i < count; i++)
+    {
+        _buckets[i] = GetBucket(
+            (int32_t)std::floor(xs[i] / _cellSize),
+            (int32_t)std::floor(ys[i] / _cellSize));
+        _bucketStarts[_buckets[i] + 1]++;
+    }
+    for (uint32_t b = 0; b < _bucketsCount; b++)
+    {
+        _bucketStarts[b + 1] += _bucketStarts[b];
+    }
+    for (size_t i = 0; i < count; i++)
+    {
+        // Bucket starts are used as insertion cursors, and shifted back afterwards
+        uint32_t const sorted = _bucketStarts[_buckets[i]]++;
+        _sortedIndices[sorted] = i;
+        _sortedXs[sorted] = xs[i];
+        _sortedYs[sorted] = ys[i];
+    }
+    for (uint32_t b = _bucketsCount; b > 0; b--)
+    {
+        _bucketStarts[b] = _bucketStarts[b - 1];
+    }
+    _bucketStarts[0] = 0;
+}
+
+void CrowdSeparation::ComputePushes(size_t begin, size_t end)
+{
+    float const diameter = _cellSize;
+    float const diameterSquared = diameter * diameter;
+
+    for (size_t i = begin; i < end; i++)
+    {
+        float const x = _sortedXs[i];
+        float const y = _sortedYs[i];
+        int32_t const cellX = (int32_t)std::floor(x / _cellSize);
+        int32_t const cellY = (int32_t)std::floor(y / _cellSize);
+
+        float pushX = 0.f;
+        float pushY = 0.f;
+        int tested = 0;
+
+        // Neighbouring cells can hash to the same bucket, which must be visited only once
+        uint32_t visitedBuckets[9];
+        int visitedCount = 0;
+
+        for (int32_t dy = -1; dy <= 1; dy++)
+        {
+            for (int32_t dx = -1; dx <= 1; dx++)
+            {
+                uint32_t const bucket = GetBucket(cellX + dx, cellY + dy);
+                if (std::find(visitedBuckets, visitedBuckets + visitedCount, bucket)
+                    != visitedBuckets + visitedCount)
+                {
+                    continue;
+                }
+                visitedBuckets[visitedCount++] = bucket;
+
+                uint32_t const bucketEnd = _bucketStarts[bucket + 1];
+                for (uint32_t j = _bucketStarts[bucket]; j < bucketEnd && tested < _maxNeighbours; j++)
+                {
+                    if (j == i)
+                    {
+                        continue;
+                    }
+                    tested++;
+
+                    float const offsetX = x - _sortedXs[j];
+                    float const offsetY = y - _sortedYs[j];
+                    float const distSquared = offsetX * offsetX + offsetY * offsetY;
+                    if (distSquared >= diameterSquared)
+                    {
+                        continue;
+                    }
+
+                    if (distSquared > 0.f)
+                    {
+                        // Each of the two circles moves half of the overlap
+                        float const dist = std::sqrt(distSquared);
+                        float const push = 0.5f * (diameter - dist) / dist;
+                        pushX += offsetX * push;
+                        pushY += offsetY * push;
+                    }
+                    else
+                    {
+                        // Circles on the same spot are split along the x-axis, by their order
+                        pushX += (i < j ? -0.5f : 0.5f) * diameter;
+                    }
+                }
+            }
+        }
+
+        _pushXs[i] = pushX;
+        _pushYs[i] = pushY;
+    }
+}
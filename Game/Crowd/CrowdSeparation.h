@@ -0,0 +1,118 @@
+#pragma once
+
+#include "../Parallel/ThreadPool.h"
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * A class that keeps a crowd of equally sized circles from overlapping.
+ * 
+ * Circles are put in a uniform grid (wrapped around, so the arena doesn't need bounds),
+ * so that each circle is only tested against circles in neighbouring cells.
+ * Overlaps are then resolved with a few relaxation iterations,
+ * where each circle is pushed away from all circles it overlaps.
+ * Each iteration first computes all pushes from the old positions, and then applies them,
+ * so circles can be processed in parallel, and the result doesn't depend on the number of threads.
+ * 
+ * The number of iterations and the number of neighbours tested per circle are fixed,
+ * so the cost per tick is bounded and linear in the number of circles,
+ * no matter how densely the crowd is packed.
+ */
+class CrowdSeparation
+{
+
+  public:
+
+    /**
+     * Creates a crowd separation step, allocating all memory it will need
+     * 
+     * @param[in] capacity
+     *  Maximum number of circles in the crowd
+     * @param[in] iterations (optional)
+     *  Number of relaxation iterations per step
+     * @param[in] maxNeighbours (optional)
+     *  Maximum number of neighbours tested against each circle in an iteration
+     */
+    CrowdSeparation(
+        size_t capacity,
+        int iterations = ITERATIONS_DEFAULT,
+        int maxNeighbours = MAX_NEIGHBOURS_DEFAULT
+    );
+
+    /**
+     * Pushes apart overlapping circles, and writes back their new positions
+     * 
+     * @param[in,out] xs
+     *  x-coordinates of the circles' centers
+     * @param[in,out] ys
+     *  y-coordinates of the circles' centers
+     * @param[in] count
+     *  Number of circles, at most the capacity
+     * @param[in] radius
+     *  Radius of each circle
+     * @param[in] threadPool
+     *  Thread pool running the relaxation iterations
+     */
+    void Resolve(
+        float* xs,
+        float* ys,
+        size_t count,
+        float radius,
+        ThreadPool& threadPool
+    );
+
+  private:
+
+    /// The default number of relaxation iterations per step
+    static constexpr int ITERATIONS_DEFAULT = 3;
+
+    /// The default maximum number of neighbours tested against each circle
+    static constexpr int MAX_NEIGHBOURS_DEFAULT = 24;
+
+    /// Number of buckets between two rows of grid cells
+    static constexpr uint32_t ROW_STRIDE = 1024;
+
+  private: /* functions */
+
+    /// Returns the bucket of the grid cell with the given coordinates
+    uint32_t GetBucket(int32_t cellX, int32_t cellY) const;
+
+    /// Sorts the circles by bucket, so that circles in the same cell are next to each other
+    void BuildGrid(float const* xs, float const* ys, size_t count);
+
+    /// Computes the push of each circle in the range, from the current positions
+    void ComputePushes(size_t begin, size_t end);
+
+  private: /* variables */
+
+    /// Number of relaxation iterations per step
+    int _iterations;
+
+    /// Maximum number of neighbours tested against each circle
+    int _maxNeighbours;
+
+    /// Size of a grid cell, equal to the diameter of the circles
+    float _cellSize;
+
+    /// Number of buckets of the grid, a power of two
+    uint32_t _bucketsCount;
+
+    /// Index of the first circle of each bucket in the sorted order, followed by the total count
+    std::vector<uint32_t> _bucketStarts;
+
+    /// Bucket of each circle, in the original order
+    std::vector<uint32_t> _buckets;
+
+    /// Original index of each circle in the sorted order
+    std::vector<uint32_t> _sortedIndices;
+
+    /// Positions of the circles, in the sorted order
+    std::vector<float> _sortedXs;
+    std::vector<float> _sortedYs;
+
+    /// Push of each circle in the current iteration, in the sorted order
+    std::vector<float> _pushXs;
+    std::vector<float> _pushYs;
+};
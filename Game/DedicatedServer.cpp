@@ -0,0 +1,176 @@
+#include "DedicatedServer.h"
+
+#include "AI/ScriptedBot.h"
+
+#include <algorithm>
+
+namespace
+{
+
+// Matches are taken by threads one at a time, since a single match is a lot of work
+size_t const MATCHES_CHUNK_SIZE = 1;
+
+} // namespace
+
+namespace FaceFight
+{
+
+DedicatedServer::DedicatedServer(DedicatedServerSettings const& settings, MatchAssets const& assets)
+    : _botsForMissingClients(settings.botsForMissingClients),
+    _matches(settings.matchesCount),
+    _threadPool(settings.workersCount),
+    _lateTicksCount(0)
+{
+    for (size_t m = 0; m < _matches.size(); m++)
+    {
+        HostedMatch& hosted = _matches[m];
+
+        // Each match ticks on a single thread, so it has no workers of its own
+        MatchSettings matchSettings;
+        matchSettings.mode = GameMode::Server;
+        matchSettings.seed = settings.seed + m;
+        matchSettings.size = settings.size;
+        matchSettings.maxEnemies = 1;
+        matchSettings.maxProjectiles = settings.maxProjectiles;
+        matchSettings.workersCount = 0;
+        hosted.match.reset(new Match(matchSettings, assets));
+
+        // Until a side is played, its fighter stays where it is
+        Match const& match = *hosted.match;
+        std::array<FighterInput, SIDES> initialInputs{};
+        initialInputs[0].target = match.GetPlayer().GetPosition();
+        initialInputs[1].target = match.GetOpponent().GetPosition();
+
+        // Any client of the match may take a side, the first one that contacts its port keeps it
+        for (size_t s = 0; s < SIDES; s++)
+        {
+            hosted.channels[s].reset(new UdpChannel(
+                (unsigned short)(settings.basePort + m * SIDES + s), sf::IpAddress::Any, 0));
+            hosted.sessions[s].reset(new ServerSession(
+                *hosted.channels[s], match.GetSetupToken(), initialInputs[s]));
+        }
+    }
+}
+
+void DedicatedServer::Tick()
+{
+    sf::Clock tickClock;
+    _threadPool.ParallelFor(_matches.size(), [this](size_t begin, size_t end) {
+        for (size_t m = begin; m < end; m++)
+        {
+            TickMatch(_matches[m]);
+        }
+    }, MATCHES_CHUNK_SIZE);
+    _tickTime = tickClock.getElapsedTime();
+}
+
+void DedicatedServer::Run(uint64_t ticks)
+{
+    sf::Time const tickPeriod = sf::seconds(1.f / Match::TICK_RATE);
+    sf::Clock clock;
+    sf::Time nextTick = clock.getElapsedTime();
+    for (uint64_t t = 0; t < ticks; t++)
+    {
+        Tick();
+
+        nextTick += tickPeriod;
+        sf::Time const now = clock.getElapsedTime();
+        if (now < nextTick)
+        {
+            sf::sleep(nextTick - now);
+        }
+        else
+        {
+            _lateTicksCount++;
+            nextTick = now;
+        }
+    }
+}
+
+size_t DedicatedServer::GetMatchesCount() const
+{
+    return _matches.size();
+}
+
+bool DedicatedServer::IsPlaying(size_t m) const
+{
+    HostedMatch const& hosted = _matches[m];
+    return std::all_of(hosted.sessions.begin(), hosted.sessions.end(),
+        [this](std::unique_ptr<ServerSession> const& session) {
+            return session->IsConnected() || _botsForMissingClients;
+        });
+}
+
+sf::Time DedicatedServer::GetTickLatency(size_t m) const
+{
+    return _matches[m].tickLatency;
+}
+
+sf::Time DedicatedServer::GetMaxTickLatency(size_t m) const
+{
+    return _matches[m].maxTickLatency;
+}
+
+sf::Time DedicatedServer::GetTickTime() const
+{
+    return _tickTime;
+}
+
+uint64_t DedicatedServer::GetLateTicksCount() const
+{
+    return _lateTicksCount;
+}
+
+size_t DedicatedServer::GetThreadsCount() const
+{
+    return _threadPool.GetThreadsCount();
+}
+
+void DedicatedServer::TickMatch(HostedMatch& hosted)
+{
+    sf::Clock latencyClock;
+
+    for (std::unique_ptr<ServerSession>& session : hosted.sessions)
+    {
+        session->Receive();
+    }
+
+    Match& match = *hosted.match;
+    size_t const m = &hosted - _matches.data();
+    if (IsPlaying(m))
+    {
+        std::array<FighterInput, SIDES> inputs;
+        for (size_t s = 0; s < SIDES; s++)
+        {
+            inputs[s] = hosted.sessions[s]->IsConnected()
+                ? hosted.sessions[s]->TakeInput()
+                : ScriptedBot::GetInput(match, s);
+        }
+        match.Update(inputs[0], inputs[1]);
+
+        // Both clients are sent the same snapshot, each encoded against what that client has
+        hosted.snapshot.Clear((uint32_t)match.GetTick());
+        for (Entity const* fighter : {&match.GetPlayer(), &match.GetOpponent()})
+        {
+            hosted.snapshot.AddFighter(fighter->GetId(), fighter->GetPosition(), fighter->GetFistOffset(),
+                fighter->GetHealth(), fighter->IsGettingPunched());
+        }
+        ProjectileSystem const& projectiles = match.GetProjectiles();
+        for (size_t p = 0; p < projectiles.GetCount(); p++)
+        {
+            if (!hosted.snapshot.AddProjectile(projectiles.GetPosition(p)))
+            {
+                break;
+            }
+        }
+        for (std::unique_ptr<ServerSession>& session : hosted.sessions)
+        {
+            session->SendSnapshot(hosted.snapshot);
+        }
+    }
+
+    hosted.tickLatency = latencyClock.getElapsedTime();
+    hosted.maxTickLatency = std::max(hosted.maxTickLatency, hosted.tickLatency);
+}
+
+} // namespace FaceFight
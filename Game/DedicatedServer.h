@@ -0,0 +1,186 @@
+#pragma once
+
+#include "Match.h"
+
+#include "Network/UdpChannel.h"
+#include "Network/NetSnapshot.h"
+#include "Network/ServerSession.h"
+
+#include "Parallel/ThreadPool.h"
+
+#include <SFML/System.hpp>
+
+#include <array>
+#include <memory>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace FaceFight
+{
+
+/// How a dedicated server and its matches are set up
+struct DedicatedServerSettings
+{
+    /// Number of matches hosted at the same time
+    size_t matchesCount = 1;
+
+    /// Port of the first side of the first match, each next side takes the next port
+    unsigned short basePort = 0;
+
+    /// Seed of the first match, each next match takes the next seed
+    uint64_t seed = 0;
+
+    /// Size of the arena, which has to be the size of the clients' screens
+    sf::Vector2f size;
+
+    /// Maximum number of fists in flight in a single match
+    size_t maxProjectiles = NetSnapshot::MAX_PROJECTILES;
+
+    /// Number of worker threads ticking matches, besides the calling thread
+    size_t workersCount = ThreadPool::GetDefaultWorkersCount();
+
+    /// Sides without a client are played by a bot, so that matches can be measured without clients
+    bool botsForMissingClients = false;
+};
+
+/**
+ * A class for a server without a window, hosting many independent matches in one process.
+ * 
+ * Each match is played by two clients, each connected to its own port,
+ * and is simulated only on the server, which sends the clients what happens.
+ * A match starts once both of its sides are played.
+ * 
+ * On each tick, matches are spread across a pool of threads,
+ * and each match is ticked on a single thread,
+ * so that no match waits for another and there is no locking between them.
+ * Every match allocates all of its memory when it is created,
+ * sized for a duel of two players, so ticking doesn't allocate at all.
+ */
+class DedicatedServer
+{
+
+  public:
+
+    /**
+     * Creates the matches and binds the ports of all of them
+     * 
+     * @param[in] settings
+     *  How the server and its matches are set up
+     * @param[in] assets
+     *  Resources of the matches, loaded without textures, which have to outlive the server
+     */
+    DedicatedServer(DedicatedServerSettings const& settings, MatchAssets const& assets);
+
+    DedicatedServer(DedicatedServer const&) = delete;
+    DedicatedServer& operator=(DedicatedServer const&) = delete;
+
+    /**
+     * Ticks every match once
+     */
+    void Tick();
+
+    /**
+     * Ticks every match at the tick rate of a match, for the given number of ticks.
+     * Ticks that come late aren't made up for, the next tick is scheduled from then.
+     * 
+     * @param[in] ticks
+     *  Number of ticks to run
+     */
+    void Run(uint64_t ticks);
+
+    /**
+     * Returns the number of hosted matches
+     */
+    size_t GetMatchesCount() const;
+
+    /**
+     * Tells whether a match is being played
+     * 
+     * @param[in] m
+     *  Index of the match
+     */
+    bool IsPlaying(size_t m) const;
+
+    /**
+     * Returns how long the last tick of a match took, on its thread
+     * 
+     * @param[in] m
+     *  Index of the match
+     */
+    sf::Time GetTickLatency(size_t m) const;
+
+    /**
+     * Returns the longest tick of a match so far
+     * 
+     * @param[in] m
+     *  Index of the match
+     */
+    sf::Time GetMaxTickLatency(size_t m) const;
+
+    /**
+     * Returns how long ticking all matches took the last time
+     */
+    sf::Time GetTickTime() const;
+
+    /**
+     * Returns the number of ticks that started later than they were scheduled
+     */
+    uint64_t GetLateTicksCount() const;
+
+    /**
+     * Returns the number of threads ticking matches
+     */
+    size_t GetThreadsCount() const;
+
+  private:
+
+    /// Number of sides of a match, each played by its own client
+    static constexpr size_t SIDES = 2;
+
+    /// A match and everything that connects it to its clients
+    struct HostedMatch
+    {
+        std::unique_ptr<Match> match;
+
+        /// Channel and session of each side
+        std::array<std::unique_ptr<UdpChannel>, SIDES> channels;
+        std::array<std::unique_ptr<ServerSession>, SIDES> sessions;
+
+        /// Snapshot sent to both clients, filled on every tick
+        NetSnapshot snapshot;
+
+        /// How long the last tick, and the longest tick so far, took
+        sf::Time tickLatency;
+        sf::Time maxTickLatency;
+    };
+
+  private: /* functions */
+
+    /**
+     * Receives the clients' input, ticks the match if it is played, and sends it to the clients
+     * 
+     * @param[in] hosted
+     *  The match to be ticked
+     */
+    void TickMatch(HostedMatch& hosted);
+
+  private: /* variables */
+
+    /// Tells whether sides without a client are played by a bot
+    bool _botsForMissingClients;
+
+    /// The hosted matches
+    std::vector<HostedMatch> _matches;
+
+    /// Threads among which matches are spread
+    ThreadPool _threadPool;
+
+    /// How long ticking all matches took the last time
+    sf::Time _tickTime;
+
+    /// Number of ticks that started later than they were scheduled
+    uint64_t _lateTicksCount;
+};
+
+} // namespace FaceFight
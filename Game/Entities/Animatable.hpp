@@ -1,45 +1,49 @@
 #pragma once
 
-#include <map>
-#include <string>
-#include <functional>
+#include <tuple>
+#include <cstddef>
 
 /**
- * A base class for objects that can be animated based on some parameter of type T.
+ * A base class for objects that can be animated through a fixed set of actions.
  * The inherited class can easily create animations of its variables,
- * by creating actions, which are defined with a function
+ * by creating actions, which are defined with an act policy
  * that specifies exactly how to animate the object at every instance.
  * Then the inherited class can play/pause/stop each of the created actions
  * in an appropriate moment of the runtime of a game.
+ * 
+ * The set of actions is known at compile time,
+ * so actions are stored directly in the object and accessed by their type,
+ * and updating the animation calls each act policy directly,
+ * without any lookups or type-erased function objects.
+ * 
+ * @param[in] Actions
+ *  Types of the actions of the animation, each of them being an AnimationAction.
+ *  Each action type can be listed only once.
  */
-template <class T>
+template <class... Actions>
 class Animatable
 {
 
   protected:
 
-    class Action;
-
     /**
-     * Adds a new action to the animation
+     * Creates an animation consisting of the given actions
      * 
-     * @param[in] id
-     *  String ID of the action, that will be used to access the action
-     * @param[in] action
-     *  The action that will be added to the animation
+     * @param[in] actions
+     *  The actions of which the animation consists
      */
-    void AddAction(std::string const& id, Action const&);
+    Animatable(Actions const&... actions);
 
     /**
      * Returns a reference to the action
-     * with the requested ID
-     * 
-     * @param[in] id
-     *  String ID of the requested action
+     * with the requested type
      * 
      * @return a reference to the requested action
      */
-    Action& GetAction(std::string const& id);
+    template <class ActionType>
+    ActionType& GetAction();
+    template <class ActionType>
+    ActionType const& GetAction() const;
 
     /**
      * Updates animation for next frame,
@@ -53,9 +57,8 @@ class Animatable
 
   private:
 
-    /* Map of registered actions.
-       It maps action IDs to the corresponding action objects */
-    std::map<std::string, Action> _actionsMap;
+    /// The actions of which the animation consists
+    std::tuple<Actions...> _actions;
 };
 
 /**
@@ -63,43 +66,67 @@ class Animatable
  * An action is a single thing happening in the animation.
  * It acts on a single object with a single function.
  * More specificaly an action consists of a pointer to an object,
- * and a function that describes how that object changes with time.
+ * and a policy that describes how that object changes with time.
  * Also actions have durations and can be easily started and stopped.
+ * 
+ * @param[in] T
+ *  Type of the object on which the action acts
+ * @param[in] ActPolicy
+ *  A class with a static function void Act(T*, float),
+ *  taking in a pointer to an object, on which to act,
+ *  and an instance in the duration of the action, as a number between 0 and 1.
+ *  (0 meaning the beginning of the action, 1 meaning the end)
+ *  That function is supposed to describe the desired state of the object
+ *  at each instance of the action.
  */
-template <class T>
-class Animatable<T>::Action
+template <class T, class ActPolicy>
+class AnimationAction
 {
 
+  public:
+
+    /// Where the action is in its playback, without the object it acts on
+    struct State
+    {
+        size_t frame;
+        bool playing;
+        bool paused;
+    };
+
   public:
 
     /**
-     * Creates an action for the given object,
-     * defined by the given act function.
+     * Creates an action for the given object
      * 
      * @param[in] objPtr
      *  Pointer to the object on which the action will act
-     * @param[in] actFunc
-     *  Function taking in a pointer to an object, on which to act,
-     *  and an instance in the duration of the action, as a number between 0 and 1.
-     *  (0 meaning the beginning of the action, 1 meaning the end)
-     *  That function is supposed to describe the desired state of the object
-     *  at each instance of the action.
      * @param[in] duration
      *  Duration of the action, in frames
      */
-    Action(
+    AnimationAction(
         T* objPtr,
-        std::function<void(T*, float)> actFunc,
         size_t duration
     );
 
     /**
      * Updates the action for next frame.
      * If the action is currently playing,
-     * the act function will be applied to the object.
+     * the act policy will be applied to the object.
      */
     void UpdateAction();
 
+    /**
+     * Skips frames of the action, without acting on the object in between.
+     * If the action ends during the skipped frames,
+     * the act policy is applied for the end of the action,
+     * so the object is left the same as if the frames had been played.
+     * Meant for catching up with actions whose intermediate states aren't seen.
+     * 
+     * @param[in] frames
+     *  Number of frames to skip
+     */
+    void SkipFrames(size_t frames);
+
     /**
      * Starts playing the action from the beginning.
      * If the action is paused, it can be continued
@@ -125,19 +152,33 @@ class Animatable<T>::Action
      */
     void Continue();
 
+    /**
+     * Returns where the action is in its playback
+     */
+    State GetState() const;
+
+    /**
+     * Moves the action to the given point of its playback,
+     * without acting on the object
+     * 
+     * @param[in] state
+     *  State returned by GetState(), of an action with the same duration
+     */
+    void SetState(State const& state);
+
+    /**
+     * Changes the duration of the action, meant to be called while it isn't playing
+     * 
+     * @param[in] duration
+     *  Duration of the action, in frames
+     */
+    void SetDuration(size_t duration);
+
   private:
 
     /// Pointer to the object on which the action acts
     T* _objPtr;
 
-    /// An act function, describing the state of the object at every instance
-    std::function<
-        void(
-            T*, // Pointer to the object on which the act function will act
-            float // Instance in the action, a number between 0 and 1
-        )
-    > _actFunc;
-
     /// Duration of the action, in frames
     size_t _duration;
 
@@ -151,57 +192,50 @@ class Animatable<T>::Action
     bool _paused;
 };
 
-template <class T>
-void Animatable<T>::AddAction(
-    std::string const& id, Action const& action)
+template <class... Actions>
+Animatable<Actions...>::Animatable(Actions const&... actions)
+    : _actions(actions...)
+{}
+
+template <class... Actions>
+template <class ActionType>
+ActionType& Animatable<Actions...>::GetAction()
 {
-    if (_actionsMap.find(id) != _actionsMap.end())
-    {
-        throw "Error: Action with ID " + id + " has already been added to the animation.";
-    }
-    _actionsMap.insert(typename decltype(_actionsMap)::value_type(id, action));
+    return std::get<ActionType>(_actions);
 }
 
-template <class T>
-typename Animatable<T>::Action&
-Animatable<T>::GetAction(std::string const& id)
+template <class... Actions>
+template <class ActionType>
+ActionType const& Animatable<Actions...>::GetAction() const
 {
-    if (_actionsMap.find(id) == _actionsMap.end())
-    {
-        throw "Error: There is no action with ID " + id + " in the animation.";
-    }
-    return _actionsMap.find(id)->second;
+    return std::get<ActionType>(_actions);
 }
 
-template <class T>
-void Animatable<T>::UpdateAnimation()
+template <class... Actions>
+void Animatable<Actions...>::UpdateAnimation()
 {
-    for (auto& idActionPair : _actionsMap)
-    {
-        Action& action = idActionPair.second;
-        action.UpdateAction();
-    }
+    std::apply([](Actions&... actions) {
+        (actions.UpdateAction(), ...);
+    }, _actions);
 }
 
-template <class T>
-Animatable<T>::Action::Action(
+template <class T, class ActPolicy>
+AnimationAction<T, ActPolicy>::AnimationAction(
     T* objPtr,
-    std::function<void(T*, float)> actFunc,
     size_t duration)
     : _objPtr(objPtr),
-    _actFunc(actFunc),
     _duration(duration),
     _frame(0),
     _playing(false),
     _paused(false)
 {}
 
-template <class T>
-void Animatable<T>::Action::UpdateAction()
+template <class T, class ActPolicy>
+void AnimationAction<T, ActPolicy>::UpdateAction()
 {
     if (_playing)
     {
-        _actFunc(
+        ActPolicy::Act(
             _objPtr,
             (float)_frame / (_duration - 1) // duration - 1 because we want the instance to be between 0 and 1 inclusive
         );
@@ -214,34 +248,69 @@ void Animatable<T>::Action::UpdateAction()
     }
 }
 
-template <class T>
-void Animatable<T>::Action::Play()
+template <class T, class ActPolicy>
+void AnimationAction<T, ActPolicy>::SkipFrames(size_t frames)
+{
+    if (_playing)
+    {
+        _frame += frames;
+        if (_frame >= _duration)
+        {
+            ActPolicy::Act(_objPtr, 1.f);
+            _playing = false;
+            _frame = 0;
+        }
+    }
+}
+
+template <class T, class ActPolicy>
+void AnimationAction<T, ActPolicy>::Play()
 {
     _frame = 0;
     _playing = true;
     _paused = false; // in case it was paused, the pause is lost after replaying
 }
 
-template <class T>
-void Animatable<T>::Action::Stop()
+template <class T, class ActPolicy>
+void AnimationAction<T, ActPolicy>::Stop()
 {
     _playing = false;
     _paused = false;
 }
 
-template <class T>
-void Animatable<T>::Action::Pause()
+template <class T, class ActPolicy>
+void AnimationAction<T, ActPolicy>::Pause()
 {
     _playing = false;
     _paused = true;
 }
 
-template <class T>
-void Animatable<T>::Action::Continue()
+template <class T, class ActPolicy>
+void AnimationAction<T, ActPolicy>::Continue()
 {
     if (_paused)
     {
         _playing = true;
         _paused = false;
     }
-}
\ No newline at end of file
+}
+
+template <class T, class ActPolicy>
+typename AnimationAction<T, ActPolicy>::State AnimationAction<T, ActPolicy>::GetState() const
+{
+    return {_frame, _playing, _paused};
+}
+
+template <class T, class ActPolicy>
+void AnimationAction<T, ActPolicy>::SetState(State const& state)
+{
+    _frame = state.frame;
+    _playing = state.playing;
+    _paused = state.paused;
+}
+
+template <class T, class ActPolicy>
+void AnimationAction<T, ActPolicy>::SetDuration(size_t duration)
+{
+    _duration = duration;
+}
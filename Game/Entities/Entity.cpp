@@ -1,88 +1,330 @@
 #include "Entity.h"
 
+#include "../Commands/CommandQueue.h"
 #include "../Geometry/Geometry.hpp"
+#include "../Random/RandomPurposes.hpp"
+
+#include <algorithm>
+#include <cmath>
 
 namespace
 {
 
 /// Distance to fist by default
 float const FIST_DIST_DEFAULT = 100.f;
-/// Distance to fist that is reached when punching the enemy
-float const FIST_DIST_PUNCH = 150.f;
 
-size_t const PUNCH_ANIMATION_DURATION = 15;
+/// Parameters of entities that don't belong to a match
+FaceFight::GameplayParameters const DEFAULT_PARAMETERS;
 
-size_t const GET_PUNCHED_ANIMATION_DURATION = 10;
+/// With reduced detail, cosmetic animations catch up once per this many frames
+size_t const REDUCED_DETAIL_CATCH_UP_RATE = 4;
 
-float PUNCH_POWER = 5.f;
+/// Probability of a punch being critical
+float const CRITICAL_PUNCH_CHANCE = 0.1f;
+/// How many times more damage a critical punch deals
+int const CRITICAL_PUNCH_MULTIPLIER = 2;
 
-int PUNCH_SOUND_VOLUME = 35;
+/**
+ * Moves the sprite's origin to its center,
+ * and caches the sprite's bounds in the scene node that positions it.
+ * Supposed to be called every time the sprite's texture or scale changes.
+ */
+void CacheSpriteBounds(sf::Sprite& sprite, SceneNode& node)
+{
+    sf::FloatRect const localBounds = sprite.getLocalBounds();
+    sprite.setOrigin(localBounds.width / 2.f, localBounds.height / 2.f);
+    // Sprite itself is never moved, so its global bounds are its bounds relative to the node
+    node.SetLocalBounds(sprite.getGlobalBounds());
+}
+
+/**
+ * Adds a sprite, placed by the scene node that positions it, to the sprites to be drawn,
+ * unless it has no texture, in which case it isn't drawn at all
+ */
+void CaptureSprite(sf::Sprite const& sprite, SceneNode const& node, std::vector<FaceFight::RenderSprite>& sprites)
+{
+    if (sprite.getTexture() == nullptr)
+    {
+        return;
+    }
+    sprites.push_back(FaceFight::RenderSprite{
+        sprite.getTexture(),
+        sprite.getTextureRect(),
+        sprite.getColor(),
+        node.GetWorldTransform() * sprite.getTransform()});
+}
+
+/**
+ * Returns the position of the top left corner of a mask centered on the given point
+ */
+sf::Vector2i GetMaskPosition(AlphaMask const& mask, sf::Vector2f const& center)
+{
+    sf::Vector2i const size = mask.GetSize();
+    return {
+        (int)std::round(center.x - size.x / 2.f),
+        (int)std::round(center.y - size.y / 2.f)
+    };
+}
 
 } // namespace
 
 namespace FaceFight
 {
 
+/**
+ * Act policy of the punch action.
+ * The fist goes from its default distance to the punch distance, and back.
+ */
+struct PunchAct
+{
+    static void Act(Entity* entity, float instance)
+    {
+        float const fistDistPunch = entity->_parameters->fistDistPunch;
+        if (instance < 0.5f)
+        {
+            entity->_fistDist = FIST_DIST_DEFAULT
+                + 2 * instance * (fistDistPunch - FIST_DIST_DEFAULT);
+        }
+        else
+        {
+            entity->_fistDist = FIST_DIST_DEFAULT
+                + 2 * (1 - instance) * (fistDistPunch - FIST_DIST_DEFAULT);
+        }
+    }
+};
+
+/**
+ * Act policy of the get punched action.
+ * The face turns red and the entity shakes along the direction it was pushed in.
+ */
+struct GetPunchedAct
+{
+    static void Act(Entity* entity, float instance)
+    {
+        if (instance <= 0.0001f)
+        {
+            entity->_face.setColor(sf::Color::Red);
+        }
+        if (instance >= 0.9999f)
+        {
+            entity->_face.setColor(sf::Color::White);
+        }
+
+        // Direction comes from the knockback command, so other entities are never read
+        sf::Vector2f const& knockbackDirection = entity->_knockbackDirection;
+        float const punchPower = entity->_parameters->punchPower;
+
+        if ((int)(instance * 20) % 2 == 0)
+        {
+            entity->Move(knockbackDirection * punchPower);
+        }
+        else
+        {
+            entity->Move(-knockbackDirection * punchPower);
+        }
+    }
+};
+
 Entity::Entity()
-    : _fistDist(FIST_DIST_DEFAULT),
+    : Animatable(
+        PunchAction(this, DEFAULT_PARAMETERS.punchAnimationDuration),
+        GetPunchedAction(this, DEFAULT_PARAMETERS.getPunchedAnimationDuration)
+    ),
+    _faceMask(nullptr),
+    _fistMask(nullptr),
+    _fistNode(&_faceNode),
+    _fistDist(FIST_DIST_DEFAULT),
     _enemy(nullptr),
-    _health(MAX_HEALTH)
-{
-    InitAnimations();
-}
+    _health(MAX_HEALTH),
+    _eventBus(nullptr),
+    _random(nullptr),
+    _parameters(&DEFAULT_PARAMETERS),
+    _commandQueue(nullptr),
+    _id(0),
+    _commandSequence(0),
+    _knockbackDirection(0.f, 0.f),
+    _skippedFrames(0),
+    _punchCooldownRunning(false)
+{}
 
 Entity::Entity(
     sf::Texture const& faceTexture,
     sf::Texture const& fistTexture,
     sf::Vector2f const& position)
-    : _face(faceTexture),
+    : Animatable(
+        PunchAction(this, DEFAULT_PARAMETERS.punchAnimationDuration),
+        GetPunchedAction(this, DEFAULT_PARAMETERS.getPunchedAnimationDuration)
+    ),
+    _face(faceTexture),
     _fist(fistTexture),
+    _faceMask(nullptr),
+    _fistMask(nullptr),
+    _fistNode(&_faceNode),
     _fistDist(FIST_DIST_DEFAULT),
     _enemy(nullptr),
-    _health(MAX_HEALTH)
+    _health(MAX_HEALTH),
+    _eventBus(nullptr),
+    _random(nullptr),
+    _parameters(&DEFAULT_PARAMETERS),
+    _commandQueue(nullptr),
+    _id(0),
+    _commandSequence(0),
+    _knockbackDirection(0.f, 0.f),
+    _skippedFrames(0),
+    _punchCooldownRunning(false)
+{
+    CacheSpriteBounds(_face, _faceNode);
+    CacheSpriteBounds(_fist, _fistNode);
+    Movable::SetPosition(position);
+}
+
+Entity::Entity(
+    Entity const& prototype,
+    sf::Vector2f const& position)
+    : Movable(prototype),
+    Animatable(
+        PunchAction(this, prototype._parameters->punchAnimationDuration),
+        GetPunchedAction(this, prototype._parameters->getPunchedAnimationDuration)
+    ),
+    _face(prototype._face),
+    _fist(prototype._fist),
+    _faceMask(prototype._faceMask),
+    _fistMask(prototype._fistMask),
+    _faceNode(prototype._faceNode),
+    _fistNode(prototype._fistNode),
+    _fistDist(FIST_DIST_DEFAULT),
+    _enemy(prototype._enemy),
+    _health(MAX_HEALTH),
+    _eventBus(prototype._eventBus),
+    _random(prototype._random),
+    _parameters(prototype._parameters),
+    _commandQueue(prototype._commandQueue),
+    _id(prototype._id),
+    _commandSequence(0),
+    _knockbackDirection(0.f, 0.f),
+    _skippedFrames(0),
+    _punchCooldownRunning(false)
 {
+    // Cached bounds are copied from the prototype, only the hierarchy has to point to our own nodes
+    _fistNode.SetParent(&_faceNode);
+    _face.setColor(sf::Color::White);
     Movable::SetPosition(position);
-    InitAnimations();
 }
 
-void Entity::DrawFace(
-    sf::RenderTarget& renderTarget) const
+void Entity::CaptureFace(
+    std::vector<RenderSprite>& sprites) const
+{
+    CaptureSprite(_face, _faceNode, sprites);
+}
+
+void Entity::CaptureFist(
+    std::vector<RenderSprite>& sprites) const
+{
+    CaptureSprite(_fist, _fistNode, sprites);
+}
+
+void Entity::Update(Detail detail)
 {
-    renderTarget.draw(_face);
-    renderTarget.draw(_fist);
+    UpdateAnimations(detail);
+    UpdateFist(detail);
 }
 
-void Entity::DrawFist(
-    sf::RenderTarget& renderTarget) const
+void Entity::UpdateAnimations(Detail detail)
 {
-    renderTarget.draw(_fist);
+    if (detail == Detail::Full)
+    {
+        CatchUpCosmeticAnimations();
+        UpdateAnimation();
+        return;
+    }
+
+    // Getting punched moves the entity, so it is played frame by frame either way
+    GetAction<GetPunchedAction>().UpdateAction();
+
+    _skippedFrames++;
+    if (_skippedFrames >= REDUCED_DETAIL_CATCH_UP_RATE)
+    {
+        CatchUpCosmeticAnimations();
+    }
 }
 
-void Entity::Update()
+void Entity::UpdateFist(Detail detail)
 {
-    Animatable<float>::UpdateAnimation();
-    Animatable<Entity>::UpdateAnimation();
-    PointFistTowardsEnemy();
+    if (detail == Detail::Full)
+    {
+        PointFistTowardsEnemy();
+    }
 }
 
 void Entity::SetFaceTexture(sf::Texture const& faceTexture)
 {
     _face.setTexture(faceTexture);
+    CacheSpriteBounds(_face, _faceNode);
 }
 
 void Entity::SetFistTexture(sf::Texture const& fistTexture)
 {
     _fist.setTexture(fistTexture);
+    CacheSpriteBounds(_fist, _fistNode);
+}
+
+void Entity::SetFaceSize(sf::Vector2u const& size)
+{
+    // Sprite's bounds come from its texture rectangle, which doesn't need a texture
+    _face.setTextureRect(sf::IntRect(0, 0, (int)size.x, (int)size.y));
+    CacheSpriteBounds(_face, _faceNode);
+}
+
+void Entity::SetFistSize(sf::Vector2u const& size)
+{
+    _fist.setTextureRect(sf::IntRect(0, 0, (int)size.x, (int)size.y));
+    CacheSpriteBounds(_fist, _fistNode);
 }
 
 void Entity::SetFaceScale(sf::Vector2f const& scale)
 {
     _face.setScale(scale);
+    CacheSpriteBounds(_face, _faceNode);
 }
 
 void Entity::SetFistScale(sf::Vector2f const& scale)
 {
     _fist.setScale(scale);
+    CacheSpriteBounds(_fist, _fistNode);
+}
+
+void Entity::SetFaceMask(AlphaMask const* const faceMask)
+{
+    _faceMask = faceMask;
+}
+
+void Entity::SetFistMask(AlphaMask const* const fistMask)
+{
+    _fistMask = fistMask;
+}
+
+bool Entity::CanHit(Entity const& target) const
+{
+    // Where the fist will be at the peak of the punch
+    sf::Vector2f const fistCenter = GetPosition() + _parameters->fistDistPunch * Geometry::NormaliseVector(
+        Geometry::GetVector(GetPosition(), target.GetPosition())
+    );
+
+    if (_fistMask == nullptr || target._faceMask == nullptr)
+    {
+        sf::FloatRect fistBounds = _fistNode.GetLocalBounds();
+        fistBounds.left += fistCenter.x;
+        fistBounds.top += fistCenter.y;
+        sf::FloatRect faceBounds = target._faceNode.GetLocalBounds();
+        faceBounds.left += target.GetPosition().x;
+        faceBounds.top += target.GetPosition().y;
+        return fistBounds.intersects(faceBounds);
+    }
+
+    return AlphaMask::CountOverlap(
+        *_fistMask, GetMaskPosition(*_fistMask, fistCenter),
+        *target._faceMask, GetMaskPosition(*target._faceMask, target.GetPosition())
+    ) > 0;
 }
 
 void Entity::SetEnemy(
@@ -91,19 +333,198 @@ void Entity::SetEnemy(
     _enemy = enemy;
 }
 
-void Entity::SetPunchSoundBuffer(sf::SoundBuffer& punchSoundBuffer)
+Entity* Entity::GetEnemy() const
+{
+    return _enemy;
+}
+
+void Entity::SetEventBus(
+    GameEventBus* const eventBus)
+{
+    _eventBus = eventBus;
+}
+
+void Entity::SetRandom(
+    CounterRandom const* const random)
+{
+    _random = random;
+}
+
+void Entity::SetParameters(
+    GameplayParameters const* const parameters)
+{
+    _parameters = parameters;
+    GetAction<PunchAction>().SetDuration(parameters->punchAnimationDuration);
+    GetAction<GetPunchedAction>().SetDuration(parameters->getPunchedAnimationDuration);
+}
+
+void Entity::SetCommandQueue(
+    CommandQueue* const commandQueue)
+{
+    _commandQueue = commandQueue;
+}
+
+void Entity::SetId(uint32_t id)
 {
-    _punchSound.setBuffer(punchSoundBuffer);
-    _punchSound.setVolume(PUNCH_SOUND_VOLUME);
+    _id = id;
 }
 
-void Entity::PunchEnemy(bool enemyCanGetPunched)
+uint32_t Entity::GetId() const
 {
-    Animatable<float>::GetAction("punch").Play();
-    _punchSound.play();
+    return _id;
+}
+
+void Entity::Execute(Commands::Command const& command)
+{
+    switch (command.type)
+    {
+        case Commands::Command::Type::Damage:
+            TakeDamage(command.damage);
+            break;
+        case Commands::Command::Type::Knockback:
+            _knockbackDirection = command.direction;
+            break;
+        case Commands::Command::Type::PlayAnimation:
+            PlayAnimation(command.animation);
+            break;
+    }
+}
+
+void Entity::PunchEnemy(uint64_t tick, bool enemyCanGetPunched)
+{
+    GetAction<PunchAction>().Play();
+    PublishEvent(Events::Punch{this});
     if (enemyCanGetPunched)
     {
-        _enemy->GetPunched();
+        int damage = (int)_parameters->punchPower;
+        if (_random != nullptr)
+        {
+            // Drawn from this entity's own stream, so it doesn't matter who punches first
+            CounterRandom::Stream random = _random->GetStream(
+                _id, tick, (uint32_t)RandomPurpose::CriticalPunch);
+            if (random.NextFloat() < CRITICAL_PUNCH_CHANCE)
+            {
+                damage *= CRITICAL_PUNCH_MULTIPLIER;
+            }
+        }
+
+        PublishEvent(Events::Hit{this, _enemy, damage});
+
+        Commands::Command command{};
+        command.type = Commands::Command::Type::Damage;
+        command.damage = damage;
+        RecordCommand(command);
+
+        command = {};
+        command.type = Commands::Command::Type::Knockback;
+        command.direction = Geometry::NormaliseVector(
+            Geometry::GetVector(GetPosition(), _enemy->GetPosition())
+        );
+        RecordCommand(command);
+
+        command = {};
+        command.type = Commands::Command::Type::PlayAnimation;
+        command.animation = Commands::Animation::GetPunched;
+        RecordCommand(command);
+    }
+}
+
+float Entity::GetFaceRadius() const
+{
+    sf::FloatRect const& faceBounds = _faceNode.GetLocalBounds();
+    return std::min(faceBounds.width, faceBounds.height) / 2.f;
+}
+
+bool Entity::CanPunch() const
+{
+    return !_punchCooldownRunning;
+}
+
+void Entity::StartPunchCooldown(TimerWheel& timerWheel, uint64_t ticks)
+{
+    CancelPunchCooldown(timerWheel);
+    _punchCooldownTimer = timerWheel.Schedule<Entity, &Entity::OnPunchCooldownEnded>(ticks, this);
+    _punchCooldownRunning = true;
+}
+
+void Entity::CancelPunchCooldown(TimerWheel& timerWheel)
+{
+    if (_punchCooldownRunning)
+    {
+        timerWheel.Cancel(_punchCooldownTimer);
+        _punchCooldownRunning = false;
+    }
+}
+
+void Entity::Save(ByteBuffer& buffer, TimerWheel const& timerWheel) const
+{
+    buffer.Write(GetPosition());
+    buffer.Write(_health);
+    buffer.Write(_fistDist);
+    buffer.Write(GetAction<PunchAction>().GetState());
+    buffer.Write(GetAction<GetPunchedAction>().GetState());
+    buffer.Write(_id);
+    buffer.Write(_commandSequence);
+    buffer.Write(_knockbackDirection);
+    buffer.Write(_skippedFrames);
+    // Cooldown is written as the ticks left, since the timer itself lives in the wheel
+    buffer.Write(_punchCooldownRunning ? timerWheel.GetRemainingTicks(_punchCooldownTimer) : uint64_t(0));
+}
+
+void Entity::Load(ByteBuffer& buffer, TimerWheel& timerWheel)
+{
+    sf::Vector2f const position = buffer.Read<sf::Vector2f>();
+    _health = buffer.Read<int>();
+    _fistDist = buffer.Read<float>();
+    GetAction<PunchAction>().SetState(buffer.Read<PunchAction::State>());
+    GetAction<GetPunchedAction>().SetState(buffer.Read<GetPunchedAction::State>());
+    _id = buffer.Read<uint32_t>();
+    _commandSequence = buffer.Read<uint32_t>();
+    _knockbackDirection = buffer.Read<sf::Vector2f>();
+    _skippedFrames = buffer.Read<size_t>();
+
+    // The timer wheel has been reset, so the old timer is gone
+    _punchCooldownRunning = false;
+    uint64_t const cooldownTicks = buffer.Read<uint64_t>();
+    if (cooldownTicks > 0)
+    {
+        StartPunchCooldown(timerWheel, cooldownTicks);
+    }
+
+    // Face is red for as long as the entity is getting punched
+    _face.setColor(IsGettingPunched() ? sf::Color::Red : sf::Color::White);
+    Movable::SetPosition(position);
+}
+
+sf::Vector2f const& Entity::GetFistOffset() const
+{
+    return _fistNode.GetPosition();
+}
+
+bool Entity::IsGettingPunched() const
+{
+    return GetAction<GetPunchedAction>().GetState().playing;
+}
+
+void Entity::ShowSeenState(
+    sf::Vector2f const& position,
+    sf::Vector2f const& fistOffset,
+    int health,
+    bool gettingPunched)
+{
+    Movable::SetPosition(position);
+    _fistNode.SetPosition(fistOffset);
+    _health = health;
+    _face.setColor(gettingPunched ? sf::Color::Red : sf::Color::White);
+}
+
+void Entity::TakeSceneStats(SceneNode::Stats& stats)
+{
+    for (SceneNode* node : {&_faceNode, &_fistNode})
+    {
+        stats.recomputed += node->GetStats().recomputed;
+        stats.reused += node->GetStats().reused;
+        node->ResetStats();
     }
 }
 
@@ -119,10 +540,8 @@ bool Entity::IsAlive() const
 
 void Entity::FollowCenter()
 {
-    _face.setPosition({
-        Movable::GetPosition().x - _face.getGlobalBounds().width / 2,
-        Movable::GetPosition().y - _face.getGlobalBounds().height / 2
-    });
+    // Face node is centered, so its position is the entity's center
+    _faceNode.SetPosition(Movable::GetPosition());
 }
 
 void Entity::PointFistTowardsEnemy()
@@ -130,8 +549,7 @@ void Entity::PointFistTowardsEnemy()
     // If there is no enemy, just point fist to the right
     if (_enemy == nullptr || !IsAlive())
     {
-        _fist.setPosition(this->GetPosition() + sf::Vector2f(_fistDist, 0.f)
-            - sf::Vector2f(_fist.getGlobalBounds().width / 2.f, _fist.getGlobalBounds().height / 2.f));
+        _fistNode.SetPosition(sf::Vector2f(_fistDist, 0.f));
         return;
     }
 
@@ -149,85 +567,65 @@ void Entity::PointFistTowardsEnemy()
        to be pointing towards the enemy and be such distance away from this entity */
     sf::Vector2f fistVector = enemyUnitVector * _fistDist;
 
-    // What is left is to move the fist there
-    _fist.setPosition(this->GetPosition() + fistVector
-        - sf::Vector2f(_fist.getGlobalBounds().width / 2.f, _fist.getGlobalBounds().height / 2.f));
+    // What is left is to move the fist there, relative to the face
+    _fistNode.SetPosition(fistVector);
 }
 
-void Entity::GetPunched()
+void Entity::CatchUpCosmeticAnimations()
 {
-    Animatable<Entity>::GetAction("get-punched").Play();
-    _health -= PUNCH_POWER;
+    if (_skippedFrames > 0)
+    {
+        // The fist lunge is only seen, so nothing in between has to be played
+        GetAction<PunchAction>().SkipFrames(_skippedFrames);
+        _skippedFrames = 0;
+    }
 }
 
-void Entity::InitAnimations()
+void Entity::OnPunchCooldownEnded()
 {
-    // Add punching action to the animation
-    Animatable<float>::AddAction(
-        "punch",
-        ConstructPunchAction()
-    );
-
-    // Add getting punched action to the animation
-    Animatable<Entity>::AddAction(
-        "get-punched",
-        ConstructGetPunchedAction()
-    );
+    _punchCooldownRunning = false;
 }
 
-Animatable<float>::Action Entity::ConstructPunchAction()
+void Entity::RecordCommand(Commands::Command command)
 {
-    return {
-        &_fistDist,
-        [](float* fistDist, float instance) {
-            if (instance < 0.5f)
-            {
-                *fistDist = FIST_DIST_DEFAULT
-                    + 2 * instance * (FIST_DIST_PUNCH - FIST_DIST_DEFAULT);
-            }
-            else
-            {
-                *fistDist = FIST_DIST_DEFAULT
-                    + 2 * (1 - instance) * (FIST_DIST_PUNCH - FIST_DIST_DEFAULT);
-            }
-        },
-        PUNCH_ANIMATION_DURATION
-    };
+    command.targetId = _enemy->_id;
+    command.sourceId = _id;
+    command.sequence = _commandSequence++;
+    command.target = _enemy;
+
+    if (_commandQueue != nullptr)
+    {
+        _commandQueue->Record(command);
+    }
+    else
+    {
+        _enemy->Execute(command);
+    }
 }
 
-Animatable<Entity>::Action Entity::ConstructGetPunchedAction()
+void Entity::TakeDamage(int damage)
 {
-    return {
-        this,
-        [](Entity* entity, float instance) {
-            if (instance <= 0.0001f)
-            {
-                entity->_face.setColor(sf::Color::Red);
-            }
-            if (instance >= 0.9999f)
-            {
-                entity->_face.setColor(sf::Color::White);
-            }
+    bool wasAlive = IsAlive();
+    _health -= damage;
 
-            // Unit vector from enemy to this entity
-            sf::Vector2f fromEnemyUnitVector = Geometry::NormaliseVector(
-                Geometry::GetVector(
-                    entity->_enemy->GetPosition(),
-                    entity->GetPosition()
-                )
-            );
+    PublishEvent(Events::HealthChanged{this, _health});
+    if (wasAlive && !IsAlive())
+    {
+        PublishEvent(Events::Died{this});
+    }
+}
 
-            if ((int)(instance * 20) % 2 == 0)
-            {
-                entity->Move(fromEnemyUnitVector * PUNCH_POWER);
-            }
-            else
-            {
-                entity->Move(-fromEnemyUnitVector * PUNCH_POWER);
-            }
-        },
-        GET_PUNCHED_ANIMATION_DURATION
-    };
+void Entity::PlayAnimation(Commands::Animation animation)
+{
+    switch (animation)
+    {
+        case Commands::Animation::Punch:
+            GetAction<PunchAction>().Play();
+            break;
+        case Commands::Animation::GetPunched:
+            GetAction<GetPunchedAction>().Play();
+            break;
+    }
 }
 
 } // namespace FaceFight
\ No newline at end of file
@@ -1,14 +1,38 @@
 #pragma once
 
 #include "Animatable.hpp"
-#include "Movable.h"
+#include "Movable.hpp"
+
+#include "../Balance/GameplayParameters.hpp"
+#include "../Collision/AlphaMask.h"
+#include "../Commands/Commands.hpp"
+#include "../Events/Events.hpp"
+#include "../Random/CounterRandom.h"
+#include "../Rendering/RenderSnapshot.hpp"
+#include "../Scene/SceneNode.h"
+#include "../Serialization/ByteBuffer.h"
+#include "../Timing/TimerWheel.h"
 
 #include <SFML/Graphics.hpp>
-#include <SFML/Audio.hpp>
 
 namespace FaceFight
 {
 
+class Entity;
+class CommandQueue;
+
+/// Act policy of the punch action - entity's distance to fist is animated
+struct PunchAct;
+
+/// Act policy of the get punched action - the whole entity is animated
+struct GetPunchedAct;
+
+/// Action for punch animation
+using PunchAction = AnimationAction<Entity, PunchAct>;
+
+/// Action for getting punched animation
+using GetPunchedAction = AnimationAction<Entity, GetPunchedAct>;
+
 /**
  * A class representing an entity in the game.
  * Entities have a face, which is their main visual component,
@@ -18,13 +42,39 @@ namespace FaceFight
  * which brings down their enemy's health points.
  * 
  * @sidenote: An entity's position is considered to be the center of their face
+ * 
+ * Face and fist are placed through a small transform hierarchy,
+ * where the fist node is a child of the face node,
+ * so the fist is positioned relative to the center of the face.
+ * 
+ * Entities can be updated with less detail when they aren't seen,
+ * which skips what is only cosmetic, but keeps gameplay exact.
+ * 
+ * Entities don't change each other directly.
+ * When punching, an entity records commands for its enemy on a command queue,
+ * and they are executed later, when the queue is applied.
  */
 class Entity :
-    public Movable,
-    public Animatable<float>, // for punch animation - distance to fist will be animated
-    public Animatable<Entity> // for getting punched animation - the whole entity will be animated
+    public Movable<Entity>,
+    public Animatable<PunchAction, GetPunchedAction>
 {
 
+    friend class Movable<Entity>;
+    friend struct PunchAct;
+    friend struct GetPunchedAct;
+
+  public:
+
+    /// How detailed an entity's update is
+    enum class Detail
+    {
+        /// Everything is updated every frame, for entities that are seen
+        Full,
+        /* Only gameplay is updated every frame, for entities that aren't seen.
+           Cosmetic animations catch up every few frames, and the fist isn't pointed */
+        Reduced
+    };
+
   public:
 
     /**
@@ -49,25 +99,74 @@ class Entity :
     );
 
     /**
-     * Draws the entity's face on the given render target
+     * Creates an entity as a copy of a prototype entity, on the given position.
+     * Textures, scales, enemy and event bus are shared with the prototype,
+     * and the animations are set up for the new entity,
+     * so no memory is allocated, and no textures are loaded.
+     * The new entity starts with full health and no punch cooldown.
+     * 
+     * @param[in] prototype
+     *  Entity that the new entity will be a copy of
+     * @param[in] position
+     *  Initial position of the entity
+     */
+    Entity(
+        Entity const& prototype,
+        sf::Vector2f const& position
+    );
+
+    /* Entities keep pointers to their own members,
+       so they can only be copied through the prototype constructor */
+    Entity(Entity const&) = delete;
+    Entity& operator=(Entity const&) = delete;
+
+    /**
+     * Adds the entity's face, as it is now, to the sprites to be drawn
      * 
-     * @param[in] renderTarget
-     *  Render target on which to draw the entity's face
+     * @param[in] sprites
+     *  Sprites of a render snapshot, to which the face is added
      */
-    void DrawFace(sf::RenderTarget& renderTarget) const;
+    void CaptureFace(std::vector<RenderSprite>& sprites) const;
 
     /**
-     * Draws the entity's fist on the given render target
+     * Adds the entity's fist, as it is now, to the sprites to be drawn
      * 
-     * @param[in] renderTarget
-     *  Render target on which to draw the entity's fist
+     * @param[in] sprites
+     *  Sprites of a render snapshot, to which the fist is added
      */
-    void DrawFist(sf::RenderTarget& renderTarget) const;
+    void CaptureFist(std::vector<RenderSprite>& sprites) const;
 
     /**
-     * Updates the entity for the next frame
+     * Updates the entity for the next frame.
+     * Same as calling UpdateAnimations() and then UpdateFist().
+     * 
+     * @param[in] detail (optional)
+     *  How detailed the update is
      */
-    void Update();
+    void Update(Detail detail = Detail::Full);
+
+    /**
+     * Updates the entity's own animations for the next frame.
+     * Only changes this entity, so different entities can be updated in parallel.
+     * 
+     * @param[in] detail (optional)
+     *  How detailed the update is.
+     *  With reduced detail the punch animation isn't played frame by frame,
+     *  but the getting punched animation is, since it moves the entity.
+     */
+    void UpdateAnimations(Detail detail = Detail::Full);
+
+    /**
+     * Points the entity's fist towards its enemy.
+     * Only reads the enemy's position, so it has to be called
+     * after the animations of all entities have been updated.
+     * 
+     * @param[in] detail (optional)
+     *  How detailed the update is.
+     *  With reduced detail the fist isn't seen, so it's left as it is,
+     *  and it is pointed again as soon as it is updated with full detail.
+     */
+    void UpdateFist(Detail detail = Detail::Full);
 
     /**
      * Sets a texture for entity's face
@@ -85,6 +184,24 @@ class Entity :
      */
     void SetFistTexture(sf::Texture const& fistTexture);
 
+    /**
+     * Sets the size of entity's face without a texture,
+     * for entities that are never drawn, such as on a dedicated server
+     * 
+     * @param[in] size
+     *  Size of the face image, before scaling
+     */
+    void SetFaceSize(sf::Vector2u const& size);
+
+    /**
+     * Sets the size of entity's fist without a texture,
+     * for entities that are never drawn
+     * 
+     * @param[in] size
+     *  Size of the fist image, before scaling
+     */
+    void SetFistSize(sf::Vector2u const& size);
+
     /**
      * Sets scale for the face sprite
      * 
@@ -101,6 +218,35 @@ class Entity :
      */
     void SetFistScale(sf::Vector2f const& scale);
 
+    /**
+     * Sets the mask of the opaque pixels of the face, used when the entity gets hit
+     * 
+     * @param[in] faceMask
+     *  Pointer to the mask, built at the face's scale,
+     *  or nullptr to test the face's bounds instead
+     */
+    void SetFaceMask(AlphaMask const* const faceMask);
+
+    /**
+     * Sets the mask of the opaque pixels of the fist, used when the entity hits
+     * 
+     * @param[in] fistMask
+     *  Pointer to the mask, built at the fist's scale,
+     *  or nullptr to test the fist's bounds instead
+     */
+    void SetFistMask(AlphaMask const* const fistMask);
+
+    /**
+     * Checks if a punch would land on the target,
+     * meaning that the entity's fist, fully extended towards the target,
+     * overlaps the target's face in at least one opaque pixel.
+     * Only positions are read, so it can be called from any thread.
+     * 
+     * @param[in] target
+     *  The entity that would be punched
+     */
+    bool CanHit(Entity const& target) const;
+
     /**
      * Sets the given entity to be this entity's enemy
      * 
@@ -110,23 +256,177 @@ class Entity :
     void SetEnemy(Entity* const enemy);
 
     /**
-     * Sets the punching sound of the entity
+     * Returns a pointer to this entity's enemy,
+     * or nullptr if the entity has no enemy
+     */
+    Entity* GetEnemy() const;
+
+    /**
+     * Sets the event bus on which the entity publishes what happens to it
+     * 
+     * @param[in] eventBus
+     *  Pointer to the event bus, or nullptr if events should not be published
+     */
+    void SetEventBus(GameEventBus* const eventBus);
+
+    /**
+     * Sets the random number generator used for the entity's critical punches
+     * 
+     * @param[in] random
+     *  Pointer to the generator of the match, or nullptr if punches are never critical
+     */
+    void SetRandom(CounterRandom const* const random);
+
+    /**
+     * Sets the gameplay parameters by which the entity punches and gets punched
+     * 
+     * @param[in] parameters
+     *  Pointer to the parameters of the match, which have to outlive the entity
+     */
+    void SetParameters(GameplayParameters const* const parameters);
+
+    /**
+     * Sets the command queue on which the entity records changes to other entities
+     * 
+     * @param[in] commandQueue
+     *  Pointer to the command queue,
+     *  or nullptr if commands should be executed right away
+     */
+    void SetCommandQueue(CommandQueue* const commandQueue);
+
+    /**
+     * Sets the entity's ID, which orders the commands executed on entities.
+     * IDs of entities that exist at the same time have to be unique.
      * 
-     * @param[in] punchSoundBuffer
-     *  Sound buffer of the sound to be played when the entity punches
+     * @param[in] id
+     *  ID of the entity
      */
-    void SetPunchSoundBuffer(sf::SoundBuffer& punchSoundBuffer);
+    void SetId(uint32_t id);
+
+    /**
+     * Returns the entity's ID
+     */
+    uint32_t GetId() const;
+
+    /**
+     * Executes a command that another entity recorded for this entity
+     * 
+     * @param[in] command
+     *  The command to be executed, having this entity as its target
+     */
+    void Execute(Commands::Command const& command);
 
     /**
      * Punches the enemy using entity's fist.
-     * Plays the punching animation of the fist.
-     * If enemy is not close enough, they don't get punched
+     * Plays the punching animation of the fist,
+     * and publishes a punch event, and a hit event if the punch lands.
+     * The enemy's damage, knockback and animation are recorded as commands.
+     * If enemy is not close enough, they don't get punched.
+     * Some punches are critical and deal more damage, as decided by the random generator.
      * 
+     * @param[in] tick
+     *  Tick of the simulation on which the entity punches
      * @param[in] enemyCanGetPunched
      *  Specifies whether the enemy can be punched,
      *  meaning that they are alive and close enough
      */
-    void PunchEnemy(bool enemyCanGetPunched = true);
+    void PunchEnemy(uint64_t tick, bool enemyCanGetPunched = true);
+
+    /**
+     * Returns the radius of the circle enclosed by the entity's face,
+     * centered on the entity's position
+     */
+    float GetFaceRadius() const;
+
+    /**
+     * Checks if the entity's punch cooldown has passed,
+     * so that it can punch again
+     */
+    bool CanPunch() const;
+
+    /**
+     * Starts the entity's punch cooldown.
+     * The entity cannot punch again until the cooldown passes.
+     * 
+     * @param[in] timerWheel
+     *  Timer wheel on which the end of the cooldown is scheduled
+     * @param[in] ticks
+     *  Duration of the cooldown, in frames
+     */
+    void StartPunchCooldown(TimerWheel& timerWheel, uint64_t ticks);
+
+    /**
+     * Cancels the entity's punch cooldown, if it is running.
+     * Has to be called before the entity is destroyed while a cooldown is running.
+     * 
+     * @param[in] timerWheel
+     *  Timer wheel on which the cooldown was started
+     */
+    void CancelPunchCooldown(TimerWheel& timerWheel);
+
+    /**
+     * Writes the entity's simulation state to a buffer.
+     * Textures, masks and pointers to other objects of the game are not written,
+     * they are the same for the entity that the state will be read into.
+     * 
+     * @param[in] buffer
+     *  Buffer to which the state is written
+     * @param[in] timerWheel
+     *  Timer wheel on which the entity's punch cooldown is scheduled
+     */
+    void Save(ByteBuffer& buffer, TimerWheel const& timerWheel) const;
+
+    /**
+     * Reads the entity's simulation state from a buffer, written by Save().
+     * The entity's punch cooldown is scheduled again on the timer wheel,
+     * which has to have been reset to the tick of the saved state.
+     * The entity's enemy is not changed.
+     * 
+     * @param[in] buffer
+     *  Buffer from which the state is read
+     * @param[in] timerWheel
+     *  Timer wheel on which the punch cooldown is scheduled
+     */
+    void Load(ByteBuffer& buffer, TimerWheel& timerWheel);
+
+    /**
+     * Returns the position of the entity's fist, relative to the entity
+     */
+    sf::Vector2f const& GetFistOffset() const;
+
+    /**
+     * Checks if the entity is playing its getting punched animation
+     */
+    bool IsGettingPunched() const;
+
+    /**
+     * Shows the entity as it was seen elsewhere, such as on a server,
+     * without simulating anything
+     * 
+     * @param[in] position
+     *  Position of the entity
+     * @param[in] fistOffset
+     *  Position of the entity's fist, relative to the entity
+     * @param[in] health
+     *  Health points of the entity
+     * @param[in] gettingPunched
+     *  Whether the entity is getting punched, which turns its face red
+     */
+    void ShowSeenState(
+        sf::Vector2f const& position,
+        sf::Vector2f const& fistOffset,
+        int health,
+        bool gettingPunched
+    );
+
+    /**
+     * Adds the counters of world transform computations of the entity's face and fist to the given ones,
+     * and resets them
+     * 
+     * @param[in] stats
+     *  Counters to which the entity's counters are added
+     */
+    void TakeSceneStats(SceneNode::Stats& stats);
 
     /**
      * Returns a reference to entity's health points
@@ -156,43 +456,75 @@ class Entity :
     void PointFistTowardsEnemy();
 
     /**
-     * Gets punched by the enemy.
-     * Plays the getting punched animation,
-     * and decreases health points
+     * Catches up with the frames of cosmetic animations
+     * skipped since the last full detail update
+     */
+    void CatchUpCosmeticAnimations();
+
+    /**
+     * Ends the punch cooldown, when its timer expires
      */
-    void GetPunched();
+    void OnPunchCooldownEnded();
 
     /**
-     * Initializes entity's animations
+     * Records a command for the enemy,
+     * or executes it right away if the entity has no command queue
+     * 
+     * @param[in] command
+     *  The command to be recorded, without its target, source and sequence
      */
-    void InitAnimations();
+    void RecordCommand(Commands::Command command);
 
     /**
-     * Constructs the punch action for the punch animation
+     * Decreases health points and publishes the change
      * 
-     * @return punch action
+     * @param[in] damage
+     *  Health points to be taken
      */
-    Animatable<float>::Action ConstructPunchAction();
+    void TakeDamage(int damage);
 
     /**
-     * Constructs the get punched action for the get punched animation
+     * Plays one of the entity's animations from the beginning
      * 
-     * @return get punched action
+     * @param[in] animation
+     *  The animation to be played
      */
-    Animatable<Entity>::Action ConstructGetPunchedAction();
+    void PlayAnimation(Commands::Animation animation);
+
+    /**
+     * Publishes the given event on the entity's event bus,
+     * if the entity has one
+     * 
+     * @param[in] event
+     *  The event to be published
+     */
+    template <class EventType>
+    void PublishEvent(EventType const& event);
 
   private: /* variables */
 
     /* Face of the entitiy,
-       as an SFML sprite, which points to a texture,
-       and keeps track of the entity's position */
+       as an SFML sprite, which points to a texture.
+       The sprite's origin is at its center, its position comes from the face node */
     sf::Sprite _face;
 
     /* Fist of the entitiy,
-       as an SFML sprite, which points to a texture,
-       and keeps track of the entity's position */
+       as an SFML sprite, which points to a texture.
+       The sprite's origin is at its center, its position comes from the fist node */
     sf::Sprite _fist;
 
+    /// Mask of the opaque pixels of the face, shared between entities with the same face
+    AlphaMask const* _faceMask;
+
+    /// Mask of the opaque pixels of the fist, shared between entities with the same fist
+    AlphaMask const* _fistMask;
+
+    /// Scene node of the face, positioned at the entity's center
+    SceneNode _faceNode;
+
+    /// Scene node of the fist, child of the face node
+    SceneNode _fistNode;
+
     /* Distance between the entity and its fist.
        Technically between the centers of the face and the fist. */
     float _fistDist;
@@ -203,8 +535,44 @@ class Entity :
     /// Health points of the entity
     int _health;
 
-    /// Sound to be played when the entity is punching
-    sf::Sound _punchSound;
+    /// Pointer to the event bus where the entity publishes events
+    GameEventBus* _eventBus;
+
+    /// Pointer to the random generator that decides critical punches
+    CounterRandom const* _random;
+
+    /// Pointer to the gameplay parameters, the default ones until the match sets its own
+    GameplayParameters const* _parameters;
+
+    /// Pointer to the command queue where the entity records commands for other entities
+    CommandQueue* _commandQueue;
+
+    /// ID of the entity, unique among existing entities
+    uint32_t _id;
+
+    /// Number of commands the entity has recorded, used to order its commands
+    uint32_t _commandSequence;
+
+    /// Unit vector of the direction the entity was last pushed in, when punched
+    sf::Vector2f _knockbackDirection;
+
+    /// Number of frames of cosmetic animations skipped with reduced detail, not caught up with yet
+    size_t _skippedFrames;
+
+    /// Indicates whether the entity's punch cooldown is running
+    bool _punchCooldownRunning;
+
+    /// Timer that ends the punch cooldown, valid while the cooldown is running
+    TimerWheel::TimerId _punchCooldownTimer;
 };
 
+template <class EventType>
+void Entity::PublishEvent(EventType const& event)
+{
+    if (_eventBus != nullptr)
+    {
+        _eventBus->Publish(event);
+    }
+}
+
 } // namespace FaceFight
\ No newline at end of file
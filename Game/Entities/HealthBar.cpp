@@ -14,16 +14,16 @@ sf::Color const LOST_HEALTH_COLOR = sf::Color(0xa50000ff);
 HealthBar::HealthBar(
     sf::Vector2f const& position,
     sf::Vector2f const& size,
-    int const* health,
     int capacity)
-    : _health(health),
+    : _health(capacity),
     _capacity(capacity),
     _outline(size),
     _healthRect(size),
     _lostHealthRect(size)
 {
     /* Fixing the y-component of all 3 rectangles, it will be constant.
-       The x-component is what will change and it will change in the Update() function */
+       The x-component is what will change and it will change in the Update() function,
+       every time the health changes */
     _outline.setPosition(position);
     _healthRect.setPosition(position);
     _lostHealthRect.setPosition(position);
@@ -46,9 +46,19 @@ void HealthBar::Draw(
     target.draw(_outline);
 }
 
+void HealthBar::SetHealth(int health)
+{
+    if (health == _health)
+    {
+        return;
+    }
+    _health = health;
+    Update();
+}
+
 void HealthBar::Update()
 {
-    float healthPercent = (float)*_health / _capacity;
+    float healthPercent = (float)_health / _capacity;
     if (healthPercent < 0)
     {
         healthPercent = 0;
@@ -82,5 +92,5 @@ int HealthBar::GetCapacity() const
 
 int HealthBar::GetHealth() const
 {
-    return *_health;
+    return _health;
 }
\ No newline at end of file
@@ -4,8 +4,9 @@
 
 /**
  * A class representing a rectangular health bar,
- * which keeps track of some health variable,
- * and visualises it as how much health is remaining at any time.
+ * which visualises how much health is remaining.
+ * The health bar does not poll any health variable,
+ * it is told about changes of health through SetHealth().
  */
 class HealthBar
 {
@@ -14,22 +15,19 @@ class HealthBar
 
     /**
      * Creates a health bar with the given size on the given position,
-     * that keeps track of the given health variable.
+     * initially full of health.
      * Optionally capacity can be specified.
      * 
      * @param[in] position
      *  position of the upper left corner of the health bar
      * @param[in] size
      *  size of the health bar - width and height
-     * @param[in] health
-     *  pointer to the health variable that will be visualised
      * @param[in] capacity (optional, default = 100)
      *  health points capacity of the health bar
      */
     HealthBar(
         sf::Vector2f const& position,
         sf::Vector2f const& size,
-        int const* health,
         int capacity = CAPACITY_DEFAULT
     );
 
@@ -42,10 +40,13 @@ class HealthBar
     void Draw(sf::RenderTarget& target) const;
 
     /**
-     * Updates the health bar for next frame,
-     * according to the current value of the health variable.
+     * Sets the health visualised in the health bar.
+     * The bar is updated only if the health has actually changed.
+     * 
+     * @param[in] health
+     *  current health points to be visualised
      */
-    void Update();
+    void SetHealth(int health);
 
     /**
      * Returns health bar's capacity in health points
@@ -61,11 +62,18 @@ class HealthBar
      */
     int GetHealth() const;
 
+  private: /* functions */
+
+    /**
+     * Updates the health bar's rectangles,
+     * according to the current health points.
+     */
+    void Update();
+
   private: /* variables */
 
-    /* Pointer to the variable holding the current health points,
-       that the health bar is supposed to visualise */
-    int const* _health;
+    /// Current health points, that the health bar visualises
+    int _health;
 
     /// Capacity of the health bar - maximum health points it can hold
     int _capacity;
@@ -0,0 +1,140 @@
+#pragma once
+
+#include "../Arena/Arena.h"
+
+#include <SFML/Graphics.hpp>
+
+/**
+ * A base class for objects in the game that can be moved in space.
+ * Such objects consist of a center point and the ability to move it around.
+ * The center is not neccessarily the geometric center of the object,
+ * but it acts as a handle to the object's movement.
+ * It is the job of the inherited class to implement
+ * how the object should move relative to the center.
+ * 
+ * An object can be placed in an arena, in which case its movements
+ * are clamped so that it doesn't go into the arena's obstacles.
+ * 
+ * The inherited class passes itself as the template parameter (CRTP),
+ * so the call to its FollowCenter() function is resolved at compile time,
+ * and can be inlined, instead of going through a virtual function.
+ * 
+ * @param[in] Derived
+ *  The inherited class. It has to implement a function
+ *  void FollowCenter(), which makes the whole object "follow" its center,
+ *  meaning that the whole object moves to where the center is.
+ *  That function is called every time the center moves.
+ */
+template <class Derived>
+class Movable
+{
+
+  public:
+
+    /**
+     * Creates a movable object with the given initial position
+     * 
+     * @param[in] position (optional)
+     *  Initial position of the object's center point
+     */
+    Movable(
+      sf::Vector2f const& position = {0.f, 0.f}
+    );
+
+    /**
+     * Sets the position of the center point of the movable object.
+     * Also moves the whole object following the center.
+     * 
+     * @param[in] position
+     *  Position of the center point to set
+     */
+    void SetPosition(
+      sf::Vector2f const& position
+    );
+
+    /**
+     * Returns the position of the center point of the movable object
+     * 
+     * @return position of the center point
+     */
+    sf::Vector2f GetPosition() const;
+
+    /**
+     * Moves the object by the given delta vector.
+     * If the object is in an arena, it stops at obstacles and slides along them.
+     * 
+     * @param[in] delta
+     *  Delta vector by which to move the object
+     */
+    void Move(
+      sf::Vector2f const& delta
+    );
+
+    /**
+     * Places the object in an arena, which clamps the object's movements
+     * 
+     * @param[in] arena
+     *  Pointer to the arena, or nullptr if movements should not be clamped
+     * @param[in] radius
+     *  Radius of the circle around the center that can't go into obstacles
+     */
+    void SetArena(
+      Arena const* const arena,
+      float radius
+    );
+
+  private:
+
+    /// Center point of the object
+    sf::Vector2f _center;
+
+    /// Pointer to the arena that clamps movements
+    Arena const* _arena;
+
+    /// Radius of the object, as seen by the arena
+    float _arenaRadius;
+};
+
+template <class Derived>
+Movable<Derived>::Movable(
+    sf::Vector2f const& position)
+    : _center(position),
+    _arena(nullptr),
+    _arenaRadius(0.f)
+{}
+
+template <class Derived>
+void Movable<Derived>::SetPosition(
+    sf::Vector2f const& position)
+{
+    _center = position;
+    // Make the whole object "follow" the center to its new position
+    static_cast<Derived*>(this)->FollowCenter();
+}
+
+template <class Derived>
+sf::Vector2f Movable<Derived>::GetPosition() const
+{
+    return _center;
+}
+
+template <class Derived>
+void Movable<Derived>::Move(
+    sf::Vector2f const& delta)
+{
+    if (_arena == nullptr)
+    {
+        SetPosition(GetPosition() + delta);
+        return;
+    }
+    SetPosition(_arena->ClampMove(GetPosition(), delta, _arenaRadius));
+}
+
+template <class Derived>
+void Movable<Derived>::SetArena(
+    Arena const* const arena,
+    float radius)
+{
+    _arena = arena;
+    _arenaRadius = radius;
+}
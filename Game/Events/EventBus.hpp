@@ -0,0 +1,202 @@
+#pragma once
+
+#include <array>
+#include <tuple>
+#include <vector>
+
+/**
+ * A template class for a statically typed event bus.
+ * Events of each type are published into their own queue,
+ * which is preallocated once, so publishing never allocates memory.
+ * At the end of each tick the queues are dispatched in batches,
+ * meaning that each subscriber of an event type receives
+ * all events of that type, one after the other, and then the queue is emptied.
+ * That way subscribers only react to what happened during the tick,
+ * instead of polling some state every frame.
+ * 
+ * @param[in] EventTypes
+ *  The types of events that can be published on the bus.
+ *  Event types are dispatched in the order in which they are listed here.
+ */
+template <class... EventTypes>
+class EventBus
+{
+
+  public:
+
+    /**
+     * Creates an event bus with preallocated queues
+     * 
+     * @param[in] queueCapacity (optional)
+     *  Maximum number of events of each type that can be published in a single tick
+     */
+    EventBus(
+        size_t queueCapacity = QUEUE_CAPACITY_DEFAULT
+    );
+
+    /**
+     * Publishes an event, which will be delivered to subscribers on the next dispatch
+     * 
+     * @param[in] event
+     *  The event to be published
+     */
+    template <class EventType>
+    void Publish(EventType const& event);
+
+    /**
+     * Subscribes a member function of an object to events of the given type.
+     * The handler is bound at compile time, so no type-erased function objects are created.
+     * 
+     * @param[in] subscriber
+     *  Pointer to the object whose handler will receive the events
+     */
+    template <
+        class EventType,
+        class SubscriberType,
+        void (SubscriberType::*Handler)(EventType const&)>
+    void Subscribe(SubscriberType* subscriber);
+
+    /**
+     * Dispatches all events published since the last dispatch
+     * to their subscribers, and empties the queues.
+     * 
+     * This function is supposed to be called once each tick.
+     * Events published by a handler during dispatch are delivered
+     * on the same dispatch if their type is listed later in the bus,
+     * otherwise on the next one.
+     */
+    void Dispatch();
+
+  private:
+
+    /// Maximum number of subscribers for a single event type
+    static constexpr size_t MAX_SUBSCRIBERS = 8;
+
+    /// The default capacity of each queue, in events per tick
+    static constexpr size_t QUEUE_CAPACITY_DEFAULT = 256;
+
+    /// A subscriber, as a pointer to the object and a handler that knows its type
+    template <class EventType>
+    struct Subscriber
+    {
+        void* object;
+        void (*handler)(void*, EventType const&);
+    };
+
+    /// The queue and the subscribers of a single event type
+    template <class EventType>
+    struct Channel
+    {
+        std::vector<EventType> queue;
+        std::array<Subscriber<EventType>, MAX_SUBSCRIBERS> subscribers;
+        size_t subscribersCount = 0;
+    };
+
+    /**
+     * Calls the handler of the subscriber with the given event.
+     * Instances of this function are what the type-erased subscribers point to.
+     */
+    template <
+        class EventType,
+        class SubscriberType,
+        void (SubscriberType::*Handler)(EventType const&)>
+    static void CallHandler(void* subscriber, EventType const& event);
+
+    /// Dispatches the queue of a single channel
+    template <class EventType>
+    void DispatchChannel(Channel<EventType>& channel);
+
+  private: /* variables */
+
+    /// One channel for each event type
+    std::tuple<Channel<EventTypes>...> _channels;
+
+    /// Maximum number of events of each type in a single tick
+    size_t _queueCapacity;
+};
+
+template <class... EventTypes>
+EventBus<EventTypes...>::EventBus(
+    size_t queueCapacity)
+    : _queueCapacity(queueCapacity)
+{
+    // Preallocate all queues, so that publishing never allocates
+    std::apply([queueCapacity](auto&... channels) {
+        (channels.queue.reserve(queueCapacity), ...);
+    }, _channels);
+}
+
+template <class... EventTypes>
+template <class EventType>
+void EventBus<EventTypes...>::Publish(EventType const& event)
+{
+    Channel<EventType>& channel = std::get<Channel<EventType>>(_channels);
+    if (channel.queue.size() >= _queueCapacity)
+    {
+        throw "Error: Event queue capacity exceeded in a single tick.";
+    }
+    channel.queue.push_back(event);
+}
+
+template <class... EventTypes>
+template <
+    class EventType,
+    class SubscriberType,
+    void (SubscriberType::*Handler)(EventType const&)>
+void EventBus<EventTypes...>::Subscribe(SubscriberType* subscriber)
+{
+    Channel<EventType>& channel = std::get<Channel<EventType>>(_channels);
+    if (channel.subscribersCount >= MAX_SUBSCRIBERS)
+    {
+        throw "Error: Too many subscribers for a single event type.";
+    }
+    channel.subscribers[channel.subscribersCount++] = {
+        subscriber,
+        &CallHandler<EventType, SubscriberType, Handler>
+    };
+}
+
+template <class... EventTypes>
+void EventBus<EventTypes...>::Dispatch()
+{
+    // Dispatch channels in the order in which event types are listed
+    std::apply([this](auto&... channels) {
+        (DispatchChannel(channels), ...);
+    }, _channels);
+}
+
+template <class... EventTypes>
+template <
+    class EventType,
+    class SubscriberType,
+    void (SubscriberType::*Handler)(EventType const&)>
+void EventBus<EventTypes...>::CallHandler(
+    void* subscriber, EventType const& event)
+{
+    (static_cast<SubscriberType*>(subscriber)->*Handler)(event);
+}
+
+template <class... EventTypes>
+template <class EventType>
+void EventBus<EventTypes...>::DispatchChannel(Channel<EventType>& channel)
+{
+    /* Only events that were in the queue when dispatch started are delivered now.
+       Events of the same type published by handlers stay for the next dispatch. */
+    size_t const eventsCount = channel.queue.size();
+    if (eventsCount == 0)
+    {
+        return;
+    }
+
+    // Each subscriber receives the whole batch before the next subscriber
+    for (size_t s = 0; s < channel.subscribersCount; s++)
+    {
+        Subscriber<EventType> const& subscriber = channel.subscribers[s];
+        for (size_t e = 0; e < eventsCount; e++)
+        {
+            subscriber.handler(subscriber.object, channel.queue[e]);
+        }
+    }
+
+    channel.queue.erase(channel.queue.begin(), channel.queue.begin() + eventsCount);
+}
@@ -0,0 +1,53 @@
+/* A file containing all gameplay event types, and the event bus that carries them */
+
+#pragma once
+
+#include "EventBus.hpp"
+
+namespace FaceFight
+{
+
+class Entity;
+
+    namespace Events
+    {
+
+        /// An entity threw a punch, no matter if it landed or not
+        struct Punch
+        {
+            Entity* puncher;
+        };
+
+        /// A punch or a thrown fist landed on an entity
+        struct Hit
+        {
+            /// The puncher, or nullptr for a thrown fist, whose thrower may be gone
+            Entity* attacker;
+            Entity* victim;
+            int damage;
+        };
+
+        /// An entity's health points changed
+        struct HealthChanged
+        {
+            Entity* entity;
+            int health;
+        };
+
+        /// An entity's health points dropped to zero
+        struct Died
+        {
+            Entity* entity;
+        };
+
+    } // namespace Events
+
+/// The event bus carrying all gameplay events
+using GameEventBus = EventBus<
+    Events::Punch,
+    Events::Hit,
+    Events::HealthChanged,
+    Events::Died
+>;
+
+} // namespace FaceFight
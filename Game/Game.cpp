@@ -5,20 +5,43 @@
 namespace
 {
 
-int const FRAMERATE_LIMIT = 60;
+int const FRAMERATE_LIMIT = FaceFight::Match::TICK_RATE;
+
+// The simulation runs at its own pace, whatever the renderer's frame rate
+sf::Time const TICK_TIME = sf::seconds(1.f / FaceFight::Match::TICK_RATE);
 
 sf::Keyboard::Key const KEY_QUIT_GAME = sf::Keyboard::Escape;
 
+sf::Keyboard::Key const KEY_TOGGLE_STATS = sf::Keyboard::F3;
+
+sf::Keyboard::Key const KEY_SAVE_CHECKPOINT = sf::Keyboard::F5;
+
+sf::Keyboard::Key const KEY_LOAD_CHECKPOINT = sf::Keyboard::F9;
+
 std::string const RESOURCES_DIR = "Game/Resources/";
 
-float const ENEMY_SPEED = 5.f;
+int const PUNCH_SOUND_VOLUME = 35;
+
+// Memory of the checkpoint snapshot, enough for a match with every pool full
+size_t const CHECKPOINT_CAPACITY = 32 * 1024 * 1024;
 
-float const PUNCH_DIST = 350.f;
+// Memory of each snapshot kept for rollback, enough for a versus match with every projectile in flight
+size_t const VERSUS_SNAPSHOT_CAPACITY = 64 * 1024;
 
-// Frequency of enemy punches, in frames
-int const ENEMY_PUNCH_FREQ = FRAMERATE_LIMIT / 2;
+// Time that the planner may spend thinking on each frame
+std::chrono::microseconds const PLANNER_BUDGET(4000);
 
-int const WINNER_TEXT_OFFSET = 20.f;
+// Time that enemies may spend thinking on each tick, in modes played only on this machine
+std::chrono::microseconds const ENEMY_THINK_BUDGET(2000);
+
+// In a duel, the opponent walks in to this many punch distances from the player before the fight starts
+float const INTRO_DIST_FACTOR = 3.f;
+
+// Every this many waves of survival mode, the first enemy of the wave is a boss with a scripted combo
+int const BOSS_WAVE_PERIOD = 5;
+
+// Number of rounds of a boss's combo
+int const BOSS_COMBO_ROUNDS = 3;
 
 } // namespace
 
@@ -27,25 +50,21 @@ namespace FaceFight
 
 using namespace Resources;
 
-Game::Game()
+Game::Game(
+    GameMode mode,
+    uint64_t seed,
+    VersusSettings const& versus,
+    std::string const& policyFile,
+    std::string const& behaviorFile)
     : _window( // Initialize window to be fullscreen
         sf::VideoMode(
             sf::VideoMode::getDesktopMode().width,
             sf::VideoMode::getDesktopMode().height),
         "",
         sf::Style::Fullscreen),
-    _playerHealthBar(
-        sf::Vector2f(100.f, 50.f),
-        sf::Vector2f(500.f, 40.f),
-        &_player.GetHealth()
-    ),
-    _enemyHealthBar(
-        sf::Vector2f(1320.f, 50.f),
-        sf::Vector2f(500.f, 40.f),
-        &_enemy.GetHealth()  
-    ),
-    _mouseLeftIsPressed(false),
-    _lastEnemyPunchTimer(ENEMY_PUNCH_FREQ)
+    _nextPunchSound(0),
+    _replaying(false),
+    _checkpoint(CHECKPOINT_CAPACITY)
 {
     // Set frame rate limit to not torture the GPU too much
     _window.setFramerateLimit(FRAMERATE_LIMIT);
@@ -56,161 +75,350 @@ Game::Game()
     // Load and open resources
     LoadOpenResources();
 
-    _player.SetFaceTexture(
-        _textureHandler.Get(Texture::Id::Naruto)
-    );
-    _player.SetFistTexture(
-        _textureHandler.Get(Texture::Id::Fist)
-    );
-    _player.SetFistScale({0.3f, 0.3f});
-    _player.SetEnemy(&_enemy);
+    // The match is drawn with the same textures its masks are built from
+    _matchAssets.reset(new MatchAssets(
+        _textureHandler.Get(Texture::Id::Naruto).copyToImage(),
+        _textureHandler.Get(Texture::Id::Sasuke).copyToImage(),
+        _textureHandler.Get(Texture::Id::Fist).copyToImage(),
+        RESOURCES_DIR + "Arenas/arena.txt"));
+    _matchAssets->playerFaceTexture = &_textureHandler.Get(Texture::Id::Naruto);
+    _matchAssets->enemyFaceTexture = &_textureHandler.Get(Texture::Id::Sasuke);
+    _matchAssets->fistTexture = &_textureHandler.Get(Texture::Id::Fist);
+    if (!policyFile.empty())
+    {
+        _enemyPolicy.reset(new QuantizedMlp(policyFile));
+        _matchAssets->enemyPolicy = _enemyPolicy.get();
+    }
+    if (!behaviorFile.empty())
+    {
+        _enemyBehavior.reset(new BehaviorTree(
+            behaviorFile, Match::GetBehaviorConditionNames(), Match::GetBehaviorActionNames()));
+        _matchAssets->enemyBehavior = _enemyBehavior.get();
+    }
 
-    _enemy.SetFaceTexture(
-        _textureHandler.Get(Texture::Id::Sasuke)
-    );
-    _enemy.SetFistTexture(
-        _textureHandler.Get(Texture::Id::Fist)
-    );
-    _enemy.SetFistScale({0.3f, 0.3f});
-    _enemy.SetPosition({
-        (float)_window.getSize().x / 2, (float)_window.getSize().y / 2
-    });
-    _enemy.SetEnemy(&_player);
+    MatchSettings settings;
+    settings.mode = mode;
+    settings.seed = seed;
+    settings.size = sf::Vector2f(_window.getSize());
+    if (mode == GameMode::Duel || mode == GameMode::Survival || mode == GameMode::PlannedDuel)
+    {
+        // A match no one else plays may think as much as the frame allows, however many enemies that is
+        settings.maxThinksPerTick = SIZE_MAX;
+        settings.thinkBudget = ENEMY_THINK_BUDGET;
+    }
+    if (mode == GameMode::PlannedDuel || mode == GameMode::Versus
+        || mode == GameMode::Server || mode == GameMode::Client)
+    {
+        /* Planner clones the match many times per frame, and peers restore it on every rollback,
+           so it holds only what a duel needs, with as many fists as a server's snapshot carries */
+        settings.maxEnemies = 1;
+        settings.maxProjectiles = NetSnapshot::MAX_PROJECTILES;
+    }
+    _match.reset(new Match(settings, *_matchAssets));
+    if (mode == GameMode::PlannedDuel)
+    {
+        _planner.reset(new MctsPlanner(settings, *_matchAssets, PLANNER_BUDGET));
+    }
+    if (mode == GameMode::Duel)
+    {
+        // The opponent walks up to the player before it fights
+        Entity const& opponent = _match->GetOpponent();
+        sf::Vector2f const fromPlayer = Geometry::NormaliseVector(
+            Geometry::GetVector(_match->GetPlayer().GetPosition(), opponent.GetPosition()));
+        sf::Vector2f const spot = _match->GetPlayer().GetPosition()
+            + fromPlayer * INTRO_DIST_FACTOR * settings.parameters.punchDist;
+        ScriptScheduler& scripts = _match->GetScripts();
+        scripts.Start(WalkIn(scripts, *_match, _match->GetEnemies().GetHandle(&opponent), spot));
+    }
+
+    _renderer.reset(new Renderer(_window, _match->GetArena(),
+        _textureHandler.Get(Texture::Id::Fist), _fontHandler.Get(Font::Id::Amatic)));
+    _hud.showWave = mode == GameMode::Survival;
+
+    // All voices share the punch sound buffer from the sound handler
+    for (sf::Sound& punchSound : _punchSounds)
+    {
+        punchSound.setBuffer(_soundHandler.Get(Sound::Id::Punch));
+        punchSound.setVolume(PUNCH_SOUND_VOLUME);
+    }
 
-    _winnerText.setFont(_fontHandler.Get(Font::Id::Amatic));
-    _winnerText.setCharacterSize(100);
-    _winnerTextBackground.setFillColor(sf::Color(100, 100, 100, 200));
+    // The game shows and plays what happens in the match
+    GameEventBus& eventBus = _match->GetEventBus();
+    eventBus.Subscribe<Events::Punch, Game, &Game::OnPunch>(this);
+    eventBus.Subscribe<Events::HealthChanged, Game, &Game::OnHealthChanged>(this);
+    eventBus.Subscribe<Events::Died, Game, &Game::OnDied>(this);
+    RefreshHud();
 
-    _player.SetPunchSoundBuffer(_soundHandler.Get(Sound::Id::Punch));
-    _enemy.SetPunchSoundBuffer(_soundHandler.Get(Sound::Id::Punch));
+    if (_match->IsAgainstPlayer())
+    {
+        _channel.reset(new UdpChannel(
+            versus.localPort, sf::IpAddress(versus.remoteAddress), versus.remotePort));
+        _channel->SetConditions(versus.latency, versus.jitter, versus.lossRate, seed);
+
+        // Peers only play together if the seed and the screen size, and so the whole match, are the same
+        uint64_t const matchToken = _match->GetSetupToken();
+
+        // Until the players give any input, the fighters stay where they are
+        RollbackSession::Inputs initialInputs{};
+        initialInputs[0].target = _match->GetPlayer().GetPosition();
+        initialInputs[1].target = _match->GetOpponent().GetPosition();
+
+        switch (mode)
+        {
+            case GameMode::Server:
+                _serverSession.reset(new ServerSession(*_channel, matchToken, initialInputs[1]));
+                break;
+            case GameMode::Client:
+                _clientSession.reset(new ClientSession(*_channel, matchToken));
+                break;
+            default:
+                _rollback.reset(new RollbackSession(*_channel, versus.side,
+                    matchToken, initialInputs, VERSUS_SNAPSHOT_CAPACITY));
+                break;
+        }
+    }
 
     _musicHandler.Get(Music::Id::NarutoTheme).play();
 }
 
 void Game::Run()
 {
+    // The first frame shows the match as it starts
+    Capture(_renderer->GetNextSnapshot());
+    _renderer->Publish();
+    _renderer->Start();
+
     /* The game loop.
-       Updating and rendering until the player closes the game */
+       Updating until the player closes the game, while the renderer draws on its own thread */
+    sf::Clock tickClock;
+    sf::Time nextTick = sf::Time::Zero;
     while (_window.isOpen())
     {
         sf::Event event;
         while (_window.pollEvent(event))
         {
-            // If the player has pressed the quit key, we close the window
+            // If the player has pressed the quit key, we close the window, once nothing draws to it
             if (event.type == sf::Event::KeyPressed
                 && event.key.code == KEY_QUIT_GAME)
             {
+                _renderer->Stop();
                 _window.close();
             }
+            // Stats are shown or hidden with their toggle key
+            if (event.type == sf::Event::KeyPressed
+                && event.key.code == KEY_TOGGLE_STATS)
+            {
+                _hud.showStats = !_hud.showStats;
+            }
+            // The match is saved and restored with the checkpoint keys, unless it is shared with a peer
+            if (event.type == sf::Event::KeyPressed
+                && event.key.code == KEY_SAVE_CHECKPOINT
+                && _channel == nullptr)
+            {
+                _checkpoint.Clear();
+                SaveSnapshot(_checkpoint);
+            }
+            if (event.type == sf::Event::KeyPressed
+                && event.key.code == KEY_LOAD_CHECKPOINT
+                && _channel == nullptr
+                && _checkpoint.GetSize() > 0)
+            {
+                _checkpoint.Rewind();
+                LoadSnapshot(_checkpoint);
+            }
         }
 
-        // first clear previous frame
-        _window.clear();
+        UpdateStats();
         // then update game for the next frame
-        Update();
-        // then draw the next frame
-        Draw();
-        // and render it on the window
-        _window.display();
+        FighterInput const input = ReadLocalInput();
+        if (_rollback != nullptr)
+        {
+            // Versus matches only advance together with the peer, and may go back a few frames
+            _rollback->Advance(input,
+                [this](ByteBuffer& buffer) { SaveSnapshot(buffer); },
+                [this](ByteBuffer& buffer) { LoadSnapshot(buffer); },
+                [this](RollbackSession::Inputs const& inputs, bool replaying) {
+                    _replaying = replaying;
+                    _match->Update(inputs[0], inputs[1]);
+                    _replaying = false;
+                });
+        }
+        else if (_serverSession != nullptr)
+        {
+            // The match starts once the client connects, and the client's fighter follows its input
+            _serverSession->Receive();
+            if (_serverSession->IsConnected())
+            {
+                sf::Clock serverClock;
+                _match->Update(input, _serverSession->TakeInput());
+                _serverTickTime = serverClock.getElapsedTime();
+                SendNetSnapshot();
+            }
+        }
+        else if (_clientSession != nullptr)
+        {
+            // The client only sends its input and shows what the server simulated
+            _clientSession->SendInput(input);
+            _clientSession->Receive();
+            ShowServerState();
+        }
+        else if (_planner != nullptr)
+        {
+            _match->Update(input, _planner->Plan(*_match));
+        }
+        else
+        {
+            _match->Update(input, FighterInput{});
+        }
+        // A new wave is announced once it comes
+        if (_match->GetWave() != _hud.wave)
+        {
+            _hud.wave = _match->GetWave();
+
+            // and some waves are led by a boss
+            if (_hud.wave % BOSS_WAVE_PERIOD == 0 && _match->GetEnemies().GetActiveCount() > 0)
+            {
+                ScriptScheduler& scripts = _match->GetScripts();
+                scripts.Start(BossCombo(scripts, *_match,
+                    _match->GetEnemies().GetHandle(&_match->GetEnemies().GetActive(0)), BOSS_COMBO_ROUNDS));
+            }
+        }
+        // then hand what is to be drawn over to the renderer
+        Capture(_renderer->GetNextSnapshot());
+        _renderer->Publish();
+
+        // and wait for the next tick, unless the simulation has fallen behind, in which case it doesn't catch up
+        nextTick += TICK_TIME;
+        sf::Time const now = tickClock.getElapsedTime();
+        if (now < nextTick)
+        {
+            sf::sleep(nextTick - now);
+        }
+        else if (now - nextTick > TICK_TIME)
+        {
+            nextTick = now;
+        }
     }
+    _renderer->Stop();
 }
 
-Game::~Game()
-{ /* nothing */ }
-
-void Game::Update()
+void Game::SaveSnapshot(ByteBuffer& buffer) const
 {
-    _lastEnemyPunchTimer++;
-
-    /// Indicates whether player and enemy are close enough to punch each other
-    bool closeEnough = (Geometry::CalcDist(_player.GetPosition(), _enemy.GetPosition()) <= PUNCH_DIST);
+    _match->SaveSnapshot(buffer);
+}
 
-    _player.SetPosition({
-        (float)sf::Mouse::getPosition().x,
-        (float)sf::Mouse::getPosition().y
-    });
+void Game::LoadSnapshot(ByteBuffer& buffer)
+{
+    _match->LoadSnapshot(buffer);
+    RefreshHud();
+    // What the planner thought ahead no longer follows from the match
+    if (_planner != nullptr)
+    {
+        _planner->Reset();
+    }
+}
 
-    bool playerWasAlive = _player.IsAlive();
-    bool enemyWasAlive = _enemy.IsAlive();
+Game::~Game()
+{ /* nothing */ }
 
-    if (_player.IsAlive())
+void Game::SendNetSnapshot()
+{
+    Match const& match = *_match;
+    _netSnapshot.Clear((uint32_t)match.GetTick());
+    for (Entity const* fighter : {&match.GetPlayer(), &match.GetOpponent()})
     {
-        // button state in previous frame
-        bool mouseLeftWasPressed = _mouseLeftIsPressed;
-        // button state in current frame
-        _mouseLeftIsPressed = sf::Mouse::isButtonPressed(sf::Mouse::Left);
-
-        // punch enemy only if button was not pressed previously but now is
-        if (_mouseLeftIsPressed && !mouseLeftWasPressed)
+        _netSnapshot.AddFighter(fighter->GetId(), fighter->GetPosition(), fighter->GetFistOffset(),
+            fighter->GetHealth(), fighter->IsGettingPunched());
+    }
+    // Fists beyond what fits in a snapshot aren't shown to the client
+    for (size_t p = 0; p < match.GetProjectiles().GetCount(); p++)
+    {
+        if (!_netSnapshot.AddProjectile(match.GetProjectiles().GetPosition(p)))
         {
-            _player.PunchEnemy(closeEnough && _enemy.IsAlive());
+            break;
         }
     }
+    _serverSession->SendSnapshot(_netSnapshot);
+}
 
-    if (_enemy.IsAlive() && _player.IsAlive())
+void Game::ShowServerState()
+{
+    NetSnapshot const* from;
+    NetSnapshot const* to;
+    float alpha;
+    if (!_clientSession->Interpolate(from, to, alpha))
     {
-        // If enemy is not close enough to punch, it moves towards the player
-        if (!closeEnough)
+        return;
+    }
+
+    Entity& player = _match->GetPlayer();
+    Entity& opponent = _match->GetOpponent();
+    int const playerHealth = player.GetHealth();
+    int const opponentHealth = opponent.GetHealth();
+    for (size_t f = 0; f < to->GetFightersCount(); f++)
+    {
+        Entity& fighter = to->GetFighterId(f) == player.GetId() ? player : opponent;
+
+        // A fighter missing from the earlier snapshot is shown where it is in the later one
+        NetSnapshot const* start = from;
+        if (f >= from->GetFightersCount() || from->GetFighterId(f) != to->GetFighterId(f))
         {
-            _enemy.Move(Geometry::NormaliseVector(Geometry::GetVector(
-                _enemy.GetPosition(),
-                _player.GetPosition()
-            )) * ENEMY_SPEED);
+            start = to;
         }
-        // Otherwise enemy punches, if enough time has passed since last punch
-        else if (_lastEnemyPunchTimer >= ENEMY_PUNCH_FREQ)
-        {
-            // Enemy punches player
-            _enemy.PunchEnemy();
+        sf::Vector2f const position = start->GetFighterPosition(f)
+            + (to->GetFighterPosition(f) - start->GetFighterPosition(f)) * alpha;
+        sf::Vector2f const fistOffset = start->GetFistOffset(f)
+            + (to->GetFistOffset(f) - start->GetFistOffset(f)) * alpha;
+        fighter.ShowSeenState(position, fistOffset, to->GetHealth(f), to->IsGettingPunched(f));
+    }
 
-            _lastEnemyPunchTimer = 0;
-        }
+    // Thrown fists aren't matched between snapshots, so they are shown as the later one has them
+    std::array<sf::Vector2f, NetSnapshot::MAX_PROJECTILES> positions;
+    for (size_t p = 0; p < to->GetProjectilesCount(); p++)
+    {
+        positions[p] = to->GetProjectilePosition(p);
     }
+    _match->GetProjectiles().ShowSeen(positions.data(), to->GetProjectilesCount());
 
-    // If player or enemy died, construct the winner text
-    if ((playerWasAlive && !_player.IsAlive())
-        || (enemyWasAlive && !_enemy.IsAlive()))
+    if (player.GetHealth() != playerHealth || opponent.GetHealth() != opponentHealth)
     {
-        sf::String winnerString;
-        if (playerWasAlive && !_player.IsAlive())
-        {
-            winnerString = "Game over. You lost.";
-        }
-        else if (enemyWasAlive && !_enemy.IsAlive())
-        {
-            winnerString = "Congratulations! You win!";
-        }
-        _winnerText.setString(winnerString);
-        _winnerText.setPosition(sf::Vector2f(
-            (float)_window.getSize().x / 2 - _winnerText.getGlobalBounds().width / 2,
-            (float)_window.getSize().y / 2 - _winnerText.getGlobalBounds().height / 2
-        ));
-        _winnerTextBackground.setSize({
-            _winnerText.getGlobalBounds().width + WINNER_TEXT_OFFSET * 2,
-            _winnerText.getGlobalBounds().height + WINNER_TEXT_OFFSET * 2});
-        _winnerTextBackground.setPosition({
-            _winnerText.getGlobalBounds().left - WINNER_TEXT_OFFSET,
-            _winnerText.getGlobalBounds().top - WINNER_TEXT_OFFSET});
-    }
-
-    _player.Update();
-    _enemy.Update();
-    _playerHealthBar.Update();
-    _enemyHealthBar.Update();
+        RefreshHud();
+    }
+}
+
+FighterInput Game::ReadLocalInput() const
+{
+    FighterInput input;
+    input.target = sf::Vector2f(
+        (float)sf::Mouse::getPosition().x,
+        (float)sf::Mouse::getPosition().y
+    );
+    input.punch = sf::Mouse::isButtonPressed(sf::Mouse::Left);
+    input.throwFist = sf::Mouse::isButtonPressed(sf::Mouse::Right);
+    return input;
 }
 
-void Game::Draw()
+void Game::Capture(RenderSnapshot& snapshot) const
 {
-    _enemy.DrawFace(_window);
-    _player.DrawFace(_window);
-    _enemy.DrawFist(_window);
-    _player.DrawFist(_window);
+    Match const& match = *_match;
 
-    _playerHealthBar.Draw(_window);
-    _enemyHealthBar.Draw(_window);
+    // Faces go under all fists, so that the faces of a crowd share a texture, and are drawn at once
+    snapshot.sprites.clear();
+    ObjectPool<Entity> const& enemies = match.GetEnemies();
+    for (size_t e = 0; e < enemies.GetActiveCount(); e++)
+    {
+        enemies.GetActive(e).CaptureFace(snapshot.sprites);
+    }
+    match.GetPlayer().CaptureFace(snapshot.sprites);
+    for (size_t e = 0; e < enemies.GetActiveCount(); e++)
+    {
+        enemies.GetActive(e).CaptureFist(snapshot.sprites);
+    }
+    match.GetPlayer().CaptureFist(snapshot.sprites);
+
+    match.GetProjectiles().CaptureVertices(snapshot.projectileVertices);
 
-    _window.draw(_winnerTextBackground);
-    _window.draw(_winnerText);
+    snapshot.hud = _hud;
 }
 
 void Game::LoadOpenResources()
@@ -230,4 +438,123 @@ void Game::LoadOpenResources()
     _fontHandler.Load(Font::Id::Amatic, RESOURCES_DIR + "Fonts/raleway.ttf");
 }
 
+void Game::UpdateStats()
+{
+    // Counters of the scene are taken on every frame, so that they only ever count a single frame
+    SceneNode::Stats const sceneStats = _match->TakeSceneStats();
+    if (_hud.showStats)
+    {
+        Match::Stats const& matchStats = _match->GetStats();
+        _hud.statsString =
+            "Render frame: " + std::to_string(_renderer->GetFrameTime().asMicroseconds()) + " us"
+            + " in " + std::to_string(_renderer->GetDrawCallsCount()) + " draw calls"
+            + "\nTransforms recomputed: " + std::to_string(sceneStats.recomputed)
+            + "\nTransforms reused: " + std::to_string(sceneStats.reused)
+            + "\nFlow field recomputes: " + std::to_string(_match->GetFlowFieldRecomputeCount())
+            + "\nEnemies: " + std::to_string(_match->GetEnemies().GetActiveCount())
+            + "\nCrowd separation: " + std::to_string(matchStats.separationTime.asMicroseconds()) + " us"
+            + "\nEnemy thinks: " + std::to_string(matchStats.thinksCount)
+            + " in " + std::to_string(matchStats.thinkTime.asMicroseconds()) + " us"
+            + "\nThrown fists: " + std::to_string(_match->GetProjectiles().GetCount())
+            + " in " + std::to_string(matchStats.projectilesTime.asMicroseconds()) + " us"
+            + (_enemyPolicy != nullptr
+                ? "\nPolicy inferences: " + std::to_string(matchStats.policyTime > sf::Time::Zero
+                        ? (long long)(matchStats.policyInferences / matchStats.policyTime.asSeconds()) : 0)
+                    + " per second (" + QuantizedMlp::GetKernelName(_enemyPolicy->GetKernel()) + ")"
+                : std::string())
+            + (_rollback != nullptr
+                ? "\nRollback: " + std::to_string(_rollback->GetRollbackTicks()) + " ticks"
+                : std::string())
+            + (_serverSession != nullptr
+                ? "\nServer tick: " + std::to_string(_serverTickTime.asMicroseconds()) + " us"
+                    + "\nSent: " + std::to_string(_channel->GetSentBytesPerSecond()) + " B/s"
+                : std::string())
+            + (_clientSession != nullptr
+                ? "\nReceived: " + std::to_string(_channel->GetReceivedBytesPerSecond()) + " B/s"
+                : std::string())
+            + (_planner != nullptr
+                ? "\nPlanner rollouts: " + std::to_string(_planner->GetStats().rolloutsCount)
+                    + " in " + std::to_string(_planner->GetStats().thinkTime.asMicroseconds()) + " us"
+                    + "\nPlanner nodes: " + std::to_string(_planner->GetStats().nodesCount)
+                    + ", reused visits: " + std::to_string(_planner->GetStats().reusedVisits)
+                : std::string());
+    }
+}
+
+void Game::OnPunch(Events::Punch const& /* event */)
+{
+    // Punches of frames simulated again have already been heard
+    if (_replaying)
+    {
+        return;
+    }
+    _punchSounds[_nextPunchSound].play();
+    _nextPunchSound = (_nextPunchSound + 1) % _punchSounds.size();
+}
+
+void Game::OnHealthChanged(Events::HealthChanged const& event)
+{
+    if (event.entity == &_match->GetPlayer())
+    {
+        _hud.playerHealth = event.health;
+    }
+    else if (_match->GetMode() != GameMode::Survival)
+    {
+        _hud.enemyHealth = event.health;
+    }
+}
+
+void Game::OnDied(Events::Died const& event)
+{
+    // Dead enemies of survival mode just leave the arena, the match handles that
+    if (event.entity == &_match->GetPlayer() || _match->GetMode() != GameMode::Survival)
+    {
+        ShowMatchResult();
+    }
+}
+
+void Game::ShowMatchResult()
+{
+    // Once the player has lost, the result doesn't change
+    Match const& match = *_match;
+    if (!match.GetPlayer().IsAlive())
+    {
+        switch (match.GetMode())
+        {
+            case GameMode::Duel:
+            case GameMode::PlannedDuel:
+                _hud.winnerString = "Game over. You lost.";
+                break;
+            case GameMode::Survival:
+                _hud.winnerString = "Game over. You survived " + std::to_string(match.GetWave() - 1) + " waves.";
+                break;
+            case GameMode::Versus:
+            case GameMode::Server:
+            case GameMode::Client:
+                _hud.winnerString = "Player 2 wins!";
+                break;
+        }
+    }
+    else if (match.GetMode() != GameMode::Survival && !match.GetOpponent().IsAlive())
+    {
+        _hud.winnerString = match.IsAgainstPlayer() ? "Player 1 wins!" : "Congratulations! You win!";
+    }
+    else
+    {
+        // The fight isn't over, so no winner is shown
+        _hud.winnerString.clear();
+    }
+}
+
+void Game::RefreshHud()
+{
+    _hud.playerHealth = _match->GetPlayer().GetHealth();
+    _hud.wave = _match->GetWave();
+    if (_match->GetMode() != GameMode::Survival)
+    {
+        _hud.enemyHealth = _match->GetOpponent().GetHealth();
+    }
+    ShowMatchResult();
+}
+
 } // namespace FaceFight
\ No newline at end of file
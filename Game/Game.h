@@ -3,15 +3,56 @@
 #include "Resources/ResourceHandler.hpp"
 #include "Resources/ResourceIDs.hpp"
 
-#include "Entities/Entity.h"
-#include "Entities/HealthBar.h"
+#include "Match.h"
+
+#include "AI/MctsPlanner.h"
+
+#include "Neural/QuantizedMlp.h"
+
+#include "Scripting/EnemyScripts.h"
+
+#include "Rendering/Renderer.h"
+
+#include "Serialization/ByteBuffer.h"
+
+#include "Input/FighterInput.hpp"
+
+#include "Network/UdpChannel.h"
+#include "Network/RollbackSession.h"
+#include "Network/NetSnapshot.h"
+#include "Network/ServerSession.h"
+#include "Network/ClientSession.h"
 
 #include <SFML/Graphics.hpp>
 #include <SFML/Audio.hpp>
 
+#include <array>
+#include <memory>
+#include <string>
+#include <cstdint>
+
 namespace FaceFight
 {
 
+/// How a match is connected to the other player, in versus, server and client modes
+struct VersusSettings
+{
+    /// Side played on this machine in versus mode, 0 for the first fighter and 1 for the second one
+    size_t side = 0;
+
+    /// Port on which this machine receives packets
+    unsigned short localPort = 0;
+
+    /// Address and port of the other player's machine, a server takes port 0 to accept any client
+    std::string remoteAddress = "127.0.0.1";
+    unsigned short remotePort = 0;
+
+    /// Artificial latency, jitter and packet loss of the connection, for testing
+    sf::Time latency = sf::Time::Zero;
+    sf::Time jitter = sf::Time::Zero;
+    float lossRate = 0.f;
+};
+
 /**
  * A class for easily creating and running the Game.
  */
@@ -22,14 +63,54 @@ class Game
 
     /**
      * Sets up a new game.
+     * 
+     * @param[in] mode (optional)
+     *  The mode in which the game will be played
+     * @param[in] seed (optional)
+     *  Seed of all random numbers in the match,
+     *  the same seed and the same input give the same match
+     * @param[in] versus (optional)
+     *  How the match is connected to the other player, used in versus, server and client modes.
+     *  Both players need the same seed and the same screen size.
+     * @param[in] policyFile (optional)
+     *  Weights file of a policy network controlling the enemies, in duel and survival modes,
+     *  left empty for the hand-written rules
+     * @param[in] behaviorFile (optional)
+     *  File of a behavior tree controlling the enemies, in duel and survival modes,
+     *  left empty for the hand-written rules
      */
-    Game();
+    Game(
+        GameMode mode = GameMode::Duel,
+        uint64_t seed = 0,
+        VersusSettings const& versus = VersusSettings(),
+        std::string const& policyFile = std::string(),
+        std::string const& behaviorFile = std::string());
 
     /**
      * Runs the game.
+     * The match is simulated on the calling thread, and drawn on the renderer's thread.
      */
     void Run();
 
+    /**
+     * Writes the whole simulation state of the match to a buffer,
+     * so that the match can later be restored, or cloned into another game.
+     * Can only be called between frames.
+     * 
+     * @param[in] buffer
+     *  Buffer to which the snapshot is written
+     */
+    void SaveSnapshot(ByteBuffer& buffer) const;
+
+    /**
+     * Restores the match from a snapshot written by SaveSnapshot(),
+     * of a game in the same mode. Can only be called between frames.
+     * 
+     * @param[in] buffer
+     *  Buffer from which the snapshot is read
+     */
+    void LoadSnapshot(ByteBuffer& buffer);
+
     /**
      * Cleans up after the game has ended.
      */
@@ -37,11 +118,29 @@ class Game
 
   private: /* functions */
 
-    /// Updates the game for the next frame.
-    void Update();
+    /**
+     * Reads the input of the player sitting at this machine, from the mouse
+     */
+    FighterInput ReadLocalInput() const;
 
-    /// Draws the game to the window
-    void Draw();
+    /**
+     * Sends the state of the fighters and the thrown fists to the client, in server mode
+     */
+    void SendNetSnapshot();
+
+    /**
+     * Shows the match as the server last sent it, in client mode,
+     * interpolated between the snapshots around the shown moment
+     */
+    void ShowServerState();
+
+    /**
+     * Copies what is drawn of the game, as it is now, into a render snapshot
+     * 
+     * @param[in] snapshot
+     *  Snapshot that is filled, to be published to the renderer
+     */
+    void Capture(RenderSnapshot& snapshot) const;
 
     /**
      * Loads and opens all resources needed for the game,
@@ -49,28 +148,44 @@ class Game
      */
     void LoadOpenResources();
 
-  private: /* variables */
+    /**
+     * Writes the performance counters of the last frame to the stats shown by the HUD,
+     * and resets them for the next frame
+     */
+    void UpdateStats();
 
-    /// The window where the game is rendered
-    sf::RenderWindow _window;
+    /// Plays the punching sound, on the next free voice
+    void OnPunch(Events::Punch const& event);
 
-    /// Player's entity
-    Entity _player;
+    /// Updates the health shown for the entity whose health changed
+    void OnHealthChanged(Events::HealthChanged const& event);
 
-    /// Enemy's entity
-    Entity _enemy;
+    /**
+     * Constructs the winner text when the fight is over
+     */
+    void OnDied(Events::Died const& event);
 
-    /// Health bar for player's health
-    HealthBar _playerHealthBar;
+    /**
+     * Shows who won when the fight is over, or hides the winner text while it goes on
+     */
+    void ShowMatchResult();
 
-    /// Health bar for enemy's health
-    HealthBar _enemyHealthBar;
+    /**
+     * Makes the health, the wave and the winner shown by the HUD
+     * follow the current state of the match, after it has been restored
+     */
+    void RefreshHud();
 
-    /// Text that will be displayed when the fight is over to tell who is the winner
-    sf::Text _winnerText;
+  private: /* variables */
+
+    /// Number of voices that can play the punch sound at the same time
+    static size_t const PUNCH_SOUND_VOICES = 8;
+
+    /// The window where the game is rendered
+    sf::RenderWindow _window;
 
-    /// Rectnagle for the background of the winner text
-    sf::RectangleShape _winnerTextBackground;
+    /// Values shown by the HUD, copied into every render snapshot
+    HudState _hud;
 
     /// Resource handler object for handling texture resources
     ::Resources::ResourceHandler<
@@ -88,11 +203,54 @@ class Game
     ::Resources::ResourceHandler<
         Resources::Font::Id, sf::Font> _fontHandler;
 
-    /// Indicates whether the left mouse button is currently pressed
-    bool _mouseLeftIsPressed;
+    /* Voices playing the punch sound, shared by all entities.
+       Each punch takes the next voice, so that overlapping punches can be heard */
+    std::array<sf::Sound, PUNCH_SOUND_VOICES> _punchSounds;
+
+    /// Index of the voice that will play the next punch sound
+    size_t _nextPunchSound;
+
+    /// Policy network controlling the enemies, if one was given
+    std::unique_ptr<QuantizedMlp> _enemyPolicy;
+
+    /// Behavior tree controlling the enemies, if one was given
+    std::unique_ptr<BehaviorTree> _enemyBehavior;
+
+    /// Resources of the match, shared with it
+    std::unique_ptr<MatchAssets> _matchAssets;
+
+    /// The match being played, or shown as the server sends it in client mode
+    std::unique_ptr<Match> _match;
+
+    /// Renderer drawing the match on its own thread, stopped before the match goes away
+    std::unique_ptr<Renderer> _renderer;
+
+    /// Planner controlling the opponent, in planned duel mode
+    std::unique_ptr<MctsPlanner> _planner;
+
+    /// Indicates whether a frame that was already simulated is being simulated again
+    bool _replaying;
+
+    /// Channel to the other player's machine, in versus mode
+    std::unique_ptr<UdpChannel> _channel;
+
+    /// Session keeping a versus match in sync with the other player's machine
+    std::unique_ptr<RollbackSession> _rollback;
+
+    /// Session receiving the client's input and sending it the match, in server mode
+    std::unique_ptr<ServerSession> _serverSession;
+
+    /// Session sending the player's input and receiving the match from the server, in client mode
+    std::unique_ptr<ClientSession> _clientSession;
+
+    /// Snapshot of what the client needs to show, filled on every tick of the server
+    NetSnapshot _netSnapshot;
+
+    /// Time that simulating the last tick took, in server mode
+    sf::Time _serverTickTime;
 
-    /// Keeps track of the time (in frames) since the last time that enemy punched player
-    int _lastEnemyPunchTimer;
+    /// Snapshot of the match saved by the player, allocated once
+    ByteBuffer _checkpoint;
 };
 
 } // namespace FaceFight
\ No newline at end of file
@@ -20,12 +20,27 @@ namespace Geometry
  * 
  * @return calculated length of the vector
  */
-float GetVectorLength(
+inline float GetVectorLength(
     sf::Vector2f const& v)
 {
     return sqrt(v.x * v.x + v.y * v.y);
 }
 
+/**
+ * Calculates and returns the square of vector's length.
+ * Cheaper than the length itself, and enough for comparing lengths.
+ * 
+ * @param[in] v
+ *  Vector whose squared length we want to calculate
+ * 
+ * @return calculated squared length of the vector
+ */
+inline float GetVectorLengthSquared(
+    sf::Vector2f const& v)
+{
+    return v.x * v.x + v.y * v.y;
+}
+
 /**
  * Calculates the vector from one point to another
  * 
@@ -36,7 +51,7 @@ float GetVectorLength(
  * 
  * @return vector from point A to point B
  */
-sf::Vector2f GetVector(
+inline sf::Vector2f GetVector(
     sf::Vector2f pointA,
     sf::Vector2f pointB)
 {
@@ -54,7 +69,7 @@ sf::Vector2f GetVector(
  * 
  * @return normalised vector with length = 1
  */
-sf::Vector2f NormaliseVector(
+inline sf::Vector2f NormaliseVector(
     sf::Vector2f const& v)
 {
     return v / GetVectorLength(v);
@@ -70,7 +85,7 @@ sf::Vector2f NormaliseVector(
  * 
  * @return distance between the two points
  */
-float CalcDist(
+inline float CalcDist(
     sf::Vector2f const& pointA,
     sf::Vector2f const& pointB)
 {
@@ -0,0 +1,37 @@
+/* A file containing the input with which a fighter is controlled on a single tick */
+
+#pragma once
+
+#include <SFML/System/Vector2.hpp>
+
+namespace FaceFight
+{
+
+/**
+ * What the one controlling a fighter wants it to do on a tick.
+ * Inputs hold no pointers, so they can be copied byte by byte,
+ * and sent over the network as they are.
+ */
+struct FighterInput
+{
+    /// Point the fighter follows, as far as obstacles let it
+    sf::Vector2f target;
+
+    /// Whether the punch button is held, the fighter punches when it gets pressed
+    bool punch;
+
+    /// Whether the throw button is held, the fighter throws its fist when it gets pressed
+    bool throwFist;
+};
+
+inline bool operator==(FighterInput const& a, FighterInput const& b)
+{
+    return a.target == b.target && a.punch == b.punch && a.throwFist == b.throwFist;
+}
+
+inline bool operator!=(FighterInput const& a, FighterInput const& b)
+{
+    return !(a == b);
+}
+
+} // namespace FaceFight
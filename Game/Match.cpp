@@ -0,0 +1,1051 @@
+#include "Match.h"
+
+#include "Geometry/Geometry.hpp"
+#include "Random/RandomPurposes.hpp"
+
+namespace
+{
+
+sf::Vector2f const FIST_SCALE = {0.3f, 0.3f};
+
+// Enemies closer to the player than this many punch distances think with urgency
+float const ENEMY_URGENT_DIST_FACTOR = 2.f;
+
+// Time for which an enemy that got hit thinks with urgency, in ticks
+int const ENEMY_URGENT_AFTER_HIT = FaceFight::Match::TICK_RATE;
+
+// Speed of a thrown fist, in pixels per tick
+float const THROWN_FIST_SPEED = 25.f;
+
+// Distance from the thrower's center at which a thrown fist starts
+float const THROWN_FIST_START_DIST = 100.f;
+
+// Enemies closer to the player than this, that can see the player, throw fists while chasing
+float const ENEMY_THROW_DIST = 800.f;
+
+// Enemy punches come up to this many ticks earlier or later, so enemies don't punch in sync
+int const ENEMY_PUNCH_JITTER = FaceFight::Match::TICK_RATE / 6;
+
+// Number of enemies in the first wave of survival mode
+int const WAVE_SIZE_FIRST = 3;
+
+// Number of enemies added to each next wave
+int const WAVE_SIZE_GROWTH = 2;
+
+// Time between clearing a wave and the next wave, in ticks
+int const WAVE_DELAY = FaceFight::Match::TICK_RATE * 2;
+
+// Size of a cell of the flow field that guides enemies
+float const FLOW_FIELD_CELL_SIZE = 40.f;
+
+// Marks the beginning of a snapshot
+uint32_t const SNAPSHOT_MAGIC = 0x46464753; // "FFGS"
+
+// Version of the snapshot layout, increased whenever anything written to a snapshot changes
+uint32_t const SNAPSHOT_VERSION = 4;
+
+// Names of the conditions and actions of enemies' behavior trees, in the order of their enums
+std::vector<std::string> const BEHAVIOR_CONDITION_NAMES = {
+    "playerWithin", "playerInSight", "healthBelow", "playerHealthBelow", "canPunch", "chance"
+};
+std::vector<std::string> const BEHAVIOR_ACTION_NAMES = {
+    "chase", "retreat", "strafe", "wait", "punch", "feint", "throw"
+};
+
+// Cooldown after a feint, as a fraction of the cooldown after a punch
+float const FEINT_COOLDOWN_FACTOR = 0.5f;
+
+/* Entities this far outside the arena can still be seen,
+   since their fist reaches out of their face */
+float const VISIBLE_AREA_MARGIN = 200.f;
+
+} // namespace
+
+namespace FaceFight
+{
+
+MatchAssets::MatchAssets(
+    sf::Image const& playerFace,
+    sf::Image const& enemyFace,
+    sf::Image const& fist,
+    std::string const& arenaFile)
+    : playerFaceSize(playerFace.getSize()),
+    enemyFaceSize(enemyFace.getSize()),
+    fistSize(fist.getSize()),
+    // Masks are built once, at the size at which the sprites are drawn, and shared by all entities
+    playerFaceMask(playerFace),
+    enemyFaceMask(enemyFace),
+    fistMask(fist, FIST_SCALE),
+    arenaFile(arenaFile)
+{}
+
+Match::Match(MatchSettings const& settings, MatchAssets const& assets)
+    : _size(settings.size),
+    // every entity can punch and every fist can land once per tick
+    _eventBus(settings.maxEnemies + 1 + settings.maxProjectiles),
+    _timerWheel(settings.maxEnemies + 1),
+    _mode(settings.mode),
+    _arena(settings.size),
+    _enemies(settings.maxEnemies),
+    _wave(0),
+    _waveTimerRunning(false),
+    _random(settings.seed),
+    _parameters(settings.parameters),
+    // Despawned enemies stay in the queues until their turn comes, so there is room for them too
+    _thinkScheduler(2 * settings.maxEnemies, ThinkPrioritiesCount),
+    _maxThinksPerTick(settings.maxThinksPerTick),
+    _thinkBudget(settings.thinkBudget),
+    _enemyDecisions(settings.maxEnemies),
+    _projectiles(settings.maxProjectiles, settings.maxEnemies, settings.size),
+    _visibleArea(
+        -sf::Vector2f(VISIBLE_AREA_MARGIN, VISIBLE_AREA_MARGIN),
+        settings.size + 2.f * sf::Vector2f(VISIBLE_AREA_MARGIN, VISIBLE_AREA_MARGIN)
+    ),
+    _flowField(
+        settings.size,
+        FLOW_FIELD_CELL_SIZE
+    ),
+    _threadPool(settings.workersCount),
+    _commandQueue(_threadPool.GetThreadsCount()),
+    _crowdSeparation(settings.maxEnemies),
+    _enemyXs(settings.maxEnemies),
+    _enemyYs(settings.maxEnemies),
+    _lastPlayerInput{},
+    _lastOpponentInput{},
+    _enemyPolicy(assets.enemyPolicy),
+    _enemyBehavior(assets.enemyBehavior),
+    _behaviorBlackboards(settings.maxEnemies),
+    _behaviorMoves(settings.maxEnemies),
+    _behaviorAttacks(settings.maxEnemies, BehaviorAttack::None),
+    _scripts(settings.maxScripts),
+    _scriptedEnemies(settings.maxEnemies, false),
+    _scriptInputs(settings.maxEnemies),
+    _lastScriptInputs(settings.maxEnemies),
+    _stats{}
+{
+    // The policy network's batches hold every enemy at once
+    if (_enemyPolicy != nullptr)
+    {
+        if (_enemyPolicy->GetInputsCount() != POLICY_OBSERVATIONS_COUNT
+            || _enemyPolicy->GetOutputsCount() != POLICY_ACTIONS_COUNT)
+        {
+            throw "Error: Enemy policy has to take 8 observations and give 4 actions.";
+        }
+        _policyWorkspace.reset(new QuantizedMlp::Workspace(*_enemyPolicy, settings.maxEnemies));
+        _policyObservations.resize(settings.maxEnemies * POLICY_OBSERVATIONS_COUNT);
+        _policyActions.resize(settings.maxEnemies * POLICY_ACTIONS_COUNT);
+    }
+
+    // Sprites that are drawn get their textures, others only the sizes of their images
+    if (assets.playerFaceTexture != nullptr)
+    {
+        _player.SetFaceTexture(*assets.playerFaceTexture);
+        _player.SetFistTexture(*assets.fistTexture);
+        // Textures are set up only once, on the prototype, and shared by all enemies
+        _enemyPrototype.SetFaceTexture(*assets.enemyFaceTexture);
+        _enemyPrototype.SetFistTexture(*assets.fistTexture);
+        _projectiles.SetTexture(*assets.fistTexture, FIST_SCALE);
+    }
+    else
+    {
+        _player.SetFaceSize(assets.playerFaceSize);
+        _player.SetFistSize(assets.fistSize);
+        _enemyPrototype.SetFaceSize(assets.enemyFaceSize);
+        _enemyPrototype.SetFistSize(assets.fistSize);
+        _projectiles.SetSize(assets.fistSize, FIST_SCALE);
+    }
+    _player.SetFistScale(FIST_SCALE);
+    _enemyPrototype.SetFistScale(FIST_SCALE);
+
+    // Entities can't walk through the arena's obstacles, and enemies are guided around them
+    _arena.Load(assets.arenaFile);
+    _player.SetArena(&_arena, _player.GetFaceRadius());
+    _enemyPrototype.SetArena(&_arena, _enemyPrototype.GetFaceRadius());
+    for (sf::FloatRect const& obstacle : _arena.GetObstacles())
+    {
+        _flowField.Block(obstacle);
+    }
+
+    _player.SetFaceMask(&assets.playerFaceMask);
+    _player.SetFistMask(&assets.fistMask);
+    _enemyPrototype.SetFaceMask(&assets.enemyFaceMask);
+    _enemyPrototype.SetFistMask(&assets.fistMask);
+    _enemyPrototype.SetEnemy(&_player);
+
+    // Entities publish what happens to them, and the rest of the match reacts to it
+    _player.SetEventBus(&_eventBus);
+    _enemyPrototype.SetEventBus(&_eventBus);
+    // Entities record changes to each other, which are applied once per tick
+    _player.SetCommandQueue(&_commandQueue);
+    _enemyPrototype.SetCommandQueue(&_commandQueue);
+    _player.SetRandom(&_random);
+    _enemyPrototype.SetRandom(&_random);
+    _player.SetParameters(&_parameters);
+    _enemyPrototype.SetParameters(&_parameters);
+    _player.SetId(0); // enemies get IDs from their slots in the pool, starting from 1
+
+    _eventBus.Subscribe<Events::Hit, Match, &Match::OnHit>(this);
+    _eventBus.Subscribe<Events::Died, Match, &Match::OnDied>(this);
+
+    if (_mode == GameMode::Survival)
+    {
+        SpawnWave();
+    }
+    else
+    {
+        SpawnEnemy(_size / 2.f);
+    }
+}
+
+void Match::SaveSnapshot(ByteBuffer& buffer) const
+{
+    buffer.Write(SNAPSHOT_MAGIC);
+    buffer.Write(SNAPSHOT_VERSION);
+
+    buffer.Write(_mode);
+    buffer.Write(_random.GetSeed());
+    buffer.Write(_timerWheel.GetTick());
+    buffer.Write(_wave);
+    buffer.Write(_waveTimerRunning ? _timerWheel.GetRemainingTicks(_waveTimer) : uint64_t(0));
+    buffer.Write(_lastPlayerInput);
+    buffer.Write(_lastOpponentInput);
+
+    _player.Save(buffer, _timerWheel);
+    _enemies.Save(buffer, [this, &buffer](Entity const& enemy) {
+        enemy.Save(buffer, _timerWheel);
+        buffer.Write(_enemyDecisions[_enemies.GetHandle(&enemy).index]);
+        _behaviorBlackboards.Save(buffer, _enemies.GetHandle(&enemy).index);
+    });
+    _thinkScheduler.Save(buffer);
+    _projectiles.Save(buffer);
+}
+
+void Match::LoadSnapshot(ByteBuffer& buffer)
+{
+    if (buffer.Read<uint32_t>() != SNAPSHOT_MAGIC
+        || buffer.Read<uint32_t>() != SNAPSHOT_VERSION)
+    {
+        throw "Error: Snapshot has an unknown format or version.";
+    }
+    if (buffer.Read<GameMode>() != _mode)
+    {
+        throw "Error: Snapshot is of a game in a different mode.";
+    }
+
+    _random = CounterRandom(buffer.Read<uint64_t>());
+    // Timers are scheduled again by whoever owns them, as they are read
+    _timerWheel.Reset(buffer.Read<uint64_t>());
+    _wave = buffer.Read<int>();
+    _waveTimerRunning = false;
+    uint64_t const waveTicks = buffer.Read<uint64_t>();
+    if (waveTicks > 0)
+    {
+        _waveTimer = _timerWheel.Schedule<Match, &Match::SpawnWave>(waveTicks, this);
+        _waveTimerRunning = true;
+    }
+    _lastPlayerInput = buffer.Read<FighterInput>();
+    _lastOpponentInput = buffer.Read<FighterInput>();
+
+    _player.Load(buffer, _timerWheel);
+    _enemies.Load(buffer, [this, &buffer](Entity& enemy) {
+        enemy.Load(buffer, _timerWheel);
+        _enemyDecisions[_enemies.GetHandle(&enemy).index] = buffer.Read<EnemyDecision>();
+        _behaviorBlackboards.Load(buffer, _enemies.GetHandle(&enemy).index);
+    }, _enemyPrototype, sf::Vector2f(0.f, 0.f));
+    _thinkScheduler.Load(buffer);
+    _projectiles.Load(buffer);
+
+    // Scripts drive the state that was just replaced, and enemies are all back under their AI
+    _scripts.StopAll();
+    std::fill(_scriptedEnemies.begin(), _scriptedEnemies.end(), false);
+
+    // The player's enemy was destroyed with the old enemies
+    TargetNearestEnemy();
+}
+
+void Match::SetSeed(uint64_t seed)
+{
+    // Entities keep a pointer to the generator, not a copy of it
+    _random = CounterRandom(seed);
+}
+
+GameMode Match::GetMode() const
+{
+    return _mode;
+}
+
+bool Match::IsAgainstPlayer() const
+{
+    return _mode == GameMode::Versus || _mode == GameMode::Server || _mode == GameMode::Client;
+}
+
+bool Match::IsOpponentControlled() const
+{
+    return IsAgainstPlayer() || _mode == GameMode::PlannedDuel;
+}
+
+uint64_t Match::GetSetupToken() const
+{
+    uint64_t const seed = _random.GetSeed();
+    std::array<uint32_t, 4> const token = CounterRandom::Philox(
+        {(uint32_t)_size.x, (uint32_t)_size.y, 0, 0},
+        {(uint32_t)seed, (uint32_t)(seed >> 32)});
+    return (uint64_t)token[0] << 32 | token[1];
+}
+
+uint64_t Match::GetTick() const
+{
+    return _timerWheel.GetTick();
+}
+
+int Match::GetWave() const
+{
+    return _wave;
+}
+
+Entity& Match::GetPlayer()
+{
+    return _player;
+}
+
+Entity const& Match::GetPlayer() const
+{
+    return _player;
+}
+
+Entity& Match::GetOpponent()
+{
+    return _enemies.GetActive(0);
+}
+
+Entity const& Match::GetOpponent() const
+{
+    return _enemies.GetActive(0);
+}
+
+ObjectPool<Entity> const& Match::GetEnemies() const
+{
+    return _enemies;
+}
+
+ProjectileSystem& Match::GetProjectiles()
+{
+    return _projectiles;
+}
+
+ProjectileSystem const& Match::GetProjectiles() const
+{
+    return _projectiles;
+}
+
+Arena const& Match::GetArena() const
+{
+    return _arena;
+}
+
+size_t Match::GetFlowFieldRecomputeCount() const
+{
+    return _flowField.GetRecomputeCount();
+}
+
+GameplayParameters const& Match::GetParameters() const
+{
+    return _parameters;
+}
+
+ScriptScheduler& Match::GetScripts()
+{
+    return _scripts;
+}
+
+void Match::SetEnemyScripted(ObjectPool<Entity>::Handle enemy, bool scripted)
+{
+    if (_enemies.Get(enemy) == nullptr)
+    {
+        return;
+    }
+    _scriptedEnemies[enemy.index] = scripted;
+    // Buttons held before the script took over don't count as pressed
+    _scriptInputs[enemy.index] = FighterInput{_enemies.Get(enemy)->GetPosition(), false, false};
+    _lastScriptInputs[enemy.index] = _scriptInputs[enemy.index];
+}
+
+void Match::SetScriptedInput(ObjectPool<Entity>::Handle enemy, FighterInput const& input)
+{
+    if (_enemies.Get(enemy) != nullptr)
+    {
+        _scriptInputs[enemy.index] = input;
+    }
+}
+
+Match::Stats const& Match::GetStats() const
+{
+    return _stats;
+}
+
+SceneNode::Stats Match::TakeSceneStats()
+{
+    SceneNode::Stats stats{0, 0};
+    _player.TakeSceneStats(stats);
+    for (size_t e = 0; e < _enemies.GetActiveCount(); e++)
+    {
+        _enemies.GetActive(e).TakeSceneStats(stats);
+    }
+    return stats;
+}
+
+std::vector<std::string> const& Match::GetBehaviorConditionNames()
+{
+    return BEHAVIOR_CONDITION_NAMES;
+}
+
+std::vector<std::string> const& Match::GetBehaviorActionNames()
+{
+    return BEHAVIOR_ACTION_NAMES;
+}
+
+GameEventBus& Match::GetEventBus()
+{
+    return _eventBus;
+}
+
+void Match::Update(FighterInput const& playerInput, FighterInput const& opponentInput)
+{
+    /* Commands are recorded into the buffer of the calling thread within this match's pool,
+       and matches may be updated on workers of another pool, such as a server's */
+    ThreadPool::CallerScope const callerScope;
+
+    // Fire the timers that expire on this tick
+    _timerWheel.Advance();
+
+    // Scripts decide the input of their enemies before anyone moves
+    _scripts.Update();
+
+    // The player fights the nearest enemy
+    TargetNearestEnemy();
+    ControlFighter(_player, playerInput, _lastPlayerInput, ProjectileSystem::Team::Player);
+
+    // Enemies are guided towards the player's new position
+    _flowField.SetTarget(_player.GetPosition());
+
+    // Scripted enemies follow their scripts, and whatever controls the other enemies leaves them alone
+    for (size_t e = 0; e < _enemies.GetActiveCount(); e++)
+    {
+        Entity& enemy = _enemies.GetActive(e);
+        size_t const slot = _enemies.GetHandle(&enemy).index;
+        if (_scriptedEnemies[slot])
+        {
+            ControlFighter(enemy, _scriptInputs[slot], _lastScriptInputs[slot], ProjectileSystem::Team::Enemies);
+        }
+    }
+
+    if (IsOpponentControlled())
+    {
+        // The opponent is controlled by the other player, or by a planner
+        ControlFighter(_enemies.GetActive(0), opponentInput, _lastOpponentInput,
+            ProjectileSystem::Team::Enemies);
+    }
+    else if (_enemyPolicy != nullptr)
+    {
+        // The policy network decides for all enemies at once
+        ActEnemiesByPolicy();
+    }
+    else if (_enemyBehavior != nullptr)
+    {
+        // Every enemy ticks its behavior tree
+        sf::Clock thinkClock;
+        ActEnemiesByBehavior();
+        _stats.thinksCount = _enemies.GetActiveCount();
+        _stats.thinkTime = thinkClock.getElapsedTime();
+    }
+    else
+    {
+        // Enemies decide what to do, as many as the limits allow
+        sf::Clock thinkClock;
+        _stats.thinksCount = _thinkScheduler.Run(_maxThinksPerTick, _thinkBudget,
+            [this](ObjectPool<Entity>::Handle handle) { return ThinkEnemy(handle); });
+        _stats.thinkTime = thinkClock.getElapsedTime();
+
+        // and all of them act on their last decision
+        ActEnemies();
+    }
+
+    // Thrown fists fly, and record their hits together with the punches
+    sf::Clock projectilesClock;
+    _projectiles.Update(_player, _enemies, _arena, _commandQueue, _eventBus, _threadPool);
+    _stats.projectilesTime = projectilesClock.getElapsedTime();
+
+    // Apply damage, knockback and animations that entities recorded for each other
+    _commandQueue.Apply();
+
+    SeparateEnemies();
+
+    // Each entity animates only itself, so enemies can be animated in parallel
+    _player.UpdateAnimations(GetDetail(_player));
+    _threadPool.ParallelFor(_enemies.GetActiveCount(), [this](size_t begin, size_t end) {
+        for (size_t e = begin; e < end; e++)
+        {
+            Entity& enemy = _enemies.GetActive(e);
+            enemy.UpdateAnimations(GetDetail(enemy));
+        }
+    });
+
+    // Fists are pointed only after everyone has moved
+    _player.UpdateFist(GetDetail(_player));
+    _threadPool.ParallelFor(_enemies.GetActiveCount(), [this](size_t begin, size_t end) {
+        for (size_t e = begin; e < end; e++)
+        {
+            Entity& enemy = _enemies.GetActive(e);
+            enemy.UpdateFist(GetDetail(enemy));
+        }
+    });
+
+    // Let everyone react to what happened during this tick
+    _eventBus.Dispatch();
+}
+
+void Match::ControlFighter(
+    Entity& fighter,
+    FighterInput const& input,
+    FighterInput& lastInput,
+    ProjectileSystem::Team team)
+{
+    Entity* const target = fighter.GetEnemy();
+
+    // Fighter follows the input's target, but can't go through obstacles
+    fighter.Move(input.target - fighter.GetPosition());
+
+    if (fighter.IsAlive())
+    {
+        // punch enemy only if button was not pressed previously but now is
+        if (input.punch && !lastInput.punch)
+        {
+            // The punch lands only if the fist actually reaches the target's face
+            fighter.PunchEnemy(_timerWheel.GetTick(),
+                target != nullptr && target->IsAlive() && fighter.CanHit(*target));
+        }
+
+        // throw a fist at the enemy the same way, with the other button
+        if (input.throwFist && !lastInput.throwFist && target != nullptr)
+        {
+            ThrowFist(fighter, team, Geometry::NormaliseVector(
+                Geometry::GetVector(fighter.GetPosition(), target->GetPosition())));
+        }
+
+        lastInput = input;
+    }
+}
+
+Entity::Detail Match::GetDetail(Entity const& entity) const
+{
+    return _visibleArea.contains(entity.GetPosition()) ? Entity::Detail::Full : Entity::Detail::Reduced;
+}
+
+size_t Match::ThinkEnemy(ObjectPool<Entity>::Handle handle)
+{
+    Entity* const enemy = _enemies.Get(handle);
+    if (enemy == nullptr || !enemy->IsAlive())
+    {
+        return ThinkScheduler<ObjectPool<Entity>::Handle>::DROP;
+    }
+
+    EnemyDecision& decision = _enemyDecisions[handle.index];
+    sf::Vector2f const toPlayer = Geometry::GetVector(enemy->GetPosition(), _player.GetPosition());
+    float const distSquared = Geometry::GetVectorLengthSquared(toPlayer);
+
+    bool const playerInSight = _arena.HasLineOfSight(enemy->GetPosition(), _player.GetPosition());
+
+    // If enemy is not close enough to punch, or an obstacle is in the way, it chases the player
+    float const punchDist = _parameters.punchDist;
+    if (distSquared > punchDist * punchDist || !playerInSight)
+    {
+        decision.action = EnemyDecision::Action::Chase;
+        // Go straight if the player can be seen, otherwise follow the flow field around obstacles
+        decision.direction = playerInSight
+            ? sf::Vector2f(0.f, 0.f)
+            : _flowField.Sample(enemy->GetPosition());
+        if (decision.direction == sf::Vector2f(0.f, 0.f))
+        {
+            decision.direction = Geometry::NormaliseVector(toPlayer);
+        }
+    }
+    // Otherwise it attacks
+    else
+    {
+        decision.action = EnemyDecision::Action::Attack;
+    }
+    decision.playerInSight = playerInSight;
+
+    float const urgentDist = ENEMY_URGENT_DIST_FACTOR * punchDist;
+    if (distSquared <= urgentDist * urgentDist
+        || _timerWheel.GetTick() < decision.hitUntilTick)
+    {
+        return Urgent;
+    }
+    sf::FloatRect const screen(sf::Vector2f(0.f, 0.f), _size);
+    return screen.contains(enemy->GetPosition()) ? Normal : Idle;
+}
+
+void Match::ActEnemies()
+{
+    if (!_player.IsAlive())
+    {
+        return;
+    }
+
+    for (size_t e = 0; e < _enemies.GetActiveCount(); e++)
+    {
+        Entity& enemy = _enemies.GetActive(e);
+        if (!enemy.IsAlive() || _scriptedEnemies[_enemies.GetHandle(&enemy).index])
+        {
+            continue;
+        }
+
+        EnemyDecision const& decision = _enemyDecisions[_enemies.GetHandle(&enemy).index];
+        sf::Vector2f const toPlayer = Geometry::GetVector(enemy.GetPosition(), _player.GetPosition());
+        if (decision.action == EnemyDecision::Action::Chase)
+        {
+            enemy.Move(decision.direction * _parameters.enemySpeed);
+
+            // Enemies that see the player throw fists at them on the way
+            if (decision.playerInSight && enemy.CanPunch()
+                && Geometry::GetVectorLengthSquared(toPlayer) <= ENEMY_THROW_DIST * ENEMY_THROW_DIST)
+            {
+                ThrowFist(enemy, ProjectileSystem::Team::Enemies, Geometry::NormaliseVector(toPlayer));
+                StartEnemyCooldown(enemy, _parameters.enemyThrowFreq);
+            }
+            continue;
+        }
+
+        // The player may have stepped away since the enemy decided to attack, then it just closes in
+        if (Geometry::GetVectorLengthSquared(toPlayer) > _parameters.punchDist * _parameters.punchDist)
+        {
+            enemy.Move(Geometry::NormaliseVector(toPlayer) * _parameters.enemySpeed);
+        }
+        // Otherwise enemy punches, if enough time has passed since last punch
+        else if (enemy.CanPunch())
+        {
+            // Enemy punches player, and lands the punch if the fist reaches
+            enemy.PunchEnemy(_timerWheel.GetTick(), enemy.CanHit(_player));
+
+            // and waits for the cooldown to pass before punching again
+            StartEnemyCooldown(enemy, _parameters.enemyPunchFreq);
+        }
+    }
+}
+
+void Match::ActEnemiesByPolicy()
+{
+    _stats.policyInferences = 0;
+    if (!_player.IsAlive())
+    {
+        return;
+    }
+
+    // Enemies only read the match while they are observed, so they are observed in parallel
+    size_t const enemiesCount = _enemies.GetActiveCount();
+    float const diagonal = std::hypot(_size.x, _size.y);
+    _threadPool.ParallelFor(enemiesCount, [this, diagonal](size_t begin, size_t end) {
+        for (size_t e = begin; e < end; e++)
+        {
+            Entity const& enemy = _enemies.GetActive(e);
+            sf::Vector2f const toPlayer = Geometry::GetVector(enemy.GetPosition(), _player.GetPosition());
+            sf::Vector2f const flow = _flowField.Sample(enemy.GetPosition());
+            float* const observation = &_policyObservations[e * POLICY_OBSERVATIONS_COUNT];
+            observation[0] = toPlayer.x / _size.x;
+            observation[1] = toPlayer.y / _size.y;
+            observation[2] = Geometry::GetVectorLength(toPlayer) / diagonal;
+            observation[3] = flow.x;
+            observation[4] = flow.y;
+            observation[5] = enemy.CanPunch() ? 1.f : 0.f;
+            observation[6] = (float)enemy.GetHealth() / Entity::MAX_HEALTH;
+            observation[7] = (float)_player.GetHealth() / Entity::MAX_HEALTH;
+        }
+    });
+
+    sf::Clock policyClock;
+    _enemyPolicy->Run(_policyObservations.data(), enemiesCount, _policyActions.data(),
+        *_policyWorkspace, _threadPool);
+    _stats.policyTime = policyClock.getElapsedTime();
+    _stats.policyInferences = enemiesCount;
+
+    // Acting punches, throws and starts timers, which are shared, so enemies act one by one
+    for (size_t e = 0; e < enemiesCount; e++)
+    {
+        Entity& enemy = _enemies.GetActive(e);
+        if (!enemy.IsAlive() || _scriptedEnemies[_enemies.GetHandle(&enemy).index])
+        {
+            continue;
+        }
+        float const* const action = &_policyActions[e * POLICY_ACTIONS_COUNT];
+
+        // Enemy moves as fast as the direction is long, but never faster than its speed
+        sf::Vector2f direction(action[0], action[1]);
+        float const length = Geometry::GetVectorLength(direction);
+        if (length > 1.f)
+        {
+            direction /= length;
+        }
+        enemy.Move(direction * _parameters.enemySpeed);
+
+        if (!enemy.CanPunch())
+        {
+            continue;
+        }
+        if (action[2] > 0.f)
+        {
+            enemy.PunchEnemy(_timerWheel.GetTick(), enemy.CanHit(_player));
+            StartEnemyCooldown(enemy, _parameters.enemyPunchFreq);
+        }
+        else if (action[3] > 0.f)
+        {
+            ThrowFist(enemy, ProjectileSystem::Team::Enemies, Geometry::NormaliseVector(
+                Geometry::GetVector(enemy.GetPosition(), _player.GetPosition())));
+            StartEnemyCooldown(enemy, _parameters.enemyThrowFreq);
+        }
+    }
+}
+
+class Match::EnemyBehavior
+{
+
+  public:
+
+    /**
+     * Sets up the leaves of an enemy's behavior tree for this tick
+     * 
+     * @param[in] match
+     *  The match, which is only read
+     * @param[in] enemy
+     *  The enemy ticking its tree
+     * @param[in] slot
+     *  Index of the enemy in the enemy pool
+     */
+    EnemyBehavior(Match& match, Entity const& enemy, size_t slot)
+        : _match(match),
+        _enemy(enemy),
+        _slot(slot),
+        _toPlayer(Geometry::GetVector(enemy.GetPosition(), match._player.GetPosition())),
+        _random(match._random.GetStream(
+            enemy.GetId(), match._timerWheel.GetTick(), (uint32_t)RandomPurpose::BehaviorChance))
+    {
+        _match._behaviorMoves[_slot] = sf::Vector2f(0.f, 0.f);
+        _match._behaviorAttacks[_slot] = BehaviorAttack::None;
+    }
+
+    bool Check(uint8_t condition, float argument)
+    {
+        switch ((BehaviorCondition)condition)
+        {
+            case BehaviorCondition::PlayerWithin:
+            {
+                float const dist = argument * _match._parameters.punchDist;
+                return Geometry::GetVectorLengthSquared(_toPlayer) <= dist * dist;
+            }
+            case BehaviorCondition::PlayerInSight:
+                return _match._arena.HasLineOfSight(_enemy.GetPosition(), _match._player.GetPosition());
+            case BehaviorCondition::HealthBelow:
+                return _enemy.GetHealth() < argument * Entity::MAX_HEALTH;
+            case BehaviorCondition::PlayerHealthBelow:
+                return _match._player.GetHealth() < argument * Entity::MAX_HEALTH;
+            case BehaviorCondition::CanPunch:
+                return _enemy.CanPunch();
+            case BehaviorCondition::Chance:
+                return _random.NextFloat() < argument;
+            default:
+                return false;
+        }
+    }
+
+    BehaviorTree::Status Act(uint8_t action, float argument, uint32_t ticks)
+    {
+        sf::Vector2f& move = _match._behaviorMoves[_slot];
+        BehaviorAttack& attack = _match._behaviorAttacks[_slot];
+        switch ((BehaviorAction)action)
+        {
+            case BehaviorAction::Chase:
+                // Go straight if the player can be seen, otherwise follow the flow field around obstacles
+                move = _match._arena.HasLineOfSight(_enemy.GetPosition(), _match._player.GetPosition())
+                    ? sf::Vector2f(0.f, 0.f)
+                    : _match._flowField.Sample(_enemy.GetPosition());
+                if (move == sf::Vector2f(0.f, 0.f))
+                {
+                    move = Geometry::NormaliseVector(_toPlayer);
+                }
+                return Continue(argument, ticks);
+            case BehaviorAction::Retreat:
+                move = -Geometry::NormaliseVector(_toPlayer);
+                return Continue(argument, ticks);
+            case BehaviorAction::Strafe:
+            {
+                // Neighbouring slots circle in opposite directions, so crowds spread around the player
+                sf::Vector2f const direction = Geometry::NormaliseVector(_toPlayer);
+                float const side = _slot % 2 == 0 ? 1.f : -1.f;
+                move = side * sf::Vector2f(-direction.y, direction.x);
+                return Continue(argument, ticks);
+            }
+            case BehaviorAction::Wait:
+                return Continue(argument, ticks);
+            case BehaviorAction::Punch:
+                return Attack(attack, BehaviorAttack::Punch);
+            case BehaviorAction::Feint:
+                return Attack(attack, BehaviorAttack::Feint);
+            case BehaviorAction::Throw:
+                return Attack(attack, BehaviorAttack::Throw);
+            default:
+                return BehaviorTree::Status::Failure;
+        }
+    }
+
+  private: /* functions */
+
+    /**
+     * Returns whether an action lasting the given number of ticks is still running
+     */
+    static BehaviorTree::Status Continue(float duration, uint32_t ticks)
+    {
+        return ticks + 1 < duration ? BehaviorTree::Status::Running : BehaviorTree::Status::Success;
+    }
+
+    /**
+     * Decides on an attack, if the enemy's cooldown is over
+     */
+    BehaviorTree::Status Attack(BehaviorAttack& attack, BehaviorAttack decided) const
+    {
+        if (!_enemy.CanPunch())
+        {
+            return BehaviorTree::Status::Failure;
+        }
+        attack = decided;
+        return BehaviorTree::Status::Success;
+    }
+
+  private: /* variables */
+
+    /// The match, whose only writes are the enemy's decisions
+    Match& _match;
+
+    /// The enemy ticking its tree, and its index in the enemy pool
+    Entity const& _enemy;
+    size_t _slot;
+
+    /// Vector from the enemy to the player
+    sf::Vector2f _toPlayer;
+
+    /// Random numbers of the enemy on this tick
+    CounterRandom::Stream _random;
+};
+
+void Match::ActEnemiesByBehavior()
+{
+    if (!_player.IsAlive())
+    {
+        return;
+    }
+
+    // Enemies only write their own decisions while ticking their trees, so they tick in parallel
+    _threadPool.ParallelFor(_enemies.GetActiveCount(), [this](size_t begin, size_t end) {
+        for (size_t e = begin; e < end; e++)
+        {
+            Entity const& enemy = _enemies.GetActive(e);
+            size_t const slot = _enemies.GetHandle(&enemy).index;
+            if (!enemy.IsAlive() || _scriptedEnemies[slot])
+            {
+                continue;
+            }
+            EnemyBehavior behavior(*this, enemy, slot);
+            _enemyBehavior->Tick(_behaviorBlackboards, slot, behavior);
+        }
+    });
+
+    // Attacks start timers and throw fists, which are shared, so enemies carry out their decisions one by one
+    for (size_t e = 0; e < _enemies.GetActiveCount(); e++)
+    {
+        Entity& enemy = _enemies.GetActive(e);
+        size_t const slot = _enemies.GetHandle(&enemy).index;
+        if (!enemy.IsAlive() || _scriptedEnemies[slot])
+        {
+            continue;
+        }
+        enemy.Move(_behaviorMoves[slot] * _parameters.enemySpeed);
+
+        switch (_behaviorAttacks[slot])
+        {
+            case BehaviorAttack::Punch:
+                enemy.PunchEnemy(_timerWheel.GetTick(), enemy.CanHit(_player));
+                StartEnemyCooldown(enemy, _parameters.enemyPunchFreq);
+                break;
+            case BehaviorAttack::Feint:
+                enemy.PunchEnemy(_timerWheel.GetTick(), false);
+                StartEnemyCooldown(enemy, (int)(_parameters.enemyPunchFreq * FEINT_COOLDOWN_FACTOR));
+                break;
+            case BehaviorAttack::Throw:
+                ThrowFist(enemy, ProjectileSystem::Team::Enemies,
+                    Geometry::NormaliseVector(Geometry::GetVector(enemy.GetPosition(), _player.GetPosition())));
+                StartEnemyCooldown(enemy, _parameters.enemyThrowFreq);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+void Match::StartEnemyCooldown(Entity& enemy, int cooldown)
+{
+    CounterRandom::Stream random = _random.GetStream(
+        enemy.GetId(), _timerWheel.GetTick(), (uint32_t)RandomPurpose::PunchCooldown);
+    enemy.StartPunchCooldown(_timerWheel,
+        cooldown - ENEMY_PUNCH_JITTER + random.NextUInt(2 * ENEMY_PUNCH_JITTER + 1));
+}
+
+void Match::ThrowFist(Entity& thrower, ProjectileSystem::Team team, sf::Vector2f const& direction)
+{
+    // The fist lunges without landing a punch, and flies on from where it would have been
+    thrower.PunchEnemy(_timerWheel.GetTick(), false);
+    _projectiles.Throw(team, thrower.GetId(),
+        thrower.GetPosition() + direction * THROWN_FIST_START_DIST,
+        direction * THROWN_FIST_SPEED);
+}
+
+void Match::SpawnEnemy(sf::Vector2f const& position)
+{
+    ObjectPool<Entity>::Handle const handle = _enemies.Create(_enemyPrototype, position);
+    // Slots are unique among existing enemies, and the player has ID 0
+    _enemies.Get(handle)->SetId(handle.index + 1);
+
+    // New enemies think as soon as possible, until then they stand still
+    _enemyDecisions[handle.index] = {EnemyDecision::Action::Chase, sf::Vector2f(0.f, 0.f), false, 0};
+    _behaviorBlackboards.Reset(handle.index);
+    _scriptedEnemies[handle.index] = false;
+    _thinkScheduler.Enqueue(handle, Urgent);
+}
+
+void Match::DespawnEnemy(Entity* enemy)
+{
+    // A pending cooldown timer would otherwise fire on a destroyed entity
+    enemy->CancelPunchCooldown(_timerWheel);
+    if (_player.GetEnemy() == enemy)
+    {
+        _player.SetEnemy(nullptr);
+    }
+    _enemies.Destroy(_enemies.GetHandle(enemy));
+}
+
+void Match::SpawnWave()
+{
+    _waveTimerRunning = false;
+    _wave++;
+
+    size_t waveSize = WAVE_SIZE_FIRST + WAVE_SIZE_GROWTH * (_wave - 1);
+    waveSize = std::min(waveSize, _enemies.GetCapacity() - _enemies.GetActiveCount());
+
+    // Enemies come in from random points on the edges of the arena
+    float const width = _size.x;
+    float const height = _size.y;
+    // Spawning isn't done by any entity, so the wave number takes the entity's place in the stream
+    CounterRandom::Stream random = _random.GetStream(
+        (uint32_t)_wave, _timerWheel.GetTick(), (uint32_t)RandomPurpose::SpawnPosition);
+    for (size_t e = 0; e < waveSize; e++)
+    {
+        float p = random.NextFloat(0.f, 2 * (width + height));
+        sf::Vector2f position;
+        if (p < width)
+        {
+            position = {p, 0.f};
+        }
+        else if ((p -= width) < height)
+        {
+            position = {width, p};
+        }
+        else if ((p -= height) < width)
+        {
+            position = {width - p, height};
+        }
+        else
+        {
+            position = {0.f, height - (p - width)};
+        }
+        SpawnEnemy(position);
+    }
+}
+
+void Match::SeparateEnemies()
+{
+    sf::Clock separationClock;
+
+    size_t const enemiesCount = _enemies.GetActiveCount();
+    for (size_t e = 0; e < enemiesCount; e++)
+    {
+        sf::Vector2f const position = _enemies.GetActive(e).GetPosition();
+        _enemyXs[e] = position.x;
+        _enemyYs[e] = position.y;
+    }
+
+    _crowdSeparation.Resolve(
+        _enemyXs.data(), _enemyYs.data(), enemiesCount,
+        _enemyPrototype.GetFaceRadius(),
+        _threadPool
+    );
+
+    // Only enemies that were actually pushed have to follow their new center
+    for (size_t e = 0; e < enemiesCount; e++)
+    {
+        Entity& enemy = _enemies.GetActive(e);
+        sf::Vector2f const position(_enemyXs[e], _enemyYs[e]);
+        if (position != enemy.GetPosition())
+        {
+            // Moved rather than placed, so that enemies aren't pushed into obstacles
+            enemy.Move(position - enemy.GetPosition());
+        }
+    }
+
+    _stats.separationTime = separationClock.getElapsedTime();
+}
+
+void Match::TargetNearestEnemy()
+{
+    Entity* nearest = nullptr;
+    float nearestDist = 0.f;
+    for (size_t e = 0; e < _enemies.GetActiveCount(); e++)
+    {
+        Entity& enemy = _enemies.GetActive(e);
+        if (!enemy.IsAlive() && _mode == GameMode::Survival)
+        {
+            continue;
+        }
+        float const dist = Geometry::CalcDist(_player.GetPosition(), enemy.GetPosition());
+        if (nearest == nullptr || dist < nearestDist)
+        {
+            nearest = &enemy;
+            nearestDist = dist;
+        }
+    }
+    _player.SetEnemy(nearest);
+}
+
+void Match::OnHit(Events::Hit const& event)
+{
+    if (event.victim != &_player)
+    {
+        _enemyDecisions[_enemies.GetHandle(event.victim).index].hitUntilTick =
+            _timerWheel.GetTick() + ENEMY_URGENT_AFTER_HIT;
+    }
+}
+
+void Match::OnDied(Events::Died const& event)
+{
+    if (event.entity == &_player || _mode != GameMode::Survival)
+    {
+        return;
+    }
+
+    // In survival mode dead enemies leave the arena, and the next wave comes when all are gone
+    DespawnEnemy(event.entity);
+    if (_enemies.GetActiveCount() == 0 && _player.IsAlive())
+    {
+        _waveTimer = _timerWheel.Schedule<Match, &Match::SpawnWave>(WAVE_DELAY, this);
+        _waveTimerRunning = true;
+    }
+}
+
+} // namespace FaceFight
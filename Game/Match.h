@@ -0,0 +1,679 @@
+#pragma once
+
+#include "Entities/Entity.h"
+
+#include "Events/Events.hpp"
+
+#include "Timing/TimerWheel.h"
+
+#include "Pools/ObjectPool.hpp"
+
+#include "Navigation/FlowField.h"
+
+#include "Parallel/ThreadPool.h"
+
+#include "Commands/CommandQueue.h"
+
+#include "Random/CounterRandom.h"
+
+#include "AI/ThinkScheduler.hpp"
+#include "AI/BehaviorTree.h"
+
+#include "Scripting/ScriptScheduler.h"
+
+#include "Collision/AlphaMask.h"
+
+#include "Arena/Arena.h"
+
+#include "Neural/QuantizedMlp.h"
+
+#include "Projectiles/ProjectileSystem.h"
+
+#include "Crowd/CrowdSeparation.h"
+
+#include "Serialization/ByteBuffer.h"
+
+#include "Input/FighterInput.hpp"
+
+#include "Balance/GameplayParameters.hpp"
+
+#include <SFML/Graphics.hpp>
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace FaceFight
+{
+
+/// The modes in which the game can be played
+enum class GameMode
+{
+    /// The player fights a single enemy
+    Duel,
+    /// The player fights waves of enemies, each wave bigger than the previous one
+    Survival,
+    /// Two players fight each other, each on their own machine, connected over the network
+    Versus,
+    /// Two players fight each other, with the match simulated only on this machine,
+    /// which plays the first fighter and sends what happens to the client
+    Server,
+    /// Two players fight each other, with the match simulated only on the server,
+    /// this machine plays the second fighter and shows what the server sends
+    Client,
+    /// The player fights a single enemy, which plans its moves by searching through simulated futures
+    PlannedDuel
+};
+
+/**
+ * Everything a match needs from the game's resources,
+ * loaded once and shared by any number of matches.
+ */
+struct MatchAssets
+{
+    /**
+     * Builds the sizes and masks of the sprites from their images
+     * 
+     * @param[in] playerFace
+     *  Image of the player's face
+     * @param[in] enemyFace
+     *  Image of an enemy's face
+     * @param[in] fist
+     *  Image of a fist
+     * @param[in] arenaFile
+     *  Path of the file with the arena's obstacles
+     */
+    MatchAssets(
+        sf::Image const& playerFace,
+        sf::Image const& enemyFace,
+        sf::Image const& fist,
+        std::string const& arenaFile
+    );
+
+    /// Sizes of the images of the sprites, before scaling
+    sf::Vector2u playerFaceSize;
+    sf::Vector2u enemyFaceSize;
+    sf::Vector2u fistSize;
+
+    /// Masks of the opaque pixels of the faces and the fist, for hit tests
+    AlphaMask playerFaceMask;
+    AlphaMask enemyFaceMask;
+    AlphaMask fistMask;
+
+    /// Path of the file with the arena's obstacles
+    std::string arenaFile;
+
+    /// Textures of the sprites, left null if the match is never drawn
+    sf::Texture const* playerFaceTexture = nullptr;
+    sf::Texture const* enemyFaceTexture = nullptr;
+    sf::Texture const* fistTexture = nullptr;
+
+    /// Policy network deciding what enemies do, left null for the hand-written rules
+    QuantizedMlp const* enemyPolicy = nullptr;
+
+    /**
+     * Behavior tree deciding what enemies do, left null for the hand-written rules,
+     * loaded with the names of Match::GetBehaviorConditionNames() and Match::GetBehaviorActionNames()
+     */
+    BehaviorTree const* enemyBehavior = nullptr;
+};
+
+/// How a match is set up
+struct MatchSettings
+{
+    /// The mode in which the match is played
+    GameMode mode = GameMode::Duel;
+
+    /// Seed of all random numbers in the match
+    uint64_t seed = 0;
+
+    /// Size of the arena, which is the size of the screen on which the match is shown
+    sf::Vector2f size;
+
+    /// Maximum number of enemies alive, and of thrown fists in flight, at the same time
+    size_t maxEnemies = 50000;
+    size_t maxProjectiles = 100000;
+
+    /// Number of scripts that can run at the same time before the match's scheduler has to grow
+    size_t maxScripts = 1024;
+
+    /**
+     * Maximum number of enemies that think on each tick, and the time they may take, or zero for no time limit.
+     * A time limit makes the match play differently on different machines,
+     * so it is only meant for matches that are neither replayed nor shared with a peer.
+     */
+    size_t maxThinksPerTick = 4096;
+    std::chrono::microseconds thinkBudget = std::chrono::microseconds::zero();
+
+    /// Number of worker threads for the match's data-parallel loops, besides the calling thread
+    size_t workersCount = ThreadPool::GetDefaultWorkersCount();
+
+    /// Numbers that decide how fighters fight
+    GameplayParameters parameters;
+};
+
+/**
+ * A class for the simulation of a single match, without a window, sounds or text.
+ * All memory the match needs is allocated when it is created,
+ * so that any number of matches can run side by side, each on its own thread.
+ * 
+ * A match advances one tick at a time, with the input of both players.
+ * Whatever is shown of it is read through its getters,
+ * and through the events it publishes on its event bus.
+ */
+class Match
+{
+
+  public:
+
+    /// Number of ticks in a second of the match
+    static constexpr int TICK_RATE = 60;
+
+    /// Performance counters of the last tick
+    struct Stats
+    {
+        /// Number of enemies that thought, and the time it took
+        size_t thinksCount;
+        sf::Time thinkTime;
+
+        /// Time that updating the thrown fists took
+        sf::Time projectilesTime;
+
+        /// Time that the separation step took
+        sf::Time separationTime;
+
+        /// Number of enemies whose actions the policy network inferred, and the time it took
+        size_t policyInferences;
+        sf::Time policyTime;
+    };
+
+    /**
+     * Number of observations of an enemy given to a policy network:
+     * offset to the player, relative to the arena's size, distance to the player,
+     * relative to the arena's diagonal, direction of the flow field,
+     * whether the enemy can punch, and the enemy's and the player's health, relative to the maximum
+     */
+    static constexpr size_t POLICY_OBSERVATIONS_COUNT = 8;
+
+    /**
+     * Number of actions of an enemy given by a policy network:
+     * direction in which to move, whether to punch, and whether to throw the fist
+     */
+    static constexpr size_t POLICY_ACTIONS_COUNT = 4;
+
+    /// Conditions that an enemy's behavior tree can check, with their arguments
+    enum class BehaviorCondition : uint8_t
+    {
+        /// The player is within the given number of punch distances
+        PlayerWithin,
+        /// There are no obstacles between the enemy and the player
+        PlayerInSight,
+        /// The enemy's health is below the given fraction of the maximum
+        HealthBelow,
+        /// The player's health is below the given fraction of the maximum
+        PlayerHealthBelow,
+        /// The enemy's punch cooldown is over
+        CanPunch,
+        /// Holds with the given probability, drawn again on every check
+        Chance
+    };
+
+    /// Actions that an enemy's behavior tree can run, with their arguments
+    enum class BehaviorAction : uint8_t
+    {
+        /// Moves towards the player for the given number of ticks, around obstacles
+        Chase,
+        /// Moves away from the player for the given number of ticks
+        Retreat,
+        /// Circles around the player for the given number of ticks
+        Strafe,
+        /// Stands still for the given number of ticks
+        Wait,
+        /// Punches the player, fails if the cooldown isn't over
+        Punch,
+        /// Starts a punch that never lands, with a shorter cooldown, fails if the cooldown isn't over
+        Feint,
+        /// Throws the fist at the player, fails if the cooldown isn't over
+        Throw
+    };
+
+  public:
+
+    /**
+     * Sets up a new match, with the player and the first enemies spawned
+     * 
+     * @param[in] settings
+     *  How the match is set up
+     * @param[in] assets
+     *  Resources of the match, which have to outlive it
+     */
+    Match(MatchSettings const& settings, MatchAssets const& assets);
+
+    Match(Match const&) = delete;
+    Match& operator=(Match const&) = delete;
+
+    /**
+     * Updates the match for the next tick.
+     * 
+     * @param[in] playerInput
+     *  Input controlling the player on this tick
+     * @param[in] opponentInput
+     *  Input controlling the player's opponent on this tick,
+     *  used when the opponent is controlled by another player or by a planner
+     */
+    void Update(FighterInput const& playerInput, FighterInput const& opponentInput);
+
+    /**
+     * Writes the whole simulation state of the match to a buffer,
+     * so that the match can later be restored, or cloned into another match.
+     * Can only be called between ticks.
+     * 
+     * @param[in] buffer
+     *  Buffer to which the snapshot is written
+     */
+    void SaveSnapshot(ByteBuffer& buffer) const;
+
+    /**
+     * Restores the match from a snapshot written by SaveSnapshot(),
+     * of a match in the same mode. Can only be called between ticks.
+     * 
+     * @param[in] buffer
+     *  Buffer from which the snapshot is read
+     */
+    void LoadSnapshot(ByteBuffer& buffer);
+
+    /**
+     * Reseeds the random numbers of the match, so that a match restored from a snapshot
+     * can play out differently than the one that saved it. Can only be called between ticks.
+     * 
+     * @param[in] seed
+     *  The new seed
+     */
+    void SetSeed(uint64_t seed);
+
+    /// Returns the mode in which the match is played
+    GameMode GetMode() const;
+
+    /// Tells whether the player's opponent is controlled by another player
+    bool IsAgainstPlayer() const;
+
+    /// Tells whether the player's opponent follows the input given to Update(), rather than the enemy AI
+    bool IsOpponentControlled() const;
+
+    /**
+     * Returns a value identifying how the match was set up, from its seed and its size.
+     * Matches set up the same way on any machine have the same token,
+     * so peers can tell that they play the same match.
+     */
+    uint64_t GetSetupToken() const;
+
+    /// Returns the number of ticks played so far
+    uint64_t GetTick() const;
+
+    /// Returns the number of the current wave in survival mode
+    int GetWave() const;
+
+    /**
+     * Returns the player's entity
+     */
+    Entity& GetPlayer();
+    Entity const& GetPlayer() const;
+
+    /**
+     * Returns the player's only enemy, which exists in every mode but survival
+     */
+    Entity& GetOpponent();
+    Entity const& GetOpponent() const;
+
+    /**
+     * Returns the pool of enemy entities
+     */
+    ObjectPool<Entity> const& GetEnemies() const;
+
+    /**
+     * Returns the fists thrown by the player and the enemies
+     */
+    ProjectileSystem& GetProjectiles();
+    ProjectileSystem const& GetProjectiles() const;
+
+    /**
+     * Returns the static geometry of the arena
+     */
+    Arena const& GetArena() const;
+
+    /**
+     * Returns the number of times the flow field has been recomputed
+     */
+    size_t GetFlowFieldRecomputeCount() const;
+
+    /**
+     * Returns the performance counters of the last tick
+     */
+    Stats const& GetStats() const;
+
+    /**
+     * Returns the counters of world transform computations of all fighters,
+     * accumulated since the last call, and resets them
+     */
+    SceneNode::Stats TakeSceneStats();
+
+    /**
+     * Returns the numbers that decide how fighters fight in this match
+     */
+    GameplayParameters const& GetParameters() const;
+
+    /**
+     * Returns the scheduler of the match's scripts, which advances with the match, before anyone moves.
+     * Scripts can't be saved in snapshots, so loading a snapshot stops them.
+     */
+    ScriptScheduler& GetScripts();
+
+    /**
+     * Hands an enemy over to a script, or gives it back to whatever controls the other enemies.
+     * A scripted enemy follows the input that its script sets, like a fighter controlled by a player.
+     * 
+     * @param[in] enemy
+     *  Handle of the enemy in the enemy pool
+     * @param[in] scripted
+     *  Whether the enemy is controlled by a script
+     */
+    void SetEnemyScripted(ObjectPool<Entity>::Handle enemy, bool scripted);
+
+    /**
+     * Sets the input that a scripted enemy follows from this tick on
+     * 
+     * @param[in] enemy
+     *  Handle of a scripted enemy in the enemy pool
+     * @param[in] input
+     *  The enemy's input
+     */
+    void SetScriptedInput(ObjectPool<Entity>::Handle enemy, FighterInput const& input);
+
+    /**
+     * Returns the names of the conditions of enemies' behavior trees, in the order of BehaviorCondition
+     */
+    static std::vector<std::string> const& GetBehaviorConditionNames();
+
+    /**
+     * Returns the names of the actions of enemies' behavior trees, in the order of BehaviorAction
+     */
+    static std::vector<std::string> const& GetBehaviorActionNames();
+
+    /**
+     * Returns the event bus on which entities publish what happens to them,
+     * where whatever shows the match can subscribe as well
+     */
+    GameEventBus& GetEventBus();
+
+  private:
+
+    /// What an enemy decided to do the last time it thought
+    struct EnemyDecision
+    {
+        enum class Action { Chase, Attack };
+
+        /// Whether the enemy chases the player or attacks them
+        Action action;
+
+        /// Unit vector of the direction in which a chasing enemy moves
+        sf::Vector2f direction;
+
+        /// Tells whether there were no obstacles between the enemy and the player
+        bool playerInSight;
+
+        /// The enemy has been hit recently, and thinks with urgency, until this tick
+        uint64_t hitUntilTick;
+    };
+
+    /// Attack that an enemy's behavior tree decided on this tick
+    enum class BehaviorAttack : uint8_t { None, Punch, Feint, Throw };
+
+    /// Gives the leaves of enemies' behavior trees their meaning, for a single enemy on a single tick
+    class EnemyBehavior;
+
+    /// How important it is for an enemy to think soon, the lower the more important
+    enum ThinkPriority : size_t
+    {
+        /// Enemy is close to the player, or has been hit recently
+        Urgent,
+        /// Enemy is on the screen
+        Normal,
+        /// Enemy is off the screen
+        Idle,
+
+        ThinkPrioritiesCount
+    };
+
+  private: /* functions */
+
+    /**
+     * Moves a fighter controlled by a player, and lets it punch or throw its fist
+     * 
+     * @param[in] fighter
+     *  The fighter to be controlled
+     * @param[in] input
+     *  Input of the fighter on this tick
+     * @param[in] lastInput
+     *  Input of the fighter on the previous tick, replaced by the current one
+     * @param[in] team
+     *  The side of the fighter, for its thrown fists
+     */
+    void ControlFighter(
+        Entity& fighter,
+        FighterInput const& input,
+        FighterInput& lastInput,
+        ProjectileSystem::Team team
+    );
+
+    /**
+     * Returns how detailed the update of an entity should be,
+     * full if it can be seen, and reduced otherwise
+     * 
+     * @param[in] entity
+     *  The entity to be updated
+     */
+    Entity::Detail GetDetail(Entity const& entity) const;
+
+    /**
+     * Makes an enemy decide what to do until its next think,
+     * based on where the player is
+     * 
+     * @param[in] handle
+     *  Handle of the enemy in the enemy pool
+     * 
+     * @return priority with which the enemy should think next,
+     *  or ThinkScheduler::DROP if the enemy no longer needs to think
+     */
+    size_t ThinkEnemy(ObjectPool<Entity>::Handle handle);
+
+    /**
+     * Carries out each enemy's last decision for this tick,
+     * moving it or letting it punch or throw its fist
+     */
+    void ActEnemies();
+
+    /**
+     * Lets the policy network decide what all enemies do on this tick, in a single batch,
+     * and carries out its decisions
+     */
+    void ActEnemiesByPolicy();
+
+    /**
+     * Ticks the behavior trees of all enemies, in parallel,
+     * and carries out the movements and attacks that they decided
+     */
+    void ActEnemiesByBehavior();
+
+    /**
+     * Starts an enemy's cooldown after an attack,
+     * shortened or lengthened by a random jitter
+     * 
+     * @param[in] enemy
+     *  The enemy that attacked
+     * @param[in] cooldown
+     *  Duration of the cooldown without the jitter, in ticks
+     */
+    void StartEnemyCooldown(Entity& enemy, int cooldown);
+
+    /**
+     * Throws a fist from an entity in the given direction,
+     * playing the entity's punch animation
+     * 
+     * @param[in] thrower
+     *  The entity that throws the fist
+     * @param[in] team
+     *  The side of the thrower
+     * @param[in] direction
+     *  Unit vector of the direction of the throw
+     */
+    void ThrowFist(Entity& thrower, ProjectileSystem::Team team, sf::Vector2f const& direction);
+
+    /**
+     * Spawns a new enemy, as a copy of the enemy prototype,
+     * in an entity taken from the enemy pool
+     * 
+     * @param[in] position
+     *  Initial position of the enemy
+     */
+    void SpawnEnemy(sf::Vector2f const& position);
+
+    /**
+     * Despawns an enemy, returning its entity to the enemy pool
+     * 
+     * @param[in] enemy
+     *  Pointer to the enemy, which has to be in the enemy pool
+     */
+    void DespawnEnemy(Entity* enemy);
+
+    /// Spawns the next wave of enemies along the edges of the arena
+    void SpawnWave();
+
+    /**
+     * Pushes overlapping enemies apart,
+     * so that a crowd of enemies chasing the player stays spread out
+     */
+    void SeparateEnemies();
+
+    /**
+     * Makes the nearest living enemy be the player's enemy,
+     * so that the player's fist points towards it and punches hit it
+     */
+    void TargetNearestEnemy();
+
+    /// Makes an enemy that got hit think with urgency for a while
+    void OnHit(Events::Hit const& event);
+
+    /// In survival mode despawns dead enemies and schedules the next wave
+    void OnDied(Events::Died const& event);
+
+  private: /* variables */
+
+    /// Size of the arena
+    sf::Vector2f _size;
+
+    /// Event bus carrying gameplay events from entities to the rest of the game
+    GameEventBus _eventBus;
+
+    /// Timer wheel for cooldowns and other actions scheduled for future ticks
+    TimerWheel _timerWheel;
+
+    /// The mode in which the match is played
+    GameMode _mode;
+
+    /// Static geometry of the arena where the fight takes place
+    Arena _arena;
+
+    /// Player's entity
+    Entity _player;
+
+    /* Entity that all enemies are copies of.
+       It is never updated or drawn, it only holds what enemies have in common */
+    Entity _enemyPrototype;
+
+    /// Pool of enemy entities, so that spawning and despawning enemies doesn't allocate
+    ObjectPool<Entity> _enemies;
+
+    /// Number of the current wave in survival mode
+    int _wave;
+
+    /// Indicates whether the next wave is scheduled to come
+    bool _waveTimerRunning;
+
+    /// Timer that spawns the next wave, valid while it is running
+    TimerWheel::TimerId _waveTimer;
+
+    /// Random generator of the match, used by the match and all entities
+    CounterRandom _random;
+
+    /// Gameplay parameters of the match, read by the match and all entities
+    GameplayParameters _parameters;
+
+    /// Spreads enemy decision making across ticks, within a time budget
+    ThinkScheduler<ObjectPool<Entity>::Handle> _thinkScheduler;
+
+    /// Maximum number of enemies that think on each tick, and the time they may take
+    size_t _maxThinksPerTick;
+    std::chrono::microseconds _thinkBudget;
+
+    /// Last decision of each enemy, indexed by the enemy's slot in the pool
+    std::vector<EnemyDecision> _enemyDecisions;
+
+    /// Fists thrown by the player and the enemies
+    ProjectileSystem _projectiles;
+
+    /// Area of the arena in which entities can be seen
+    sf::FloatRect _visibleArea;
+
+    /// Flow field guiding all enemies towards the player
+    FlowField _flowField;
+
+    /// Pool of worker threads for data-parallel loops
+    ThreadPool _threadPool;
+
+    /// Queue of changes that entities make to each other, applied once per tick
+    CommandQueue _commandQueue;
+
+    /// Separation step keeping enemies from overlapping each other
+    CrowdSeparation _crowdSeparation;
+
+    /// Positions of all enemies, gathered for the separation step
+    std::vector<float> _enemyXs;
+    std::vector<float> _enemyYs;
+
+    /// Input of the player on the last tick, to tell when buttons get pressed
+    FighterInput _lastPlayerInput;
+
+    /// Input of the player's opponent on the last tick, when it is another player
+    FighterInput _lastOpponentInput;
+
+    /// Policy network deciding what enemies do, or null for the hand-written rules
+    QuantizedMlp const* _enemyPolicy;
+
+    /// Memory of the policy network's batches, and the observations and actions of all enemies
+    std::unique_ptr<QuantizedMlp::Workspace> _policyWorkspace;
+    std::vector<float> _policyObservations;
+    std::vector<float> _policyActions;
+
+    /// Behavior tree deciding what enemies do, or null for the hand-written rules
+    BehaviorTree const* _enemyBehavior;
+
+    /// Blackboard of each enemy's behavior tree, and the movement and attack it decided on this tick
+    BehaviorTree::Blackboards _behaviorBlackboards;
+    std::vector<sf::Vector2f> _behaviorMoves;
+    std::vector<BehaviorAttack> _behaviorAttacks;
+
+    /// Scripts of the match, such as intros and combos
+    ScriptScheduler _scripts;
+
+    /// Tells for each enemy whether a script controls it, with the script's input on this tick and the last one
+    std::vector<uint8_t> _scriptedEnemies;
+    std::vector<FighterInput> _scriptInputs;
+    std::vector<FighterInput> _lastScriptInputs;
+
+    /// Performance counters of the last tick
+    Stats _stats;
+};
+
+} // namespace FaceFight
@@ -0,0 +1,178 @@
+#include "FlowField.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+namespace
+{
+
+/// Cost of a path that cannot reach the target
+uint32_t const UNREACHABLE = UINT32_MAX;
+
+/// Costs of moving to a side neighbour and to a diagonal neighbour
+uint32_t const STRAIGHT_COST = 10;
+uint32_t const DIAGONAL_COST = 14;
+
+/// Offsets of the 8 neighbours of a cell
+int const NEIGHBOUR_DX[8] = {1, -1, 0, 0, 1, 1, -1, -1};
+int const NEIGHBOUR_DY[8] = {0, 0, 1, -1, 1, -1, 1, -1};
+
+float const DIAGONAL = 0.70710678f;
+
+/// Unit vectors towards each of the 8 neighbours
+sf::Vector2f const NEIGHBOUR_DIRECTIONS[8] = {
+    {1.f, 0.f}, {-1.f, 0.f}, {0.f, 1.f}, {0.f, -1.f},
+    {DIAGONAL, DIAGONAL}, {DIAGONAL, -DIAGONAL}, {-DIAGONAL, DIAGONAL}, {-DIAGONAL, -DIAGONAL}
+};
+
+sf::Vector2f const NO_DIRECTION = {0.f, 0.f};
+
+} // namespace
+
+FlowField::FlowField(
+    sf::Vector2f const& size,
+    float cellSize)
+    : _cellSize(cellSize),
+    _columns(std::max(1, (int)std::ceil(size.x / cellSize))),
+    _rows(std::max(1, (int)std::ceil(size.y / cellSize))),
+    _blocked(_columns * _rows, false),
+    _costs(_columns * _rows, UNREACHABLE),
+    _directions(_columns * _rows, NO_DIRECTION),
+    _targetCell(-1),
+    _recomputeCount(0)
+{
+    // Each cell can be pushed once for each of its neighbours
+    _openCells.reserve(_columns * _rows * 8);
+}
+
+void FlowField::Block(sf::FloatRect const& rect)
+{
+    int const left = std::max(0, (int)std::floor(rect.left / _cellSize));
+    int const top = std::max(0, (int)std::floor(rect.top / _cellSize));
+    int const right = std::min(_columns - 1, (int)std::floor((rect.left + rect.width) / _cellSize));
+    int const bottom = std::min(_rows - 1, (int)std::floor((rect.top + rect.height) / _cellSize));
+    for (int y = top; y <= bottom; y++)
+    {
+        for (int x = left; x <= right; x++)
+        {
+            _blocked[y * _columns + x] = true;
+        }
+    }
+
+    // Blocking changes paths, so the field has to be recomputed for the current target
+    if (_targetCell >= 0)
+    {
+        Recompute();
+    }
+}
+
+void FlowField::SetTarget(sf::Vector2f const& target)
+{
+    int64_t const targetCell = GetCellIndex(target);
+    if (targetCell == _targetCell)
+    {
+        return;
+    }
+    _targetCell = targetCell;
+    Recompute();
+}
+
+sf::Vector2f const& FlowField::Sample(sf::Vector2f const& position) const
+{
+    return _directions[GetCellIndex(position)];
+}
+
+size_t FlowField::GetRecomputeCount() const
+{
+    return _recomputeCount;
+}
+
+size_t FlowField::GetCellIndex(sf::Vector2f const& position) const
+{
+    int const x = std::min(std::max(0, (int)std::floor(position.x / _cellSize)), _columns - 1);
+    int const y = std::min(std::max(0, (int)std::floor(position.y / _cellSize)), _rows - 1);
+    return y * _columns + x;
+}
+
+void FlowField::Recompute()
+{
+    _recomputeCount++;
+    std::fill(_costs.begin(), _costs.end(), UNREACHABLE);
+
+    // Dijkstra from the target cell outwards, over a min-heap of (cost, cell)
+    auto const greater = std::greater<std::pair<uint32_t, uint32_t>>();
+    _openCells.clear();
+    _costs[_targetCell] = 0;
+    _openCells.push_back({0, (uint32_t)_targetCell});
+
+    while (!_openCells.empty())
+    {
+        std::pop_heap(_openCells.begin(), _openCells.end(), greater);
+        auto const [cost, cell] = _openCells.back();
+        _openCells.pop_back();
+        if (cost > _costs[cell])
+        {
+            continue; // a shorter path to this cell has already been found
+        }
+
+        int const x = cell % _columns;
+        int const y = cell / _columns;
+        for (int n = 0; n < 8; n++)
+        {
+            int const nx = x + NEIGHBOUR_DX[n];
+            int const ny = y + NEIGHBOUR_DY[n];
+            if (nx < 0 || ny < 0 || nx >= _columns || ny >= _rows || _blocked[ny * _columns + nx])
+            {
+                continue;
+            }
+            // Don't cut corners of blocked cells when moving diagonally
+            if (n >= 4 && (_blocked[y * _columns + nx] || _blocked[ny * _columns + x]))
+            {
+                continue;
+            }
+            uint32_t const neighbour = ny * _columns + nx;
+            uint32_t const neighbourCost = cost + (n < 4 ? STRAIGHT_COST : DIAGONAL_COST);
+            if (neighbourCost < _costs[neighbour])
+            {
+                _costs[neighbour] = neighbourCost;
+                _openCells.push_back({neighbourCost, neighbour});
+                std::push_heap(_openCells.begin(), _openCells.end(), greater);
+            }
+        }
+    }
+
+    // Each cell points towards its cheapest neighbour
+    for (int y = 0; y < _rows; y++)
+    {
+        for (int x = 0; x < _columns; x++)
+        {
+            size_t const cell = y * _columns + x;
+            _directions[cell] = NO_DIRECTION;
+            if (_costs[cell] == 0 || _costs[cell] == UNREACHABLE)
+            {
+                continue;
+            }
+            uint32_t bestCost = _costs[cell];
+            for (int n = 0; n < 8; n++)
+            {
+                int const nx = x + NEIGHBOUR_DX[n];
+                int const ny = y + NEIGHBOUR_DY[n];
+                if (nx < 0 || ny < 0 || nx >= _columns || ny >= _rows)
+                {
+                    continue;
+                }
+                if (n >= 4 && (_blocked[y * _columns + nx] || _blocked[ny * _columns + x]))
+                {
+                    continue;
+                }
+                uint32_t const neighbourCost = _costs[ny * _columns + nx];
+                if (neighbourCost < bestCost)
+                {
+                    bestCost = neighbourCost;
+                    _directions[cell] = NEIGHBOUR_DIRECTIONS[n];
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+
+#include <vector>
+#include <cstdint>
+
+/**
+ * A class for a flow field over a uniform grid,
+ * guiding any number of agents towards a single shared target.
+ * 
+ * Each cell of the grid stores the direction in which an agent in that cell
+ * should move to reach the target on a shortest path around blocked cells.
+ * The field is recomputed only when the target moves into another cell,
+ * so agents that chase the same target only do a single lookup each tick,
+ * instead of each of them computing its own direction.
+ */
+class FlowField
+{
+
+  public:
+
+    /**
+     * Creates a flow field covering the given area, with no blocked cells
+     * 
+     * @param[in] size
+     *  Size of the area covered by the field, starting at (0, 0)
+     * @param[in] cellSize
+     *  Size of a single (square) cell of the grid
+     */
+    FlowField(
+        sf::Vector2f const& size,
+        float cellSize
+    );
+
+    /**
+     * Blocks all cells that overlap the given rectangle,
+     * so that agents are guided around it
+     * 
+     * @param[in] rect
+     *  Rectangle of an obstacle
+     */
+    void Block(sf::FloatRect const& rect);
+
+    /**
+     * Sets the target that agents are guided towards.
+     * The field is recomputed only if the target moved into another cell.
+     * 
+     * @param[in] target
+     *  Position of the target
+     */
+    void SetTarget(sf::Vector2f const& target);
+
+    /**
+     * Returns the direction in which an agent on the given position should move
+     * 
+     * @param[in] position
+     *  Position of the agent
+     * 
+     * @return unit vector of the direction,
+     *  or a zero vector if the agent is in the target's cell, or cannot reach it
+     */
+    sf::Vector2f const& Sample(sf::Vector2f const& position) const;
+
+    /**
+     * Returns the number of times the field has been recomputed
+     */
+    size_t GetRecomputeCount() const;
+
+  private: /* functions */
+
+    /// Returns the index of the cell containing the given position, clamped to the grid
+    size_t GetCellIndex(sf::Vector2f const& position) const;
+
+    /// Recomputes distances to the target cell and the directions of all cells
+    void Recompute();
+
+  private: /* variables */
+
+    /// Size of a single cell
+    float _cellSize;
+
+    /// Number of columns of the grid
+    int _columns;
+
+    /// Number of rows of the grid
+    int _rows;
+
+    /// Indicates for each cell whether it is blocked
+    std::vector<bool> _blocked;
+
+    /// Cost of the shortest path from each cell to the target cell
+    std::vector<uint32_t> _costs;
+
+    /// Direction in which to move from each cell
+    std::vector<sf::Vector2f> _directions;
+
+    /// Heap of cells to be visited while recomputing, kept to avoid allocating each time
+    std::vector<std::pair<uint32_t, uint32_t>> _openCells;
+
+    /// Index of the cell that contains the target, or -1 if there is no target yet
+    int64_t _targetCell;
+
+    /// Number of times the field has been recomputed
+    size_t _recomputeCount;
+};
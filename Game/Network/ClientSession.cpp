@@ -0,0 +1,149 @@
+#include "ClientSession.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+
+/// Marks the beginning of a packet from the client, and of a packet from the server
+uint32_t const CLIENT_PACKET_MAGIC = 0x46464E43; // "FFNC"
+uint32_t const SERVER_PACKET_MAGIC = 0x46464E53; // "FFNS"
+
+/// Size of a server's packet without its snapshot: magic, match token
+size_t const SERVER_PACKET_HEADER_SIZE = sizeof(uint32_t) + sizeof(uint64_t);
+
+} // namespace
+
+namespace FaceFight
+{
+
+ClientSession::ClientSession(
+    UdpChannel& channel,
+    uint64_t matchToken)
+    : _channel(channel),
+    _matchToken(matchToken),
+    _snapshots(SNAPSHOT_HISTORY),
+    _received(false),
+    _latestTick(0),
+    _shownTick(0.0),
+    _recentInputs{},
+    _inputsCount(0),
+    _packet(UdpChannel::MAX_PACKET_SIZE)
+{}
+
+void ClientSession::SendInput(FighterInput const& input)
+{
+    _recentInputs[_inputsCount % INPUTS_PER_PACKET] = input;
+    _inputsCount++;
+
+    uint64_t const firstInput = _inputsCount - std::min(_inputsCount, (uint64_t)INPUTS_PER_PACKET);
+    _packet.Clear();
+    _packet.Write(CLIENT_PACKET_MAGIC);
+    _packet.Write(_matchToken);
+    _packet.Write(_received ? _latestTick : NetSnapshot::NO_BASELINE);
+    _packet.Write(firstInput);
+    _packet.Write((uint32_t)(_inputsCount - firstInput));
+    for (uint64_t i = firstInput; i < _inputsCount; i++)
+    {
+        _packet.Write(_recentInputs[i % INPUTS_PER_PACKET]);
+    }
+    _channel.Send(_packet);
+}
+
+void ClientSession::Receive()
+{
+    while (_channel.Receive(_packet))
+    {
+        // Packets that aren't ours, or are cut short, are ignored
+        if (_packet.GetSize() < SERVER_PACKET_HEADER_SIZE + 2 * sizeof(uint32_t)
+            || _packet.Read<uint32_t>() != SERVER_PACKET_MAGIC)
+        {
+            continue;
+        }
+        if (_packet.Read<uint64_t>() != _matchToken)
+        {
+            throw "Error: The server is playing a different match.";
+        }
+        _channel.AcceptSender();
+
+        uint32_t tick = 0;
+        uint32_t baselineTick = 0;
+        NetSnapshot::ReadTicks(_packet, tick, baselineTick);
+
+        // Snapshots that come in late are of no use anymore
+        if (_received && tick <= _latestTick)
+        {
+            continue;
+        }
+        NetSnapshot const* baseline = nullptr;
+        if (baselineTick != NetSnapshot::NO_BASELINE)
+        {
+            baseline = FindSnapshot(baselineTick);
+            if (baseline == nullptr)
+            {
+                continue;
+            }
+        }
+
+        _snapshots[tick % SNAPSHOT_HISTORY].Read(_packet, tick, baseline);
+        _latestTick = tick;
+        if (!_received)
+        {
+            _shownTick = tick - INTERPOLATION_DELAY;
+            _received = true;
+        }
+    }
+}
+
+bool ClientSession::Interpolate(NetSnapshot const*& from, NetSnapshot const*& to, float& alpha)
+{
+    if (!_received)
+    {
+        return false;
+    }
+
+    // The shown moment moves a tick per frame, but can't drift too far from where it should be
+    double const target = _latestTick - INTERPOLATION_DELAY;
+    _shownTick += 1.0;
+    if (std::abs(_shownTick - target) > MAX_DRIFT)
+    {
+        _shownTick = target;
+    }
+    _shownTick = std::min(_shownTick, (double)_latestTick);
+
+    // Snapshots around the shown moment, some of which may have been lost
+    int64_t const shownTick = (int64_t)std::floor(_shownTick);
+    from = nullptr;
+    for (int64_t tick = shownTick; tick > shownTick - (int64_t)SNAPSHOT_HISTORY && from == nullptr; tick--)
+    {
+        from = FindSnapshot(tick);
+    }
+    to = nullptr;
+    for (int64_t tick = shownTick + 1; tick <= _latestTick && to == nullptr; tick++)
+    {
+        to = FindSnapshot(tick);
+    }
+
+    if (from == nullptr || to == nullptr)
+    {
+        from = (from != nullptr) ? from : to;
+        to = from;
+        alpha = 0.f;
+        return from != nullptr;
+    }
+    alpha = (float)((_shownTick - from->GetTick()) / (double)(to->GetTick() - from->GetTick()));
+    return true;
+}
+
+NetSnapshot const* ClientSession::FindSnapshot(int64_t tick) const
+{
+    if (tick < 0 || tick > _latestTick || _latestTick - tick >= (int64_t)SNAPSHOT_HISTORY)
+    {
+        return nullptr;
+    }
+    NetSnapshot const& snapshot = _snapshots[tick % SNAPSHOT_HISTORY];
+    return (snapshot.GetTick() == tick) ? &snapshot : nullptr;
+}
+
+} // namespace FaceFight
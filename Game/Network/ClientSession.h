@@ -0,0 +1,124 @@
+#pragma once
+
+#include "NetSnapshot.h"
+#include "UdpChannel.h"
+
+#include "../Input/FighterInput.hpp"
+#include "../Serialization/ByteBuffer.h"
+
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace FaceFight
+{
+
+/**
+ * A class for the client's side of a match whose simulation runs only on the server.
+ * 
+ * The client sends its input every frame, together with the last few ones,
+ * so an input lost on the way comes with the next packet.
+ * Each packet also acknowledges the latest snapshot received,
+ * which the server then writes the next snapshots against.
+ * 
+ * The match is shown a few ticks behind the latest snapshot,
+ * interpolated between the two snapshots around that moment,
+ * so it moves smoothly even if snapshots arrive unevenly or get lost.
+ */
+class ClientSession
+{
+
+  public:
+
+    /**
+     * Creates a session that contacts the server with its first input
+     * 
+     * @param[in] channel
+     *  Channel to the server, which has to outlive the session
+     * @param[in] matchToken
+     *  Value identifying the match, which has to be the same as the server's
+     */
+    ClientSession(
+        UdpChannel& channel,
+        uint64_t matchToken
+    );
+
+    /**
+     * Sends the input of the client's fighter on this frame
+     * 
+     * @param[in] input
+     *  Input of the client's player
+     */
+    void SendInput(FighterInput const& input);
+
+    /**
+     * Receives the snapshots that the server has sent
+     */
+    void Receive();
+
+    /**
+     * Moves the shown moment forward by a tick,
+     * and returns the snapshots between which it is
+     * 
+     * @param[out] from
+     *  The snapshot at or before the shown moment
+     * @param[out] to
+     *  The snapshot at or after the shown moment
+     * @param[out] alpha
+     *  Where the shown moment is between the two snapshots, between 0 and 1
+     * 
+     * @return false if no snapshot has been received yet
+     */
+    bool Interpolate(NetSnapshot const*& from, NetSnapshot const*& to, float& alpha);
+
+  private:
+
+    /// Number of recent snapshots kept, for interpolation and as baselines
+    static constexpr size_t SNAPSHOT_HISTORY = 32;
+
+    /// Number of inputs sent in each packet
+    static constexpr size_t INPUTS_PER_PACKET = 4;
+
+    /// Number of ticks by which the shown moment is behind the latest snapshot
+    static constexpr double INTERPOLATION_DELAY = 3.0;
+
+    /// If the shown moment drifts this many ticks from where it should be, it jumps there
+    static constexpr double MAX_DRIFT = 10.0;
+
+  private: /* functions */
+
+    /**
+     * Returns the kept snapshot of the given tick, or nullptr if it isn't kept
+     */
+    NetSnapshot const* FindSnapshot(int64_t tick) const;
+
+  private: /* variables */
+
+    /// Channel to the server
+    UdpChannel& _channel;
+
+    /// Value identifying the match
+    uint64_t _matchToken;
+
+    /// Recent snapshots in a ring, by tick
+    std::vector<NetSnapshot> _snapshots;
+
+    /// Tells us whether any snapshot has been received
+    bool _received;
+
+    /// Tick of the latest snapshot received
+    uint32_t _latestTick;
+
+    /// The shown moment, in ticks of the server
+    double _shownTick;
+
+    /// The last few inputs, in a ring, and the number of inputs given so far
+    std::array<FighterInput, INPUTS_PER_PACKET> _recentInputs;
+    uint64_t _inputsCount;
+
+    /// Buffer in which packets are written and received
+    ByteBuffer _packet;
+};
+
+} // namespace FaceFight
@@ -0,0 +1,288 @@
+#include "NetSnapshot.h"
+
+#include "../Serialization/BitReader.h"
+#include "../Serialization/BitWriter.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+
+/// Positions are quantized to this fraction of a pixel
+float const POSITION_SCALE = 8.f;
+
+/// Bits of a quantized position coordinate, and of a small change of one
+unsigned const POSITION_BITS = 16;
+unsigned const POSITION_DELTA_BITS = 10;
+
+/// Bits of a fist's quantized angle and distance
+unsigned const FIST_ANGLE_BITS = 8;
+unsigned const FIST_DIST_BITS = 8;
+
+/// Bits of health points, enough for the maximum health
+unsigned const HEALTH_BITS = 7;
+
+/// Bits of the IDs of fighters, and of the numbers of fighters and projectiles
+unsigned const ID_BITS = 16;
+unsigned const FIGHTERS_COUNT_BITS = 7;
+unsigned const PROJECTILES_COUNT_BITS = 8;
+
+float const PI = 3.14159265f;
+
+/// Returns a position coordinate quantized to POSITION_BITS
+uint16_t QuantizePosition(float coordinate)
+{
+    return (uint16_t)std::min(std::max(std::round(coordinate * POSITION_SCALE), 0.f), 65535.f);
+}
+
+/// Returns whether a change of a quantized coordinate fits in POSITION_DELTA_BITS
+bool IsSmallDelta(int delta)
+{
+    int const limit = 1 << (POSITION_DELTA_BITS - 1);
+    return delta >= -limit && delta < limit;
+}
+
+} // namespace
+
+namespace FaceFight
+{
+
+NetSnapshot::NetSnapshot()
+    : _tick(0),
+    _fightersCount(0),
+    _projectilesCount(0)
+{}
+
+void NetSnapshot::Clear(uint32_t tick)
+{
+    _tick = tick;
+    _fightersCount = 0;
+    _projectilesCount = 0;
+}
+
+bool NetSnapshot::AddFighter(
+    uint32_t id,
+    sf::Vector2f const& position,
+    sf::Vector2f const& fistOffset,
+    int health,
+    bool gettingPunched)
+{
+    if (_fightersCount == MAX_FIGHTERS)
+    {
+        return false;
+    }
+
+    float const fistAngle = std::atan2(fistOffset.y, fistOffset.x); // between -pi and pi
+    float const fistDist = std::sqrt(fistOffset.x * fistOffset.x + fistOffset.y * fistOffset.y);
+
+    Fighter& fighter = _fighters[_fightersCount++];
+    fighter.id = (uint16_t)id;
+    fighter.x = QuantizePosition(position.x);
+    fighter.y = QuantizePosition(position.y);
+    fighter.fistAngle = (uint8_t)((int)std::round(fistAngle / (2 * PI) * (1 << FIST_ANGLE_BITS))
+        & ((1 << FIST_ANGLE_BITS) - 1));
+    fighter.fistDist = (uint8_t)std::min(std::round(fistDist), (float)((1 << FIST_DIST_BITS) - 1));
+    fighter.health = (uint8_t)std::min(std::max(health, 0), (1 << HEALTH_BITS) - 1);
+    fighter.gettingPunched = gettingPunched;
+    return true;
+}
+
+bool NetSnapshot::AddProjectile(sf::Vector2f const& position)
+{
+    if (_projectilesCount == MAX_PROJECTILES)
+    {
+        return false;
+    }
+    _projectiles[_projectilesCount++] = {QuantizePosition(position.x), QuantizePosition(position.y)};
+    return true;
+}
+
+void NetSnapshot::Write(ByteBuffer& buffer, NetSnapshot const* baseline) const
+{
+    buffer.Write(_tick);
+    buffer.Write(baseline != nullptr ? baseline->_tick : NO_BASELINE);
+
+    BitWriter bits(buffer);
+    bits.Write(_fightersCount, FIGHTERS_COUNT_BITS);
+    for (size_t f = 0; f < _fightersCount; f++)
+    {
+        Fighter const& fighter = _fighters[f];
+        Fighter const* const base = (baseline != nullptr && f < baseline->_fightersCount
+            && baseline->_fighters[f].id == fighter.id) ? &baseline->_fighters[f] : nullptr;
+
+        bits.WriteFlag(base != nullptr);
+        if (base == nullptr)
+        {
+            // A fighter that the client hasn't seen in this place is written whole
+            bits.Write(fighter.id, ID_BITS);
+            bits.Write(fighter.x, POSITION_BITS);
+            bits.Write(fighter.y, POSITION_BITS);
+            bits.Write(fighter.fistAngle, FIST_ANGLE_BITS);
+            bits.Write(fighter.fistDist, FIST_DIST_BITS);
+            bits.Write(fighter.health, HEALTH_BITS);
+            bits.WriteFlag(fighter.gettingPunched);
+            continue;
+        }
+
+        // Otherwise only what changed is written, each change marked by a flag
+        int const deltaX = (int)fighter.x - base->x;
+        int const deltaY = (int)fighter.y - base->y;
+        bits.WriteFlag(deltaX != 0 || deltaY != 0);
+        if (deltaX != 0 || deltaY != 0)
+        {
+            bool const small = IsSmallDelta(deltaX) && IsSmallDelta(deltaY);
+            bits.WriteFlag(small);
+            if (small)
+            {
+                bits.Write((uint32_t)deltaX, POSITION_DELTA_BITS);
+                bits.Write((uint32_t)deltaY, POSITION_DELTA_BITS);
+            }
+            else
+            {
+                bits.Write(fighter.x, POSITION_BITS);
+                bits.Write(fighter.y, POSITION_BITS);
+            }
+        }
+
+        bool const fistChanged = fighter.fistAngle != base->fistAngle || fighter.fistDist != base->fistDist;
+        bits.WriteFlag(fistChanged);
+        if (fistChanged)
+        {
+            bits.Write(fighter.fistAngle, FIST_ANGLE_BITS);
+            bits.Write(fighter.fistDist, FIST_DIST_BITS);
+        }
+
+        bits.WriteFlag(fighter.health != base->health);
+        if (fighter.health != base->health)
+        {
+            bits.Write(fighter.health, HEALTH_BITS);
+        }
+
+        bits.WriteFlag(fighter.gettingPunched);
+    }
+
+    bits.Write(_projectilesCount, PROJECTILES_COUNT_BITS);
+    for (size_t p = 0; p < _projectilesCount; p++)
+    {
+        bits.Write(_projectiles[p].x, POSITION_BITS);
+        bits.Write(_projectiles[p].y, POSITION_BITS);
+    }
+    bits.Flush();
+}
+
+void NetSnapshot::ReadTicks(ByteBuffer& buffer, uint32_t& tick, uint32_t& baselineTick)
+{
+    tick = buffer.Read<uint32_t>();
+    baselineTick = buffer.Read<uint32_t>();
+}
+
+void NetSnapshot::Read(ByteBuffer& buffer, uint32_t tick, NetSnapshot const* baseline)
+{
+    _tick = tick;
+
+    BitReader bits(buffer);
+    _fightersCount = std::min((size_t)bits.Read(FIGHTERS_COUNT_BITS), MAX_FIGHTERS);
+    for (size_t f = 0; f < _fightersCount; f++)
+    {
+        Fighter& fighter = _fighters[f];
+        if (!bits.ReadFlag())
+        {
+            fighter.id = bits.Read(ID_BITS);
+            fighter.x = bits.Read(POSITION_BITS);
+            fighter.y = bits.Read(POSITION_BITS);
+            fighter.fistAngle = bits.Read(FIST_ANGLE_BITS);
+            fighter.fistDist = bits.Read(FIST_DIST_BITS);
+            fighter.health = bits.Read(HEALTH_BITS);
+            fighter.gettingPunched = bits.ReadFlag();
+            continue;
+        }
+
+        if (baseline == nullptr || f >= baseline->_fightersCount)
+        {
+            throw "Error: Snapshot refers to a fighter missing from its baseline.";
+        }
+        fighter = baseline->_fighters[f];
+
+        if (bits.ReadFlag())
+        {
+            if (bits.ReadFlag())
+            {
+                // Small changes are sign extended from their bits
+                int const shift = 32 - POSITION_DELTA_BITS;
+                fighter.x += (int32_t)(bits.Read(POSITION_DELTA_BITS) << shift) >> shift;
+                fighter.y += (int32_t)(bits.Read(POSITION_DELTA_BITS) << shift) >> shift;
+            }
+            else
+            {
+                fighter.x = bits.Read(POSITION_BITS);
+                fighter.y = bits.Read(POSITION_BITS);
+            }
+        }
+        if (bits.ReadFlag())
+        {
+            fighter.fistAngle = bits.Read(FIST_ANGLE_BITS);
+            fighter.fistDist = bits.Read(FIST_DIST_BITS);
+        }
+        if (bits.ReadFlag())
+        {
+            fighter.health = bits.Read(HEALTH_BITS);
+        }
+        fighter.gettingPunched = bits.ReadFlag();
+    }
+
+    _projectilesCount = bits.Read(PROJECTILES_COUNT_BITS);
+    for (size_t p = 0; p < _projectilesCount; p++)
+    {
+        _projectiles[p].x = bits.Read(POSITION_BITS);
+        _projectiles[p].y = bits.Read(POSITION_BITS);
+    }
+}
+
+uint32_t NetSnapshot::GetTick() const
+{
+    return _tick;
+}
+
+size_t NetSnapshot::GetFightersCount() const
+{
+    return _fightersCount;
+}
+
+uint32_t NetSnapshot::GetFighterId(size_t f) const
+{
+    return _fighters[f].id;
+}
+
+sf::Vector2f NetSnapshot::GetFighterPosition(size_t f) const
+{
+    return sf::Vector2f(_fighters[f].x, _fighters[f].y) / POSITION_SCALE;
+}
+
+sf::Vector2f NetSnapshot::GetFistOffset(size_t f) const
+{
+    float const angle = _fighters[f].fistAngle * (2 * PI) / (1 << FIST_ANGLE_BITS);
+    return sf::Vector2f(std::cos(angle), std::sin(angle)) * (float)_fighters[f].fistDist;
+}
+
+int NetSnapshot::GetHealth(size_t f) const
+{
+    return _fighters[f].health;
+}
+
+bool NetSnapshot::IsGettingPunched(size_t f) const
+{
+    return _fighters[f].gettingPunched;
+}
+
+size_t NetSnapshot::GetProjectilesCount() const
+{
+    return _projectilesCount;
+}
+
+sf::Vector2f NetSnapshot::GetProjectilePosition(size_t p) const
+{
+    return sf::Vector2f(_projectiles[p].x, _projectiles[p].y) / POSITION_SCALE;
+}
+
+} // namespace FaceFight
@@ -0,0 +1,192 @@
+#pragma once
+
+#include "../Serialization/ByteBuffer.h"
+
+#include <SFML/System/Vector2.hpp>
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+namespace FaceFight
+{
+
+/**
+ * A class for what clients see of the match on a single tick,
+ * as the server sends it to them.
+ * 
+ * Values are quantized to as few bits as they need to be drawn:
+ * positions to an eighth of a pixel, fists to an angle and a distance,
+ * and health to the bits that hold its maximum.
+ * 
+ * A snapshot is written as the difference from a baseline,
+ * an earlier snapshot that the client has acknowledged,
+ * so only the fields of fighters that changed are sent, bit-packed.
+ * Projectiles move on every tick, so they are always sent whole.
+ * 
+ * Snapshots have a fixed capacity, so they can be kept in rings without allocating.
+ */
+class NetSnapshot
+{
+
+  public:
+
+    /// Maximum number of fighters and projectiles in a snapshot
+    static constexpr size_t MAX_FIGHTERS = 64;
+    static constexpr size_t MAX_PROJECTILES = 255;
+
+    /// Tick used in place of no baseline, when a snapshot is written whole
+    static constexpr uint32_t NO_BASELINE = UINT32_MAX;
+
+  public:
+
+    /**
+     * Creates an empty snapshot of tick 0
+     */
+    NetSnapshot();
+
+    /**
+     * Empties the snapshot, so that it can be filled for a new tick
+     * 
+     * @param[in] tick
+     *  Tick of the match that the snapshot shows
+     */
+    void Clear(uint32_t tick);
+
+    /**
+     * Adds a fighter to the snapshot.
+     * Fighters should be added in the same order on every tick,
+     * since each fighter is compared to the one in the same place of the baseline.
+     * 
+     * @param[in] id
+     *  ID of the fighter's entity
+     * @param[in] position
+     *  Position of the fighter
+     * @param[in] fistOffset
+     *  Position of the fighter's fist, relative to the fighter
+     * @param[in] health
+     *  Health points of the fighter
+     * @param[in] gettingPunched
+     *  Whether the fighter is getting punched
+     * 
+     * @return false if the snapshot has no room for another fighter
+     */
+    bool AddFighter(
+        uint32_t id,
+        sf::Vector2f const& position,
+        sf::Vector2f const& fistOffset,
+        int health,
+        bool gettingPunched
+    );
+
+    /**
+     * Adds a projectile to the snapshot
+     * 
+     * @param[in] position
+     *  Position of the projectile's center
+     * 
+     * @return false if the snapshot has no room for another projectile
+     */
+    bool AddProjectile(sf::Vector2f const& position);
+
+    /**
+     * Writes the snapshot to a buffer, as the difference from a baseline
+     * 
+     * @param[in] buffer
+     *  Buffer to which the snapshot is written
+     * @param[in] baseline
+     *  Snapshot that the reader already has, or nullptr to write the snapshot whole
+     */
+    void Write(ByteBuffer& buffer, NetSnapshot const* baseline) const;
+
+    /**
+     * Reads the tick of a snapshot, and the tick of its baseline,
+     * without reading the snapshot itself, so the baseline can be found.
+     * The buffer is left where the snapshot begins.
+     * 
+     * @param[in] buffer
+     *  Buffer from which the ticks are read
+     * @param[out] tick
+     *  Tick of the snapshot
+     * @param[out] baselineTick
+     *  Tick of the baseline, or NO_BASELINE
+     */
+    static void ReadTicks(ByteBuffer& buffer, uint32_t& tick, uint32_t& baselineTick);
+
+    /**
+     * Reads a snapshot written by Write() from a buffer, replacing this snapshot
+     * 
+     * @param[in] buffer
+     *  Buffer from which the snapshot is read, left where ReadTicks() left it
+     * @param[in] tick
+     *  Tick of the snapshot, as returned by ReadTicks()
+     * @param[in] baseline
+     *  The snapshot it was written against, or nullptr if it was written whole
+     */
+    void Read(ByteBuffer& buffer, uint32_t tick, NetSnapshot const* baseline);
+
+    /**
+     * Returns the tick of the match that the snapshot shows
+     */
+    uint32_t GetTick() const;
+
+    /**
+     * Returns the number of fighters in the snapshot
+     */
+    size_t GetFightersCount() const;
+
+    /**
+     * Return what the snapshot shows of the fighter with the given index
+     */
+    uint32_t GetFighterId(size_t f) const;
+    sf::Vector2f GetFighterPosition(size_t f) const;
+    sf::Vector2f GetFistOffset(size_t f) const;
+    int GetHealth(size_t f) const;
+    bool IsGettingPunched(size_t f) const;
+
+    /**
+     * Returns the number of projectiles in the snapshot
+     */
+    size_t GetProjectilesCount() const;
+
+    /**
+     * Returns the position of the projectile with the given index
+     */
+    sf::Vector2f GetProjectilePosition(size_t p) const;
+
+  private:
+
+    /// A fighter, with its values quantized
+    struct Fighter
+    {
+        uint16_t id;
+        uint16_t x;
+        uint16_t y;
+        uint8_t fistAngle;
+        uint8_t fistDist;
+        uint8_t health;
+        bool gettingPunched;
+    };
+
+    /// A projectile, with its position quantized
+    struct Projectile
+    {
+        uint16_t x;
+        uint16_t y;
+    };
+
+  private: /* variables */
+
+    /// Tick of the match that the snapshot shows
+    uint32_t _tick;
+
+    /// Fighters in the snapshot, of which the first few are in use
+    std::array<Fighter, MAX_FIGHTERS> _fighters;
+    size_t _fightersCount;
+
+    /// Projectiles in the snapshot, of which the first few are in use
+    std::array<Projectile, MAX_PROJECTILES> _projectiles;
+    size_t _projectilesCount;
+};
+
+} // namespace FaceFight
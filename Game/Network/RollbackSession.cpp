@@ -0,0 +1,168 @@
+#include "RollbackSession.h"
+
+#include <algorithm>
+
+namespace
+{
+
+/// Marks the beginning of a packet of the session
+uint32_t const PACKET_MAGIC = 0x46464E50; // "FFNP"
+
+/// Size of a packet without its inputs: magic, match token, acknowledged inputs, first tick, inputs count
+size_t const PACKET_HEADER_SIZE = sizeof(uint32_t) + 3 * sizeof(uint64_t) + sizeof(uint32_t);
+
+} // namespace
+
+namespace FaceFight
+{
+
+RollbackSession::RollbackSession(
+    UdpChannel& channel,
+    size_t localSide,
+    uint64_t matchToken,
+    Inputs const& initialInputs,
+    size_t snapshotCapacity)
+    : _channel(channel),
+    _localSide(localSide),
+    _remoteSide(1 - localSide),
+    _matchToken(matchToken),
+    _initialInputs(initialInputs),
+    _synchronized(false),
+    _tick(0),
+    _localInputsCount(INPUT_DELAY),
+    _remoteInputsCount(0),
+    _localAckedCount(0),
+    _rollbackTick(NO_ROLLBACK),
+    _packet(UdpChannel::MAX_PACKET_SIZE),
+    _rollbackTicks(0)
+{
+    if (localSide >= SIDES)
+    {
+        throw "Error: A rollback session has only two sides.";
+    }
+    for (std::vector<FighterInput>& inputs : _inputs)
+    {
+        inputs.resize(INPUT_HISTORY);
+    }
+    // The first local inputs are the initial ones, until the first real input comes in after the delay
+    for (size_t tick = 0; tick < INPUT_DELAY; tick++)
+    {
+        _inputs[_localSide][tick] = _initialInputs[_localSide];
+    }
+    // A state is saved for each tick that can be rolled back to, and for the next tick
+    for (size_t s = 0; s < MAX_ROLLBACK + 1; s++)
+    {
+        _snapshots.emplace_back(new ByteBuffer(snapshotCapacity));
+    }
+}
+
+bool RollbackSession::IsSynchronized() const
+{
+    return _synchronized;
+}
+
+uint64_t RollbackSession::GetTick() const
+{
+    return _tick;
+}
+
+size_t RollbackSession::GetRollbackTicks() const
+{
+    return _rollbackTicks;
+}
+
+void RollbackSession::SendInputs()
+{
+    uint32_t const maxCount = (UdpChannel::MAX_PACKET_SIZE - PACKET_HEADER_SIZE) / sizeof(FighterInput);
+    uint32_t const count = std::min((uint64_t)maxCount, _localInputsCount - _localAckedCount);
+
+    _packet.Clear();
+    _packet.Write(PACKET_MAGIC);
+    _packet.Write(_matchToken);
+    _packet.Write(_remoteInputsCount);
+    _packet.Write(_localAckedCount);
+    _packet.Write(count);
+    for (uint64_t tick = _localAckedCount; tick < _localAckedCount + count; tick++)
+    {
+        _packet.Write(_inputs[_localSide][tick % INPUT_HISTORY]);
+    }
+    _channel.Send(_packet);
+}
+
+void RollbackSession::ReceivePackets()
+{
+    while (_channel.Receive(_packet))
+    {
+        // Packets that aren't ours, or are cut short, are ignored
+        if (_packet.GetSize() < PACKET_HEADER_SIZE || _packet.Read<uint32_t>() != PACKET_MAGIC)
+        {
+            continue;
+        }
+        if (_packet.Read<uint64_t>() != _matchToken)
+        {
+            throw "Error: The peer is playing a different match.";
+        }
+        _channel.AcceptSender();
+        _synchronized = true;
+
+        _localAckedCount = std::max(_localAckedCount, _packet.Read<uint64_t>());
+        uint64_t const firstTick = _packet.Read<uint64_t>();
+        uint32_t const count = _packet.Read<uint32_t>();
+        if (_packet.GetSize() != PACKET_HEADER_SIZE + count * sizeof(FighterInput))
+        {
+            continue;
+        }
+
+        // Remote inputs are taken in order, up to where the ring still holds what is needed
+        uint64_t const oldestNeeded = _tick - std::min(_tick, (uint64_t)MAX_ROLLBACK);
+        for (uint64_t tick = firstTick; tick < firstTick + count; tick++)
+        {
+            FighterInput const input = _packet.Read<FighterInput>();
+            if (tick < _remoteInputsCount)
+            {
+                continue;
+            }
+            if (tick > _remoteInputsCount || tick >= oldestNeeded + INPUT_HISTORY)
+            {
+                break;
+            }
+
+            FighterInput& used = _inputs[_remoteSide][tick % INPUT_HISTORY];
+            if (tick < _tick && used != input)
+            {
+                _rollbackTick = std::min(_rollbackTick, tick);
+            }
+            used = input;
+            _remoteInputsCount++;
+        }
+    }
+}
+
+bool RollbackSession::CanTakeLocalInput() const
+{
+    return _localInputsCount <= _tick + INPUT_DELAY
+        && _localInputsCount < _localAckedCount + INPUT_HISTORY;
+}
+
+bool RollbackSession::CanSimulateNextTick() const
+{
+    return _tick < _localInputsCount && _tick < _remoteInputsCount + MAX_ROLLBACK;
+}
+
+RollbackSession::Inputs RollbackSession::GetInputs(uint64_t tick)
+{
+    if (tick >= _remoteInputsCount)
+    {
+        // The remote player is predicted to keep doing what they did last
+        _inputs[_remoteSide][tick % INPUT_HISTORY] = _remoteInputsCount > 0
+            ? _inputs[_remoteSide][(_remoteInputsCount - 1) % INPUT_HISTORY]
+            : _initialInputs[_remoteSide];
+    }
+
+    Inputs inputs;
+    inputs[_localSide] = _inputs[_localSide][tick % INPUT_HISTORY];
+    inputs[_remoteSide] = _inputs[_remoteSide][tick % INPUT_HISTORY];
+    return inputs;
+}
+
+} // namespace FaceFight
@@ -0,0 +1,250 @@
+#pragma once
+
+#include "UdpChannel.h"
+
+#include "../Input/FighterInput.hpp"
+#include "../Serialization/ByteBuffer.h"
+
+#include <array>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace FaceFight
+{
+
+/**
+ * A class for a match of two players on two machines, kept in sync with rollback.
+ * 
+ * Both machines simulate the whole match, and only exchange the fighters' inputs.
+ * Each tick the local input is sent to the peer, a few ticks ahead of when it is used,
+ * and the simulation goes on right away, predicting that the remote player
+ * keeps doing what they did on the last tick whose input has arrived.
+ * 
+ * The state before each tick is saved. When a remote input arrives
+ * that differs from what was predicted for its tick,
+ * the state of that tick is restored, and the ticks since then are simulated again,
+ * all within a single frame, so the mistake is corrected before it is drawn.
+ * The simulation waits instead of going further ahead than it can roll back.
+ * 
+ * Inputs are sent again in every packet until the peer acknowledges them,
+ * so lost packets are made up for by the next ones.
+ */
+class RollbackSession
+{
+
+  public:
+
+    /// Number of sides in a match, side 0 plays the first fighter and side 1 the second one
+    static constexpr size_t SIDES = 2;
+
+    /// Inputs of both sides on a tick
+    using Inputs = std::array<FighterInput, SIDES>;
+
+  public:
+
+    /**
+     * Creates a session that starts at tick 0, once it is in contact with the peer
+     * 
+     * @param[in] channel
+     *  Channel to the peer, which has to outlive the session
+     * @param[in] localSide
+     *  Side played on this machine, the peer has to play the other one
+     * @param[in] matchToken
+     *  Value identifying the match, such as its seed and settings.
+     *  Peers with different tokens refuse to play with each other.
+     * @param[in] initialInputs
+     *  Inputs of both sides before they have given any,
+     *  in which the fighters stay where they begin
+     * @param[in] snapshotCapacity
+     *  Maximum size of a saved state of the simulation, in bytes
+     */
+    RollbackSession(
+        UdpChannel& channel,
+        size_t localSide,
+        uint64_t matchToken,
+        Inputs const& initialInputs,
+        size_t snapshotCapacity
+    );
+
+    /**
+     * Exchanges inputs with the peer, rolls back if a prediction was wrong,
+     * and simulates the next tick if the peer isn't too far behind.
+     * 
+     * This function is supposed to be called once each frame.
+     * 
+     * @param[in] localInput
+     *  Input of the local player on this frame
+     * @param[in] save
+     *  Function taking in a ByteBuffer, which saves the simulation's state to it
+     * @param[in] load
+     *  Function taking in a ByteBuffer, which restores the simulation's state from it
+     * @param[in] simulate
+     *  Function taking in the inputs of a tick, and whether the tick is simulated again,
+     *  which advances the simulation by that tick
+     * 
+     * @return number of ticks simulated, counting the ones simulated again
+     */
+    template <class Save, class Load, class Simulate>
+    size_t Advance(
+        FighterInput const& localInput,
+        Save const& save,
+        Load const& load,
+        Simulate const& simulate
+    );
+
+    /**
+     * Checks if the peer has been contacted, and the match has begun
+     */
+    bool IsSynchronized() const;
+
+    /**
+     * Returns the next tick to be simulated
+     */
+    uint64_t GetTick() const;
+
+    /**
+     * Returns the number of ticks simulated again in the last call to Advance()
+     */
+    size_t GetRollbackTicks() const;
+
+  private:
+
+    /// Maximum number of ticks that can be simulated again, in a single rollback
+    static constexpr size_t MAX_ROLLBACK = 8;
+
+    /// Number of ticks for which the local input is sent ahead of its use
+    static constexpr size_t INPUT_DELAY = 2;
+
+    /// Number of ticks for which inputs of each side are kept
+    static constexpr size_t INPUT_HISTORY = 64;
+
+    /// Tick used in place of no tick to roll back to
+    static constexpr uint64_t NO_ROLLBACK = UINT64_MAX;
+
+  private: /* functions */
+
+    /// Sends the local inputs that the peer hasn't acknowledged yet
+    void SendInputs();
+
+    /// Receives all packets that have arrived, and the remote inputs in them
+    void ReceivePackets();
+
+    /**
+     * Checks if the local input of this frame can be taken,
+     * which it can't while the simulation waits for the peer
+     */
+    bool CanTakeLocalInput() const;
+
+    /**
+     * Checks if the next tick can be simulated,
+     * without going further ahead of the peer than can be rolled back
+     */
+    bool CanSimulateNextTick() const;
+
+    /**
+     * Returns the inputs of both sides on the given tick.
+     * A missing remote input is predicted, and remembered as the input used on the tick.
+     */
+    Inputs GetInputs(uint64_t tick);
+
+  private: /* variables */
+
+    /// Channel to the peer
+    UdpChannel& _channel;
+
+    /// Side played on this machine, and the one played by the peer
+    size_t _localSide;
+    size_t _remoteSide;
+
+    /// Value identifying the match
+    uint64_t _matchToken;
+
+    /// Inputs of both sides before they have given any
+    Inputs _initialInputs;
+
+    /// Tells us whether the peer has been contacted
+    bool _synchronized;
+
+    /// The next tick to be simulated
+    uint64_t _tick;
+
+    /// Number of ticks with a local input, and with a remote input that has arrived
+    uint64_t _localInputsCount;
+    uint64_t _remoteInputsCount;
+
+    /// Number of local inputs that the peer has acknowledged
+    uint64_t _localAckedCount;
+
+    /// The earliest tick whose remote input was predicted wrong, or NO_ROLLBACK
+    uint64_t _rollbackTick;
+
+    /* Inputs of each side in a ring, by tick.
+       Remote inputs that haven't arrived hold what was predicted for the tick */
+    std::array<std::vector<FighterInput>, SIDES> _inputs;
+
+    /// Saved states of the simulation in a ring, by tick, each saved just before the tick
+    std::vector<std::unique_ptr<ByteBuffer>> _snapshots;
+
+    /// Buffer in which packets are written and received
+    ByteBuffer _packet;
+
+    /// Number of ticks simulated again in the last call to Advance()
+    size_t _rollbackTicks;
+};
+
+template <class Save, class Load, class Simulate>
+size_t RollbackSession::Advance(
+    FighterInput const& localInput,
+    Save const& save,
+    Load const& load,
+    Simulate const& simulate)
+{
+    _rollbackTicks = 0;
+    ReceivePackets();
+    if (!_synchronized)
+    {
+        // Packets are sent until the peer answers, and the peer starts at tick 0 too
+        SendInputs();
+        return 0;
+    }
+
+    if (CanTakeLocalInput())
+    {
+        _inputs[_localSide][_localInputsCount % INPUT_HISTORY] = localInput;
+        _localInputsCount++;
+    }
+    SendInputs();
+
+    size_t ticks = 0;
+    if (_rollbackTick < _tick)
+    {
+        ByteBuffer& rollbackSnapshot = *_snapshots[_rollbackTick % _snapshots.size()];
+        rollbackSnapshot.Rewind();
+        load(rollbackSnapshot);
+        for (uint64_t tick = _rollbackTick; tick < _tick; tick++)
+        {
+            ByteBuffer& snapshot = *_snapshots[tick % _snapshots.size()];
+            snapshot.Clear();
+            save(snapshot);
+            simulate(GetInputs(tick), true);
+            ticks++;
+        }
+        _rollbackTicks = ticks;
+    }
+    _rollbackTick = NO_ROLLBACK;
+
+    if (CanSimulateNextTick())
+    {
+        ByteBuffer& snapshot = *_snapshots[_tick % _snapshots.size()];
+        snapshot.Clear();
+        save(snapshot);
+        simulate(GetInputs(_tick), false);
+        _tick++;
+        ticks++;
+    }
+    return ticks;
+}
+
+} // namespace FaceFight
@@ -0,0 +1,131 @@
+#include "ServerSession.h"
+
+#include <algorithm>
+
+namespace
+{
+
+/// Marks the beginning of a packet from the client, and of a packet from the server
+uint32_t const CLIENT_PACKET_MAGIC = 0x46464E43; // "FFNC"
+uint32_t const SERVER_PACKET_MAGIC = 0x46464E53; // "FFNS"
+
+/// Size of a client's packet without its inputs: magic, match token, acknowledged tick, first input, inputs count
+size_t const CLIENT_PACKET_HEADER_SIZE = 3 * sizeof(uint32_t) + 2 * sizeof(uint64_t);
+
+} // namespace
+
+namespace FaceFight
+{
+
+ServerSession::ServerSession(
+    UdpChannel& channel,
+    uint64_t matchToken,
+    FighterInput const& initialInput)
+    : _channel(channel),
+    _matchToken(matchToken),
+    _connected(false),
+    _snapshots(SNAPSHOT_HISTORY),
+    _ackedTick(NetSnapshot::NO_BASELINE),
+    _inputs(INPUT_HISTORY),
+    _receivedInputsCount(0),
+    _usedInputsCount(0),
+    _lastInput(initialInput),
+    _packet(UdpChannel::MAX_PACKET_SIZE)
+{}
+
+void ServerSession::Receive()
+{
+    while (_channel.Receive(_packet))
+    {
+        /* Packets that aren't ours, or are cut short, are ignored,
+           and so are clients of a different match, which mustn't bring the server down */
+        if (_packet.GetSize() < CLIENT_PACKET_HEADER_SIZE || _packet.Read<uint32_t>() != CLIENT_PACKET_MAGIC
+            || _packet.Read<uint64_t>() != _matchToken)
+        {
+            continue;
+        }
+        // Only a client of this match takes the side
+        _channel.AcceptSender();
+        _connected = true;
+
+        // Acknowledgements may come out of order, only the latest one counts
+        uint32_t const ackedTick = _packet.Read<uint32_t>();
+        if (ackedTick != NetSnapshot::NO_BASELINE
+            && (_ackedTick == NetSnapshot::NO_BASELINE || ackedTick > _ackedTick))
+        {
+            _ackedTick = ackedTick;
+        }
+
+        uint64_t const firstInput = _packet.Read<uint64_t>();
+        uint32_t const count = _packet.Read<uint32_t>();
+        if (_packet.GetSize() != CLIENT_PACKET_HEADER_SIZE + count * sizeof(FighterInput))
+        {
+            continue;
+        }
+        for (uint64_t i = firstInput; i < firstInput + count; i++)
+        {
+            FighterInput const input = _packet.Read<FighterInput>();
+            if (i < _receivedInputsCount)
+            {
+                continue;
+            }
+            // Inputs lost for good are made up for by repeating the previous one
+            for (uint64_t missing = std::max(_receivedInputsCount, i + 1 - std::min(i + 1, (uint64_t)INPUT_HISTORY));
+                missing < i; missing++)
+            {
+                _inputs[missing % INPUT_HISTORY] = _receivedInputsCount > 0
+                    ? _inputs[(_receivedInputsCount - 1) % INPUT_HISTORY]
+                    : _lastInput;
+            }
+            _inputs[i % INPUT_HISTORY] = input;
+            _receivedInputsCount = i + 1;
+        }
+    }
+}
+
+bool ServerSession::IsConnected() const
+{
+    return _connected;
+}
+
+FighterInput ServerSession::TakeInput()
+{
+    // If inputs pile up, the oldest ones are skipped, so the client's fighter catches up
+    if (_receivedInputsCount - _usedInputsCount > MAX_INPUT_BACKLOG)
+    {
+        _usedInputsCount = _receivedInputsCount - MAX_INPUT_BACKLOG;
+    }
+    if (_usedInputsCount < _receivedInputsCount)
+    {
+        _lastInput = _inputs[_usedInputsCount % INPUT_HISTORY];
+        _usedInputsCount++;
+    }
+    return _lastInput;
+}
+
+void ServerSession::SendSnapshot(NetSnapshot const& snapshot)
+{
+    NetSnapshot& kept = _snapshots[snapshot.GetTick() % SNAPSHOT_HISTORY];
+    kept = snapshot;
+    if (!_connected)
+    {
+        return;
+    }
+
+    // The acknowledged snapshot is the baseline, as long as it is still kept
+    NetSnapshot const* baseline = nullptr;
+    if (_ackedTick != NetSnapshot::NO_BASELINE && _ackedTick < snapshot.GetTick()
+        && snapshot.GetTick() - _ackedTick < SNAPSHOT_HISTORY
+        && _snapshots[_ackedTick % SNAPSHOT_HISTORY].GetTick() == _ackedTick)
+    {
+        baseline = &_snapshots[_ackedTick % SNAPSHOT_HISTORY];
+    }
+
+    _packet.Clear();
+    _packet.Write(SERVER_PACKET_MAGIC);
+    _packet.Write(_matchToken);
+    kept.Write(_packet, baseline);
+    _channel.Send(_packet);
+}
+
+} // namespace FaceFight
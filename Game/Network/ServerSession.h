@@ -0,0 +1,112 @@
+#pragma once
+
+#include "NetSnapshot.h"
+#include "UdpChannel.h"
+
+#include "../Input/FighterInput.hpp"
+#include "../Serialization/ByteBuffer.h"
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace FaceFight
+{
+
+/**
+ * A class for the server's side of a match whose simulation runs only on the server.
+ * 
+ * The client sends its inputs, and the server uses them one per tick, in order.
+ * Inputs that come in too late to be used are skipped, so the client's fighter doesn't lag behind.
+ * After each tick the server sends what the client sees, as a snapshot,
+ * written as the difference from the last snapshot that the client has acknowledged.
+ * Recent snapshots are kept in a ring, so they can serve as baselines.
+ */
+class ServerSession
+{
+
+  public:
+
+    /**
+     * Creates a session waiting for the client
+     * 
+     * @param[in] channel
+     *  Channel to the client, which has to outlive the session
+     * @param[in] matchToken
+     *  Value identifying the match, packets of clients with a different token are ignored
+     * @param[in] initialInput
+     *  Input of the client's fighter until the client gives any
+     */
+    ServerSession(
+        UdpChannel& channel,
+        uint64_t matchToken,
+        FighterInput const& initialInput
+    );
+
+    /**
+     * Receives the inputs and acknowledgements that the client has sent
+     */
+    void Receive();
+
+    /**
+     * Checks if the client has contacted the server
+     */
+    bool IsConnected() const;
+
+    /**
+     * Returns the client's input for the next tick,
+     * or repeats the last one if no new input has arrived
+     */
+    FighterInput TakeInput();
+
+    /**
+     * Sends the snapshot of a tick to the client, and keeps it as a future baseline
+     * 
+     * @param[in] snapshot
+     *  Snapshot of the tick that was just simulated
+     */
+    void SendSnapshot(NetSnapshot const& snapshot);
+
+  private:
+
+    /// Number of recent snapshots kept as baselines
+    static constexpr size_t SNAPSHOT_HISTORY = 32;
+
+    /// Number of received inputs kept until they are used
+    static constexpr size_t INPUT_HISTORY = 16;
+
+    /// Maximum number of inputs waiting to be used, older ones are skipped
+    static constexpr uint64_t MAX_INPUT_BACKLOG = 4;
+
+  private: /* variables */
+
+    /// Channel to the client
+    UdpChannel& _channel;
+
+    /// Value identifying the match
+    uint64_t _matchToken;
+
+    /// Tells us whether the client has contacted the server
+    bool _connected;
+
+    /// Recent snapshots in a ring, by tick
+    std::vector<NetSnapshot> _snapshots;
+
+    /// Tick of the latest snapshot that the client has acknowledged, or NetSnapshot::NO_BASELINE
+    uint32_t _ackedTick;
+
+    /// Received inputs in a ring, by their number
+    std::vector<FighterInput> _inputs;
+
+    /// Number of inputs received, and of inputs used
+    uint64_t _receivedInputsCount;
+    uint64_t _usedInputsCount;
+
+    /// The input used on the last tick
+    FighterInput _lastInput;
+
+    /// Buffer in which packets are written and received
+    ByteBuffer _packet;
+};
+
+} // namespace FaceFight
@@ -0,0 +1,154 @@
+#include "UdpChannel.h"
+
+#include <algorithm>
+
+UdpChannel::UdpChannel(
+    unsigned short localPort,
+    sf::IpAddress const& remoteAddress,
+    unsigned short remotePort)
+    : _remoteAddress(remoteAddress),
+    _remotePort(remotePort),
+    _senderPort(0),
+    _latency(sf::Time::Zero),
+    _jitter(sf::Time::Zero),
+    _lossRate(0.f),
+    _random(0),
+    _sentCount(0),
+    _heldCount(0),
+    _sentBytes(0),
+    _receivedBytes(0),
+    _sentBytesPerSecond(0),
+    _receivedBytesPerSecond(0)
+{
+    if (_socket.bind(localPort) != sf::Socket::Done)
+    {
+        throw "Error: Cannot bind the UDP socket to its port.";
+    }
+    _socket.setBlocking(false);
+}
+
+void UdpChannel::SetConditions(
+    sf::Time latency,
+    sf::Time jitter,
+    float lossRate,
+    uint64_t seed)
+{
+    _latency = latency;
+    _jitter = jitter;
+    _lossRate = lossRate;
+    _random = CounterRandom(seed);
+    // Packets are only ever held back under artificial conditions, so that's when room is made for them
+    _heldPackets.resize(MAX_HELD_PACKETS);
+}
+
+void UdpChannel::Send(ByteBuffer const& packet)
+{
+    if (packet.GetSize() > MAX_PACKET_SIZE)
+    {
+        throw "Error: Sending a packet larger than the maximum packet size.";
+    }
+    UpdateRates();
+    _sentBytes += packet.GetSize();
+
+    if (_latency == sf::Time::Zero && _jitter == sf::Time::Zero && _lossRate == 0.f)
+    {
+        SendNow(packet.GetData(), packet.GetSize());
+        return;
+    }
+
+    // Each packet draws from its own stream, so conditions don't depend on the packets' timing
+    CounterRandom::Stream random = _random.GetStream(0, _sentCount++, 0);
+    if (random.NextFloat() < _lossRate || _heldCount == _heldPackets.size())
+    {
+        return;
+    }
+
+    HeldPacket& held = _heldPackets[_heldCount++];
+    held.sendTime = _clock.getElapsedTime() + _latency
+        + sf::microseconds((sf::Int64)(random.NextFloat() * _jitter.asMicroseconds()));
+    held.size = packet.GetSize();
+    std::copy(packet.GetData(), packet.GetData() + packet.GetSize(), held.data.begin());
+}
+
+bool UdpChannel::Receive(ByteBuffer& packet)
+{
+    SendHeldPackets();
+    UpdateRates();
+
+    size_t received = 0;
+    sf::IpAddress sender;
+    unsigned short senderPort = 0;
+    while (_socket.receive(_receiveData.data(), _receiveData.size(), received, sender, senderPort)
+        == sf::Socket::Done)
+    {
+        // A channel waiting for a peer takes packets from anyone, until its owner accepts a sender
+        if (_remotePort == 0 || (sender == _remoteAddress && senderPort == _remotePort))
+        {
+            _senderAddress = sender;
+            _senderPort = senderPort;
+            _receivedBytes += received;
+            packet.Clear();
+            packet.WriteArray(_receiveData.data(), received);
+            return true;
+        }
+    }
+    return false;
+}
+
+void UdpChannel::AcceptSender()
+{
+    if (_remotePort == 0)
+    {
+        _remoteAddress = _senderAddress;
+        _remotePort = _senderPort;
+    }
+}
+
+size_t UdpChannel::GetSentBytesPerSecond() const
+{
+    return _sentBytesPerSecond;
+}
+
+size_t UdpChannel::GetReceivedBytesPerSecond() const
+{
+    return _receivedBytesPerSecond;
+}
+
+void UdpChannel::SendNow(void const* data, size_t size)
+{
+    // Nothing can be sent before there is a peer
+    if (_remotePort == 0)
+    {
+        return;
+    }
+    // Packets that can't be sent right now are lost, as they could be on the way anyway
+    _socket.send(data, size, _remoteAddress, _remotePort);
+}
+
+void UdpChannel::SendHeldPackets()
+{
+    sf::Time const now = _clock.getElapsedTime();
+    for (size_t p = 0; p < _heldCount;)
+    {
+        if (_heldPackets[p].sendTime > now)
+        {
+            p++;
+            continue;
+        }
+        SendNow(_heldPackets[p].data.data(), _heldPackets[p].size);
+        // The last held packet takes the place of the sent one
+        _heldPackets[p] = _heldPackets[--_heldCount];
+    }
+}
+
+void UdpChannel::UpdateRates()
+{
+    if (_rateClock.getElapsedTime() >= sf::seconds(1.f))
+    {
+        _sentBytesPerSecond = _sentBytes;
+        _receivedBytesPerSecond = _receivedBytes;
+        _sentBytes = 0;
+        _receivedBytes = 0;
+        _rateClock.restart();
+    }
+}
@@ -0,0 +1,175 @@
+#pragma once
+
+#include "../Random/CounterRandom.h"
+#include "../Serialization/ByteBuffer.h"
+
+#include <SFML/Network.hpp>
+#include <SFML/System.hpp>
+
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * A class for exchanging packets with a single remote peer over UDP.
+ * 
+ * Packets are sent and received without blocking,
+ * and packets that come from anyone else than the peer are ignored.
+ * A channel created without a peer's port waits for a peer, receiving packets from anyone,
+ * until its owner accepts the sender of a packet as its peer.
+ * Like with UDP itself, packets can be lost, duplicated or reordered.
+ * 
+ * For testing, the channel can also make the connection worse on purpose,
+ * by holding its outgoing packets back for a while, and by dropping some of them.
+ * Held packets are kept in memory allocated once, when the channel is created.
+ */
+class UdpChannel
+{
+
+  public:
+
+    /// Maximum size of a packet, in bytes, small enough not to be fragmented on most networks
+    static constexpr size_t MAX_PACKET_SIZE = 1400;
+
+  public:
+
+    /**
+     * Creates a channel, binding it to a local port
+     * 
+     * @param[in] localPort
+     *  Port on which packets are received
+     * @param[in] remoteAddress
+     *  Address of the peer
+     * @param[in] remotePort
+     *  Port of the peer, or 0 to wait for a peer to send the first packet
+     */
+    UdpChannel(
+        unsigned short localPort,
+        sf::IpAddress const& remoteAddress,
+        unsigned short remotePort
+    );
+
+    UdpChannel(UdpChannel const&) = delete;
+    UdpChannel& operator=(UdpChannel const&) = delete;
+
+    /**
+     * Sets artificial conditions of the connection, for the packets that this channel sends
+     * 
+     * @param[in] latency
+     *  Time for which each packet is held back before it is sent
+     * @param[in] jitter
+     *  Each packet is held back for up to this much longer, at random,
+     *  so packets can arrive in a different order than they were sent
+     * @param[in] lossRate
+     *  Probability of a packet being dropped, between 0 and 1
+     * @param[in] seed (optional)
+     *  Seed of the random numbers that decide jitter and loss
+     */
+    void SetConditions(
+        sf::Time latency,
+        sf::Time jitter,
+        float lossRate,
+        uint64_t seed = 0
+    );
+
+    /**
+     * Sends a packet to the peer,
+     * or holds it back if the channel has artificial latency
+     * 
+     * @param[in] packet
+     *  Buffer holding the packet, at most MAX_PACKET_SIZE bytes
+     */
+    void Send(ByteBuffer const& packet);
+
+    /**
+     * Sends the held back packets whose time has come,
+     * and receives the next packet from the peer, if one has arrived
+     * 
+     * @param[in] packet
+     *  Buffer into which the packet is received, replacing what it held
+     * 
+     * @return whether a packet was received
+     */
+    bool Receive(ByteBuffer& packet);
+
+    /**
+     * Takes the sender of the last packet received as the peer, if the channel is still waiting for one.
+     * Owners call it once a packet has proven to come from someone they want to talk to,
+     * so that a stray packet doesn't take the channel over.
+     */
+    void AcceptSender();
+
+    /**
+     * Returns the number of bytes sent, and received, during the last full second
+     */
+    size_t GetSentBytesPerSecond() const;
+    size_t GetReceivedBytesPerSecond() const;
+
+  private:
+
+    /// Maximum number of packets held back at the same time, packets over it are dropped
+    static constexpr size_t MAX_HELD_PACKETS = 256;
+
+    /// A packet held back until the time it is sent
+    struct HeldPacket
+    {
+        sf::Time sendTime;
+        size_t size;
+        std::array<uint8_t, MAX_PACKET_SIZE> data;
+    };
+
+  private: /* functions */
+
+    /// Sends bytes to the peer right away
+    void SendNow(void const* data, size_t size);
+
+    /// Sends the held packets whose time has come
+    void SendHeldPackets();
+
+    /// Starts counting the bytes of a new second, if the last one is over
+    void UpdateRates();
+
+  private: /* variables */
+
+    /// The socket of the channel
+    sf::UdpSocket _socket;
+
+    /// Address and port of the peer
+    sf::IpAddress _remoteAddress;
+    unsigned short _remotePort;
+
+    /// Address and port of the sender of the last packet received
+    sf::IpAddress _senderAddress;
+    unsigned short _senderPort;
+
+    /// Artificial conditions of the connection
+    sf::Time _latency;
+    sf::Time _jitter;
+    float _lossRate;
+
+    /// Random generator of jitter and loss, and the number of packets it has decided for
+    CounterRandom _random;
+    uint64_t _sentCount;
+
+    /// Time since the channel was created, when packets are held back or sent
+    sf::Clock _clock;
+
+    /// Packets held back, of which the first few are in use, allocated once conditions are set
+    std::vector<HeldPacket> _heldPackets;
+    size_t _heldCount;
+
+    /// Bytes sent and received during the current second
+    size_t _sentBytes;
+    size_t _receivedBytes;
+
+    /// Bytes sent and received during the last full second
+    size_t _sentBytesPerSecond;
+    size_t _receivedBytesPerSecond;
+
+    /// Time since the current second began
+    sf::Clock _rateClock;
+
+    /// Memory into which packets are received
+    std::array<uint8_t, MAX_PACKET_SIZE> _receiveData;
+};
@@ -0,0 +1,300 @@
+#include "QuantizedMlp.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+// Vector kernels are compiled for their own instruction sets, and chosen only on CPUs that have them
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define QUANTIZED_MLP_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+namespace
+{
+
+// Marks the beginning of a weights file
+uint32_t const WEIGHTS_MAGIC = 0x46464E4E; // "FFNN"
+
+// Version of the weights file layout
+uint32_t const WEIGHTS_VERSION = 1;
+
+// Rows are padded to a whole number of 256-bit registers of 8-bit values
+size_t const KERNEL_WIDTH = 32;
+
+// Largest magnitude of a quantized value, the same for inputs and weights
+float const QUANTIZED_MAX = 127.f;
+
+// Quantized inputs are offset by this, so they are unsigned, as the VNNI instructions want them
+int32_t const INPUT_OFFSET = 128;
+
+// Rows are taken by threads in blocks, each block going through a layer's weights together
+size_t const BLOCK_ROWS = 32;
+
+/**
+ * Reads a value from a weights file as it is in memory
+ */
+template <class T>
+T ReadValue(std::ifstream& file)
+{
+    T value;
+    file.read(reinterpret_cast<char*>(&value), sizeof(T));
+    return value;
+}
+
+int32_t DotScalar(uint8_t const* inputs, int8_t const* weights, size_t count)
+{
+    int32_t sum = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        sum += (int32_t)inputs[i] * weights[i];
+    }
+    return sum;
+}
+
+#ifdef QUANTIZED_MLP_X86_KERNELS
+
+__attribute__((target("avx2")))
+int32_t DotAvx2(uint8_t const* inputs, int8_t const* weights, size_t count)
+{
+    // Values are widened to 16 bits, so products can't saturate before they are summed in pairs
+    __m256i sum = _mm256_setzero_si256();
+    for (size_t i = 0; i < count; i += 16)
+    {
+        __m256i const a = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<__m128i const*>(inputs + i)));
+        __m256i const b = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<__m128i const*>(weights + i)));
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(a, b));
+    }
+    __m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(1, 0, 3, 2)));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(half);
+}
+
+__attribute__((target("avxvnni")))
+int32_t DotAvxVnni(uint8_t const* inputs, int8_t const* weights, size_t count)
+{
+    // Each instruction multiplies 32 pairs and sums them by fours, straight into 32 bits
+    __m256i sum = _mm256_setzero_si256();
+    for (size_t i = 0; i < count; i += 32)
+    {
+        __m256i const a = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(inputs + i));
+        __m256i const b = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(weights + i));
+        sum = _mm256_dpbusd_avx_epi32(sum, a, b);
+    }
+    __m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(1, 0, 3, 2)));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(half);
+}
+
+#endif
+
+} // namespace
+
+QuantizedMlp::Workspace::Workspace(QuantizedMlp const& mlp, size_t capacity)
+    : _capacity(capacity),
+    _quantized(capacity * mlp._maxWidth),
+    _scales(capacity),
+    _activations(capacity * mlp._maxWidth)
+{}
+
+QuantizedMlp::QuantizedMlp(std::string const& filename, Kernel kernel)
+    : _maxWidth(0),
+    _kernel(kernel)
+{
+    std::ifstream file(filename, std::ios::binary);
+    if (!file)
+    {
+        throw "Error: Cannot load network from file: " + filename;
+    }
+    if (ReadValue<uint32_t>(file) != WEIGHTS_MAGIC || ReadValue<uint32_t>(file) != WEIGHTS_VERSION)
+    {
+        throw "Error: Not a weights file of a supported version: " + filename;
+    }
+
+    _layers.resize(ReadValue<uint32_t>(file));
+    std::vector<float> weights;
+    for (size_t l = 0; l < _layers.size(); l++)
+    {
+        Layer& layer = _layers[l];
+        layer.inputsCount = ReadValue<uint32_t>(file);
+        layer.outputsCount = ReadValue<uint32_t>(file);
+        if (!file || (l > 0 && layer.inputsCount != _layers[l - 1].outputsCount))
+        {
+            throw "Error: Invalid layer in weights file: " + filename;
+        }
+        layer.paddedInputsCount = (layer.inputsCount + KERNEL_WIDTH - 1) / KERNEL_WIDTH * KERNEL_WIDTH;
+        _maxWidth = std::max({_maxWidth, layer.paddedInputsCount, layer.outputsCount});
+
+        weights.resize(layer.outputsCount * layer.inputsCount);
+        layer.biases.resize(layer.outputsCount);
+        file.read(reinterpret_cast<char*>(weights.data()), sizeof(float) * weights.size());
+        file.read(reinterpret_cast<char*>(layer.biases.data()), sizeof(float) * layer.biases.size());
+        if (!file)
+        {
+            throw "Error: Weights file ends too early: " + filename;
+        }
+
+        // Each output's weights get their own scale, so small weights of one output aren't lost to another
+        layer.weights.assign(layer.outputsCount * layer.paddedInputsCount, 0);
+        layer.scales.resize(layer.outputsCount);
+        layer.weightSums.resize(layer.outputsCount);
+        for (size_t o = 0; o < layer.outputsCount; o++)
+        {
+            float const* row = &weights[o * layer.inputsCount];
+            float maxWeight = 0.f;
+            for (size_t i = 0; i < layer.inputsCount; i++)
+            {
+                maxWeight = std::max(maxWeight, std::abs(row[i]));
+            }
+            layer.scales[o] = maxWeight > 0.f ? maxWeight / QUANTIZED_MAX : 1.f;
+
+            int32_t sum = 0;
+            for (size_t i = 0; i < layer.inputsCount; i++)
+            {
+                int8_t const weight = (int8_t)std::lround(row[i] / layer.scales[o]);
+                layer.weights[o * layer.paddedInputsCount + i] = weight;
+                sum += weight;
+            }
+            layer.weightSums[o] = sum;
+        }
+    }
+    if (_layers.empty())
+    {
+        throw "Error: Weights file has no layers: " + filename;
+    }
+}
+
+void QuantizedMlp::Run(
+    float const* inputs,
+    size_t count,
+    float* outputs,
+    Workspace& workspace,
+    ThreadPool& threadPool) const
+{
+    if (count > workspace._capacity)
+    {
+        throw "Error: Batch is larger than the workspace.";
+    }
+    threadPool.ParallelFor(count, [&](size_t begin, size_t end) {
+        RunBlock(inputs, begin, end, outputs, workspace);
+    }, BLOCK_ROWS);
+}
+
+size_t QuantizedMlp::GetInputsCount() const
+{
+    return _layers.front().inputsCount;
+}
+
+size_t QuantizedMlp::GetOutputsCount() const
+{
+    return _layers.back().outputsCount;
+}
+
+QuantizedMlp::Kernel QuantizedMlp::GetKernel() const
+{
+    return _kernel;
+}
+
+QuantizedMlp::Kernel QuantizedMlp::GetBestKernel()
+{
+#ifdef QUANTIZED_MLP_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avxvnni"))
+    {
+        return Kernel::AvxVnni;
+    }
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return Kernel::Avx2;
+    }
+#endif
+    return Kernel::Scalar;
+}
+
+char const* QuantizedMlp::GetKernelName(Kernel kernel)
+{
+    switch (kernel)
+    {
+        case Kernel::Avx2:
+            return "AVX2";
+        case Kernel::AvxVnni:
+            return "AVX-VNNI";
+        default:
+            return "scalar";
+    }
+}
+
+void QuantizedMlp::RunBlock(
+    float const* inputs,
+    size_t begin,
+    size_t end,
+    float* outputs,
+    Workspace& workspace) const
+{
+    for (size_t l = 0; l < _layers.size(); l++)
+    {
+        Layer const& layer = _layers[l];
+        bool const last = l + 1 == _layers.size();
+
+        // Each row of inputs is quantized with its own scale, and padded with zeros
+        for (size_t r = begin; r < end; r++)
+        {
+            float const* row = l == 0
+                ? &inputs[r * layer.inputsCount]
+                : &workspace._activations[r * _maxWidth];
+            float maxInput = 0.f;
+            for (size_t i = 0; i < layer.inputsCount; i++)
+            {
+                maxInput = std::max(maxInput, std::abs(row[i]));
+            }
+            float const scale = maxInput > 0.f ? maxInput / QUANTIZED_MAX : 1.f;
+            workspace._scales[r] = scale;
+
+            uint8_t* const quantized = &workspace._quantized[r * _maxWidth];
+            for (size_t i = 0; i < layer.inputsCount; i++)
+            {
+                quantized[i] = (uint8_t)(std::lround(row[i] / scale) + INPUT_OFFSET);
+            }
+            std::fill(quantized + layer.inputsCount, quantized + layer.paddedInputsCount, (uint8_t)INPUT_OFFSET);
+        }
+
+        // Each output's weights are used by every row of the block while they are in the cache
+        for (size_t o = 0; o < layer.outputsCount; o++)
+        {
+            int8_t const* const weights = &layer.weights[o * layer.paddedInputsCount];
+            // Offset of the inputs adds the same multiple of the weights' sum to every row
+            int32_t const offsetSum = INPUT_OFFSET * layer.weightSums[o];
+            for (size_t r = begin; r < end; r++)
+            {
+                int32_t const sum = Dot(&workspace._quantized[r * _maxWidth], weights, layer.paddedInputsCount)
+                    - offsetSum;
+                float const value = sum * workspace._scales[r] * layer.scales[o] + layer.biases[o];
+                if (last)
+                {
+                    outputs[r * layer.outputsCount + o] = value;
+                }
+                else
+                {
+                    workspace._activations[r * _maxWidth + o] = std::max(value, 0.f);
+                }
+            }
+        }
+    }
+}
+
+int32_t QuantizedMlp::Dot(uint8_t const* inputs, int8_t const* weights, size_t count) const
+{
+    switch (_kernel)
+    {
+#ifdef QUANTIZED_MLP_X86_KERNELS
+        case Kernel::Avx2:
+            return DotAvx2(inputs, weights, count);
+        case Kernel::AvxVnni:
+            return DotAvxVnni(inputs, weights, count);
+#endif
+        default:
+            return DotScalar(inputs, weights, count);
+    }
+}
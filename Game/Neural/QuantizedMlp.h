@@ -0,0 +1,198 @@
+#pragma once
+
+#include "../Parallel/ThreadPool.h"
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * A class for a small multilayer perceptron trained elsewhere,
+ * whose inference runs on the CPU with 8-bit integer arithmetic.
+ * 
+ * The network is loaded from a weights file with the layers' weights and biases as floats:
+ * 
+ *  - magic number 0x46464E4E ("FFNN"), version and number of layers, all as 32-bit integers,
+ *  - for each layer, its numbers of inputs and outputs as 32-bit integers,
+ *    followed by the weights, output by output, and the biases, as 32-bit floats.
+ * 
+ * Every layer but the last one is followed by a ReLU.
+ * Weights are quantized to 8 bits when they are loaded, with a scale for each output,
+ * and each row of inputs is quantized with its own scale right before each layer,
+ * so only the products are integer, and the sums are scaled back to floats.
+ * 
+ * A batch of rows is run as a single matrix product per layer,
+ * with rows split into blocks that are spread across a pool of threads.
+ * The dot products run on the widest kernel the CPU supports:
+ * AVX-VNNI, AVX2, or plain scalar code, which all give exactly the same results.
+ */
+class QuantizedMlp
+{
+
+  public:
+
+    /// Kernels computing the dot products of 8-bit rows
+    enum class Kernel
+    {
+        Scalar,
+        Avx2,
+        AvxVnni
+    };
+
+    /**
+     * Memory in which a batch is run, allocated once for the largest batch,
+     * so that running a batch doesn't allocate.
+     * A workspace is used by a single caller at a time, the network itself can be shared.
+     */
+    class Workspace
+    {
+
+        friend class QuantizedMlp;
+
+      public:
+
+        /**
+         * Allocates memory for batches of a network
+         * 
+         * @param[in] mlp
+         *  The network whose batches will be run
+         * @param[in] capacity
+         *  Maximum number of rows in a batch
+         */
+        Workspace(QuantizedMlp const& mlp, size_t capacity);
+
+      private: /* variables */
+
+        /// Maximum number of rows in a batch
+        size_t _capacity;
+
+        /// Quantized inputs of the current layer, and the scale of each row
+        std::vector<uint8_t> _quantized;
+        std::vector<float> _scales;
+
+        /// Outputs of hidden layers, as inputs of the next ones
+        std::vector<float> _activations;
+    };
+
+  public:
+
+    /**
+     * Loads a network from a weights file
+     * 
+     * @param[in] filename
+     *  Path of the weights file
+     * @param[in] kernel (optional)
+     *  Kernel of the dot products, the best one the CPU supports by default
+     */
+    QuantizedMlp(std::string const& filename, Kernel kernel = GetBestKernel());
+
+    QuantizedMlp(QuantizedMlp const&) = delete;
+    QuantizedMlp& operator=(QuantizedMlp const&) = delete;
+
+    /**
+     * Runs a batch through the network
+     * 
+     * @param[in] inputs
+     *  Rows of GetInputsCount() inputs, one after another
+     * @param[in] count
+     *  Number of rows, at most the capacity of the workspace
+     * @param[in] outputs
+     *  Where the rows of GetOutputsCount() outputs are written, one after another
+     * @param[in] workspace
+     *  Memory in which the batch is run
+     * @param[in] threadPool
+     *  Threads among which blocks of rows are spread
+     */
+    void Run(
+        float const* inputs,
+        size_t count,
+        float* outputs,
+        Workspace& workspace,
+        ThreadPool& threadPool) const;
+
+    /// Returns the number of inputs of a row
+    size_t GetInputsCount() const;
+
+    /// Returns the number of outputs of a row
+    size_t GetOutputsCount() const;
+
+    /// Returns the kernel of the dot products
+    Kernel GetKernel() const;
+
+    /**
+     * Returns the fastest kernel that the CPU running the program supports
+     */
+    static Kernel GetBestKernel();
+
+    /**
+     * Returns the name of a kernel, to be shown in stats
+     */
+    static char const* GetKernelName(Kernel kernel);
+
+  private:
+
+    /// A fully connected layer, with quantized weights
+    struct Layer
+    {
+        size_t inputsCount;
+        size_t outputsCount;
+
+        /// Number of inputs, padded to a whole number of kernel registers
+        size_t paddedInputsCount;
+
+        /// Weights, output by output, each output padded with zeros
+        std::vector<int8_t> weights;
+
+        /// Scale, sum of weights and bias of each output
+        std::vector<float> scales;
+        std::vector<int32_t> weightSums;
+        std::vector<float> biases;
+    };
+
+  private: /* functions */
+
+    /**
+     * Runs a block of rows through the network, layer by layer
+     * 
+     * @param[in] inputs
+     *  Rows of the block's inputs
+     * @param[in] begin
+     *  Index of the first row of the block
+     * @param[in] end
+     *  Index after the last row of the block
+     * @param[in] outputs
+     *  Where the rows of the block's outputs are written
+     * @param[in] workspace
+     *  Memory in which the batch is run
+     */
+    void RunBlock(
+        float const* inputs,
+        size_t begin,
+        size_t end,
+        float* outputs,
+        Workspace& workspace) const;
+
+    /**
+     * Returns the dot product of a row of quantized inputs and a row of weights
+     * 
+     * @param[in] inputs
+     *  Quantized inputs, offset by 128 so they are unsigned
+     * @param[in] weights
+     *  Weights of an output
+     * @param[in] count
+     *  Number of inputs, a whole number of kernel registers
+     */
+    int32_t Dot(uint8_t const* inputs, int8_t const* weights, size_t count) const;
+
+  private: /* variables */
+
+    /// Layers of the network
+    std::vector<Layer> _layers;
+
+    /// Largest number of padded inputs and of outputs among the layers
+    size_t _maxWidth;
+
+    /// Kernel of the dot products
+    Kernel _kernel;
+};
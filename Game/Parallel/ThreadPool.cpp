@@ -0,0 +1,132 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+namespace
+{
+
+/// Index of the current thread within its pool, 0 for threads that aren't workers
+thread_local size_t currentThreadIndex = 0;
+
+} // namespace
+
+ThreadPool::ThreadPool(
+    size_t workersCount)
+    : _rangeFunction(nullptr),
+    _function(nullptr),
+    _count(0),
+    _chunkSize(0),
+    _nextChunk(0),
+    _loopGeneration(0),
+    _busyWorkers(0),
+    _stopping(false)
+{
+    _workers.reserve(workersCount);
+    for (size_t w = 0; w < workersCount; w++)
+    {
+        _workers.emplace_back(&ThreadPool::WorkerLoop, this, w + 1);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopping = true;
+    }
+    _workAvailable.notify_all();
+    for (std::thread& worker : _workers)
+    {
+        worker.join();
+    }
+}
+
+size_t ThreadPool::GetThreadsCount() const
+{
+    return _workers.size() + 1;
+}
+
+size_t ThreadPool::GetCurrentThreadIndex()
+{
+    return currentThreadIndex;
+}
+
+size_t ThreadPool::GetDefaultWorkersCount()
+{
+    unsigned const hardwareThreads = std::thread::hardware_concurrency();
+    return hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+}
+
+ThreadPool::CallerScope::CallerScope()
+    : _outerIndex(currentThreadIndex)
+{
+    currentThreadIndex = 0;
+}
+
+ThreadPool::CallerScope::~CallerScope()
+{
+    currentThreadIndex = _outerIndex;
+}
+
+void ThreadPool::Run(
+    RangeFunction rangeFunction, void const* function, size_t count, size_t chunkSize)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _rangeFunction = rangeFunction;
+        _function = function;
+        _count = count;
+        _chunkSize = chunkSize;
+        _nextChunk = 0;
+        _busyWorkers = _workers.size();
+        _loopGeneration++;
+    }
+    _workAvailable.notify_all();
+
+    // The calling thread works too, instead of just waiting
+    ProcessChunks();
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    _workDone.wait(lock, [this] { return _busyWorkers == 0; });
+}
+
+void ThreadPool::ProcessChunks()
+{
+    while (true)
+    {
+        size_t const begin = _nextChunk.fetch_add(_chunkSize);
+        if (begin >= _count)
+        {
+            return;
+        }
+        _rangeFunction(_function, begin, std::min(begin + _chunkSize, _count));
+    }
+}
+
+void ThreadPool::WorkerLoop(size_t threadIndex)
+{
+    currentThreadIndex = threadIndex;
+    size_t seenGeneration = 0;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _workAvailable.wait(lock, [this, seenGeneration] {
+                return _stopping || _loopGeneration != seenGeneration;
+            });
+            if (_stopping)
+            {
+                return;
+            }
+            seenGeneration = _loopGeneration;
+        }
+
+        ProcessChunks();
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _busyWorkers--;
+        }
+        _workDone.notify_one();
+    }
+}
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * A class for a pool of worker threads, that run data-parallel loops.
+ * Workers are created once and wait for work,
+ * so running a loop doesn't create any threads or allocate memory.
+ * The thread calling ParallelFor() takes part in the loop as well,
+ * and returns only when the whole loop is done.
+ */
+class ThreadPool
+{
+
+  public:
+
+    /**
+     * Creates a thread pool
+     * 
+     * @param[in] workersCount (optional)
+     *  Number of worker threads, besides the calling thread.
+     *  By default one less than the number of hardware threads.
+     */
+    ThreadPool(
+        size_t workersCount = GetDefaultWorkersCount()
+    );
+
+    /**
+     * Stops and joins all worker threads
+     */
+    ~ThreadPool();
+
+    ThreadPool(ThreadPool const&) = delete;
+    ThreadPool& operator=(ThreadPool const&) = delete;
+
+    /**
+     * Runs a loop over the range [0, count), split into chunks across all threads.
+     * The function is called with the begin and end of each chunk,
+     * so chunks have to be independent of each other.
+     * 
+     * @param[in] count
+     *  Number of iterations of the loop
+     * @param[in] function
+     *  Function taking in the begin and end index of a chunk
+     * @param[in] chunkSize (optional)
+     *  Number of iterations in a single chunk
+     */
+    template <class Function>
+    void ParallelFor(
+        size_t count,
+        Function const& function,
+        size_t chunkSize = CHUNK_SIZE_DEFAULT
+    );
+
+    /**
+     * Returns the number of threads taking part in a loop,
+     * including the calling thread
+     */
+    size_t GetThreadsCount() const;
+
+    /**
+     * Returns one less than the number of hardware threads, but at least 0
+     */
+    static size_t GetDefaultWorkersCount();
+
+    /**
+     * Returns the index of the calling thread within its pool,
+     * which is between 1 and the number of workers for worker threads,
+     * and 0 for any thread that isn't a worker, and for the thread calling ParallelFor()
+     * during the loop, even if it is a worker of another pool.
+     * Useful for giving each thread its own buffer to write into.
+     */
+    static size_t GetCurrentThreadIndex();
+
+    /**
+     * Makes the calling thread count as thread 0 for as long as it exists.
+     * ParallelFor() opens one for its loop, so that a loop run from a worker of another pool
+     * indexes this pool's threads. Code that writes into per-thread buffers of a pool
+     * outside of its loops, possibly on a worker of another pool, has to open one as well.
+     */
+    class CallerScope
+    {
+      public:
+        CallerScope();
+        ~CallerScope();
+
+        CallerScope(CallerScope const&) = delete;
+        CallerScope& operator=(CallerScope const&) = delete;
+
+      private:
+        /// Index the thread had before, restored at the end of the scope
+        size_t _outerIndex;
+    };
+
+  private:
+
+    /// The default number of iterations in a single chunk
+    static constexpr size_t CHUNK_SIZE_DEFAULT = 256;
+
+    /// A function called for a chunk of the current loop
+    using RangeFunction = void (*)(void const*, size_t, size_t);
+
+  private: /* functions */
+
+    /// Calls the loop's function for a chunk. Instances of this are what the pool runs.
+    template <class Function>
+    static void CallFunction(void const* function, size_t begin, size_t end);
+
+    /**
+     * Runs the current loop on all threads, and waits for it to finish
+     */
+    void Run(RangeFunction rangeFunction, void const* function, size_t count, size_t chunkSize);
+
+    /// Takes chunks of the current loop until there are none left
+    void ProcessChunks();
+
+    /**
+     * The loop of each worker thread
+     * 
+     * @param[in] threadIndex
+     *  Index of the worker's thread, starting from 1
+     */
+    void WorkerLoop(size_t threadIndex);
+
+  private: /* variables */
+
+    /// The worker threads
+    std::vector<std::thread> _workers;
+
+    /// Guards the state of the current loop, shared with workers
+    std::mutex _mutex;
+
+    /// Wakes up workers when there is a new loop, or when they have to stop
+    std::condition_variable _workAvailable;
+
+    /// Wakes up the calling thread when all workers have finished the loop
+    std::condition_variable _workDone;
+
+    /// Function of the current loop, and the object it is called on
+    RangeFunction _rangeFunction;
+    void const* _function;
+
+    /// Number of iterations and chunk size of the current loop
+    size_t _count;
+    size_t _chunkSize;
+
+    /// Begin of the next chunk that hasn't been taken yet
+    std::atomic<size_t> _nextChunk;
+
+    /// Incremented for each new loop, so that workers can tell a new loop has started
+    size_t _loopGeneration;
+
+    /// Number of workers that haven't finished the current loop yet
+    size_t _busyWorkers;
+
+    /// Tells workers to stop
+    bool _stopping;
+};
+
+template <class Function>
+void ThreadPool::ParallelFor(
+    size_t count,
+    Function const& function,
+    size_t chunkSize)
+{
+    if (count == 0)
+    {
+        return;
+    }
+    CallerScope const callerScope;
+    // Small loops or pools without workers aren't worth waking anyone up
+    if (_workers.empty() || count <= chunkSize)
+    {
+        function(size_t(0), count);
+        return;
+    }
+    Run(&CallFunction<Function>, &function, count, chunkSize);
+}
+
+template <class Function>
+void ThreadPool::CallFunction(void const* function, size_t begin, size_t end)
+{
+    (*static_cast<Function const*>(function))(begin, end);
+}
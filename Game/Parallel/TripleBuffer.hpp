@@ -0,0 +1,115 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+/**
+ * A class for handing the latest of a stream of values from one thread to another,
+ * without either of them ever waiting for the other.
+ * 
+ * Of the three slots, the producer writes into the back one, and the consumer reads the front one,
+ * while the middle one holds the last value published. Publishing swaps the back slot with the middle one,
+ * and acquiring swaps the front slot with the middle one, if anything was published since.
+ * Values that are published faster than they are acquired are skipped,
+ * and slots are reused, so values holding memory keep it from one use to the next.
+ * 
+ * Only one thread may produce, and only one thread may consume.
+ */
+template <class T>
+class TripleBuffer
+{
+
+  public:
+
+    /// Creates a buffer of default constructed values, of which none is published yet
+    TripleBuffer();
+
+    TripleBuffer(TripleBuffer const&) = delete;
+    TripleBuffer& operator=(TripleBuffer const&) = delete;
+
+    /**
+     * Returns the slot that the producer writes the next value into,
+     * which is left as it was when it was last published or acquired
+     */
+    T& GetBack();
+
+    /**
+     * Publishes the value written into the back slot, called by the producer.
+     * The producer gets another slot to write the next value into.
+     */
+    void Publish();
+
+    /**
+     * Takes the last value published, called by the consumer
+     * 
+     * @return true if a value was published since the last call, and is now in the front slot,
+     *  false if the front slot still holds the same value
+     */
+    bool Acquire();
+
+    /**
+     * Returns the slot holding the value that the consumer acquired last
+     */
+    T const& GetFront() const;
+
+  private:
+
+    /// Bits of the middle index holding the index of a slot
+    static constexpr uint8_t INDEX_MASK = 0x3;
+
+    /// Bit of the middle index set when its slot has been published, and not acquired yet
+    static constexpr uint8_t FRESH_BIT = 0x4;
+
+  private: /* variables */
+
+    /// The three slots
+    std::array<T, 3> _slots;
+
+    /// Index of the producer's slot, only touched by the producer
+    uint8_t _back;
+
+    /// Index of the middle slot, with the fresh bit, exchanged by both threads
+    std::atomic<uint8_t> _middle;
+
+    /// Index of the consumer's slot, only touched by the consumer
+    uint8_t _front;
+};
+
+template <class T>
+TripleBuffer<T>::TripleBuffer()
+    : _back(0),
+    _middle(1),
+    _front(2)
+{}
+
+template <class T>
+T& TripleBuffer<T>::GetBack()
+{
+    return _slots[_back];
+}
+
+template <class T>
+void TripleBuffer<T>::Publish()
+{
+    // Release makes the written value visible to the consumer, acquire gets the slot it may have just left
+    _back = _middle.exchange(_back | FRESH_BIT, std::memory_order_acq_rel) & INDEX_MASK;
+}
+
+template <class T>
+bool TripleBuffer<T>::Acquire()
+{
+    if ((_middle.load(std::memory_order_relaxed) & FRESH_BIT) == 0)
+    {
+        return false;
+    }
+    // Only the consumer clears the fresh bit, so the middle slot is still fresh when it is swapped
+    _front = _middle.exchange(_front, std::memory_order_acq_rel) & INDEX_MASK;
+    return true;
+}
+
+template <class T>
+T const& TripleBuffer<T>::GetFront() const
+{
+    return _slots[_front];
+}
@@ -0,0 +1,396 @@
+#pragma once
+
+#include "../Serialization/ByteBuffer.h"
+
+#include <algorithm>
+#include <new>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <type_traits>
+
+/**
+ * A template class for a fixed-capacity pool of objects.
+ * Storage for all objects is allocated once, when the pool is created,
+ * and objects are constructed in place in free slots, which are kept in a free list.
+ * That way creating and destroying objects never allocates memory,
+ * and costs the same no matter how many objects have been created before.
+ * 
+ * Objects are referred to by handles, which carry a generation number,
+ * so a handle to a destroyed object can be detected as stale,
+ * even if its slot has been reused by another object since.
+ * 
+ * The pool also keeps a dense list of the active objects,
+ * so they can be iterated without visiting free slots.
+ * 
+ * Slots are first taken in order, so only the slots that have ever been used
+ * have to be remembered in a snapshot of the pool, however large its capacity.
+ * 
+ * @param[in] T
+ *  The type of the objects in the pool
+ */
+template <class T>
+class ObjectPool
+{
+
+  public:
+
+    /// Handle to an object in the pool
+    struct Handle
+    {
+        uint32_t index;
+        uint32_t generation;
+    };
+
+  public:
+
+    /**
+     * Creates a pool, allocating storage for the given number of objects
+     * 
+     * @param[in] capacity
+     *  Maximum number of objects that can be in the pool at the same time
+     */
+    ObjectPool(size_t capacity);
+
+    /**
+     * Destroys all objects remaining in the pool
+     */
+    ~ObjectPool();
+
+    ObjectPool(ObjectPool const&) = delete;
+    ObjectPool& operator=(ObjectPool const&) = delete;
+
+    /**
+     * Constructs a new object in a free slot of the pool
+     * 
+     * @param[in] args
+     *  Arguments passed to the object's constructor
+     * 
+     * @return handle to the new object
+     */
+    template <class... Args>
+    Handle Create(Args&&... args);
+
+    /**
+     * Destroys the object with the given handle, and frees its slot
+     * 
+     * @param[in] handle
+     *  Handle to the object to be destroyed
+     */
+    void Destroy(Handle handle);
+
+    /**
+     * Returns a pointer to the object with the given handle,
+     * or nullptr if the object has been destroyed
+     */
+    T* Get(Handle handle);
+    T const* Get(Handle handle) const;
+
+    /**
+     * Returns the handle of an object in the pool
+     * 
+     * @param[in] object
+     *  Pointer to an object that lives in the pool
+     */
+    Handle GetHandle(T const* object) const;
+
+    /**
+     * Returns the number of objects currently in the pool
+     */
+    size_t GetActiveCount() const;
+
+    /**
+     * Returns the i-th active object.
+     * Destroying an object changes the order of the active objects.
+     * 
+     * @param[in] i
+     *  Index in the list of active objects, less than GetActiveCount()
+     */
+    T& GetActive(size_t i);
+    T const& GetActive(size_t i) const;
+
+    /**
+     * Returns the maximum number of objects in the pool
+     */
+    size_t GetCapacity() const;
+
+    /**
+     * Writes the pool to a buffer: the generations of the slots that have ever been used,
+     * which of them are free, in the order they are reused, and the active objects, in their order.
+     * The size written depends on the number of slots used, not on the capacity.
+     * 
+     * @param[in] buffer
+     *  Buffer to which the pool is written
+     * @param[in] saveObject
+     *  Function taking in an active object, which writes it to the buffer
+     */
+    template <class SaveObject>
+    void Save(ByteBuffer& buffer, SaveObject const& saveObject) const;
+
+    /**
+     * Reads a pool written by Save() from a buffer, replacing the objects in the pool.
+     * Objects are constructed again in their saved slots, in their saved order,
+     * so handles that were valid in the saved pool are valid again, and only them.
+     * 
+     * @param[in] buffer
+     *  Buffer from which the pool is read
+     * @param[in] loadObject
+     *  Function taking in a newly constructed object, which reads it from the buffer
+     * @param[in] args
+     *  Arguments passed to the constructor of each object
+     */
+    template <class LoadObject, class... Args>
+    void Load(ByteBuffer& buffer, LoadObject const& loadObject, Args const&... args);
+
+  private:
+
+    /// Raw storage for a single object
+    using Storage = std::aligned_storage_t<sizeof(T), alignof(T)>;
+
+    /// Index used in place of a pointer to no slot
+    static constexpr uint32_t NO_SLOT = UINT32_MAX;
+
+  private: /* functions */
+
+    /// Returns a pointer to the object in the given slot
+    T* GetObject(uint32_t slot);
+    T const* GetObject(uint32_t slot) const;
+
+  private: /* variables */
+
+    /// Storage for all objects
+    std::unique_ptr<Storage[]> _storage;
+
+    /// Generation of each slot, incremented each time the slot's object is destroyed
+    std::vector<uint32_t> _generations;
+
+    /// Next free slot after each free slot
+    std::vector<uint32_t> _nextFree;
+
+    /// First free slot
+    uint32_t _freeHead;
+
+    /// Number of slots that have ever held an object, the slots after them are free in their order
+    uint32_t _usedCount;
+
+    /// Slots of the active objects, densely packed
+    std::vector<uint32_t> _activeSlots;
+
+    /// Position in the list of active objects of each slot's object
+    std::vector<uint32_t> _activePositions;
+
+    /// Maximum number of objects in the pool
+    size_t _capacity;
+};
+
+template <class T>
+ObjectPool<T>::ObjectPool(size_t capacity)
+    : _storage(new Storage[capacity]),
+    _generations(capacity, 0),
+    _nextFree(capacity),
+    _freeHead(capacity > 0 ? 0 : NO_SLOT),
+    _usedCount(0),
+    _activePositions(capacity, NO_SLOT),
+    _capacity(capacity)
+{
+    for (size_t s = 0; s < capacity; s++)
+    {
+        _nextFree[s] = (s + 1 < capacity) ? s + 1 : NO_SLOT;
+    }
+    _activeSlots.reserve(capacity);
+}
+
+template <class T>
+ObjectPool<T>::~ObjectPool()
+{
+    for (uint32_t slot : _activeSlots)
+    {
+        GetObject(slot)->~T();
+    }
+}
+
+template <class T>
+template <class... Args>
+typename ObjectPool<T>::Handle ObjectPool<T>::Create(Args&&... args)
+{
+    if (_freeHead == NO_SLOT)
+    {
+        throw "Error: Object pool capacity exceeded.";
+    }
+
+    uint32_t const slot = _freeHead;
+    new (&_storage[slot]) T(std::forward<Args>(args)...);
+    _freeHead = _nextFree[slot];
+    _usedCount = std::max(_usedCount, slot + 1);
+
+    _activePositions[slot] = _activeSlots.size();
+    _activeSlots.push_back(slot);
+
+    return {slot, _generations[slot]};
+}
+
+template <class T>
+void ObjectPool<T>::Destroy(Handle handle)
+{
+    if (Get(handle) == nullptr)
+    {
+        throw "Error: Destroying an object that is not in the pool.";
+    }
+    uint32_t const slot = handle.index;
+    GetObject(slot)->~T();
+    _generations[slot]++;
+
+    // Move the last active object to the position of the destroyed one
+    uint32_t const position = _activePositions[slot];
+    uint32_t const lastSlot = _activeSlots.back();
+    _activeSlots[position] = lastSlot;
+    _activePositions[lastSlot] = position;
+    _activeSlots.pop_back();
+    _activePositions[slot] = NO_SLOT;
+
+    _nextFree[slot] = _freeHead;
+    _freeHead = slot;
+}
+
+template <class T>
+T* ObjectPool<T>::Get(Handle handle)
+{
+    if (handle.index >= _capacity
+        || _generations[handle.index] != handle.generation
+        || _activePositions[handle.index] == NO_SLOT)
+    {
+        return nullptr;
+    }
+    return GetObject(handle.index);
+}
+
+template <class T>
+T const* ObjectPool<T>::Get(Handle handle) const
+{
+    return const_cast<ObjectPool*>(this)->Get(handle);
+}
+
+template <class T>
+typename ObjectPool<T>::Handle ObjectPool<T>::GetHandle(T const* object) const
+{
+    uint32_t const slot = reinterpret_cast<Storage const*>(object) - _storage.get();
+    return {slot, _generations[slot]};
+}
+
+template <class T>
+size_t ObjectPool<T>::GetActiveCount() const
+{
+    return _activeSlots.size();
+}
+
+template <class T>
+template <class SaveObject>
+void ObjectPool<T>::Save(ByteBuffer& buffer, SaveObject const& saveObject) const
+{
+    buffer.Write(_capacity);
+    buffer.Write(_usedCount);
+    buffer.WriteArray(_generations.data(), _usedCount);
+
+    // Free slots that have been used come first in the free list, and the untouched ones follow in order
+    size_t freedCount = 0;
+    for (uint32_t slot = _freeHead; slot != NO_SLOT && slot < _usedCount; slot = _nextFree[slot])
+    {
+        freedCount++;
+    }
+    buffer.Write(freedCount);
+    for (uint32_t slot = _freeHead; slot != NO_SLOT && slot < _usedCount; slot = _nextFree[slot])
+    {
+        buffer.Write(slot);
+    }
+
+    buffer.Write(_activeSlots.size());
+    buffer.WriteArray(_activeSlots.data(), _activeSlots.size());
+    for (uint32_t slot : _activeSlots)
+    {
+        saveObject(*GetObject(slot));
+    }
+}
+
+template <class T>
+template <class LoadObject, class... Args>
+void ObjectPool<T>::Load(ByteBuffer& buffer, LoadObject const& loadObject, Args const&... args)
+{
+    if (buffer.Read<size_t>() != _capacity)
+    {
+        throw "Error: Loading an object pool with a different capacity.";
+    }
+
+    for (uint32_t slot : _activeSlots)
+    {
+        GetObject(slot)->~T();
+        _activePositions[slot] = NO_SLOT;
+    }
+
+    // Slots used since the snapshot, and not in it, become untouched again
+    uint32_t const usedCount = buffer.Read<uint32_t>();
+    if (usedCount > _capacity)
+    {
+        throw "Error: Loading an object pool with more used slots than its capacity.";
+    }
+    for (uint32_t slot = usedCount; slot < _usedCount; slot++)
+    {
+        _generations[slot] = 0;
+        _nextFree[slot] = (slot + 1 < _capacity) ? slot + 1 : NO_SLOT;
+    }
+    _usedCount = usedCount;
+    buffer.ReadArray(_generations.data(), _usedCount);
+
+    // The free list is chained again, in its saved order, up to the first untouched slot
+    uint32_t const firstUntouched = (_usedCount < _capacity) ? _usedCount : NO_SLOT;
+    uint32_t* link = &_freeHead;
+    for (size_t freedCount = buffer.Read<size_t>(); freedCount > 0; freedCount--)
+    {
+        uint32_t const slot = buffer.Read<uint32_t>();
+        *link = slot;
+        link = &_nextFree[slot];
+    }
+    *link = firstUntouched;
+
+    _activeSlots.resize(buffer.Read<size_t>()); // capacity is reserved, so this doesn't allocate
+    buffer.ReadArray(_activeSlots.data(), _activeSlots.size());
+
+    for (size_t position = 0; position < _activeSlots.size(); position++)
+    {
+        uint32_t const slot = _activeSlots[position];
+        _activePositions[slot] = position;
+        new (&_storage[slot]) T(args...);
+        loadObject(*GetObject(slot));
+    }
+}
+
+template <class T>
+T& ObjectPool<T>::GetActive(size_t i)
+{
+    return *GetObject(_activeSlots[i]);
+}
+
+template <class T>
+T const& ObjectPool<T>::GetActive(size_t i) const
+{
+    return *GetObject(_activeSlots[i]);
+}
+
+template <class T>
+size_t ObjectPool<T>::GetCapacity() const
+{
+    return _capacity;
+}
+
+template <class T>
+T* ObjectPool<T>::GetObject(uint32_t slot)
+{
+    return std::launder(reinterpret_cast<T*>(&_storage[slot]));
+}
+
+template <class T>
+T const* ObjectPool<T>::GetObject(uint32_t slot) const
+{
+    return std::launder(reinterpret_cast<T const*>(&_storage[slot]));
+}
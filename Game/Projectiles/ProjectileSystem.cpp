@@ -0,0 +1,408 @@
+#include "ProjectileSystem.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+
+/// Size of a cell of the enemy grid
+float const CELL_SIZE = 128.f;
+
+/// Time for which a projectile flies, in ticks
+uint32_t const PROJECTILE_LIFETIME = 90;
+
+/// Damage dealt by a thrown fist
+int const PROJECTILE_DAMAGE = 3;
+
+/// Number of projectiles whose vertices are built in a single chunk
+size_t const VERTICES_CHUNK_SIZE = 4096;
+
+/* Projectiles record their hits with their thrower's ID as the source,
+   so this bit is set on their sequence numbers to keep them apart from the thrower's own */
+uint32_t const PROJECTILE_SEQUENCE_BIT = 1u << 31;
+
+/**
+ * Returns the earliest time, between 0 and 1, when a point moving from a position
+ * by a delta comes within the radius of a center, or a negative number if it never does
+ */
+float SweepCircle(
+    sf::Vector2f const& position,
+    sf::Vector2f const& delta,
+    sf::Vector2f const& center,
+    float radius)
+{
+    sf::Vector2f const offset = position - center;
+    float const c = offset.x * offset.x + offset.y * offset.y - radius * radius;
+    if (c <= 0.f)
+    {
+        return 0.f;
+    }
+    float const a = delta.x * delta.x + delta.y * delta.y;
+    float const b = 2.f * (offset.x * delta.x + offset.y * delta.y);
+    float const discriminant = b * b - 4.f * a * c;
+    if (a == 0.f || discriminant < 0.f)
+    {
+        return -1.f;
+    }
+    float const time = (-b - std::sqrt(discriminant)) / (2.f * a);
+    return (time <= 1.f) ? time : -1.f;
+}
+
+} // namespace
+
+namespace FaceFight
+{
+
+ProjectileSystem::ProjectileSystem(
+    size_t capacity,
+    size_t enemiesCapacity,
+    sf::Vector2f const& areaSize)
+    : _capacity(capacity),
+    _areaSize(areaSize),
+    _texture(nullptr),
+    _imageSize(0.f, 0.f),
+    _size(0.f, 0.f),
+    _radius(0.f),
+    _xs(capacity),
+    _ys(capacity),
+    _velocityXs(capacity),
+    _velocityYs(capacity),
+    _ticksLeft(capacity),
+    _teams(capacity),
+    _throwerIds(capacity),
+    _serials(capacity),
+    _targets(capacity),
+    _count(0),
+    _nextSerial(0),
+    _columns(std::max(1, (int)std::ceil(areaSize.x / CELL_SIZE))),
+    _rows(std::max(1, (int)std::ceil(areaSize.y / CELL_SIZE))),
+    _enemyXs(enemiesCapacity),
+    _enemyYs(enemiesCapacity),
+    _cellStarts(_columns * _rows + 1),
+    _cellEnemies(enemiesCapacity),
+    _enemyCells(enemiesCapacity),
+    _enemyRadius(0.f),
+    _vertices(sf::Quads)
+{}
+
+void ProjectileSystem::SetTexture(
+    sf::Texture const& texture,
+    sf::Vector2f const& scale)
+{
+    _texture = &texture;
+    SetSize(texture.getSize(), scale);
+}
+
+void ProjectileSystem::SetSize(
+    sf::Vector2u const& imageSize,
+    sf::Vector2f const& scale)
+{
+    _imageSize = sf::Vector2f(imageSize);
+    _size = sf::Vector2f(imageSize.x * scale.x, imageSize.y * scale.y);
+    _radius = std::min(_size.x, _size.y) / 2.f;
+}
+
+bool ProjectileSystem::Throw(
+    Team team,
+    uint32_t throwerId,
+    sf::Vector2f const& position,
+    sf::Vector2f const& velocity)
+{
+    if (_count == _capacity)
+    {
+        return false;
+    }
+    size_t const p = _count++;
+    _xs[p] = position.x;
+    _ys[p] = position.y;
+    _velocityXs[p] = velocity.x;
+    _velocityYs[p] = velocity.y;
+    _ticksLeft[p] = PROJECTILE_LIFETIME;
+    _teams[p] = team;
+    _throwerIds[p] = throwerId;
+    _serials[p] = _nextSerial++ & ~PROJECTILE_SEQUENCE_BIT;
+    return true;
+}
+
+void ProjectileSystem::Update(
+    Entity& player,
+    ObjectPool<Entity>& enemies,
+    Arena const& arena,
+    CommandQueue& commandQueue,
+    GameEventBus& eventBus,
+    ThreadPool& threadPool)
+{
+    BuildGrid(enemies);
+
+    // Projectiles only read the entities, so they can be moved in parallel
+    threadPool.ParallelFor(_count, [&](size_t begin, size_t end) {
+        for (size_t p = begin; p < end; p++)
+        {
+            _targets[p] = Advance(p, player, enemies, arena);
+        }
+    });
+
+    // Hits are recorded in the order of the projectiles, so they don't depend on the threads
+    for (size_t p = 0; p < _count; p++)
+    {
+        if (_targets[p] == PLAYER_TARGET)
+        {
+            RecordHit(p, player, commandQueue, eventBus);
+        }
+        else if (_targets[p] < enemies.GetActiveCount())
+        {
+            RecordHit(p, enemies.GetActive(_targets[p]), commandQueue, eventBus);
+        }
+    }
+    for (size_t p = 0; p < _count;)
+    {
+        if (_targets[p] == NO_TARGET)
+        {
+            p++;
+        }
+        else
+        {
+            Remove(p);
+        }
+    }
+
+    // Vertices are built here, so drawing only has to send them, unless nothing is drawn
+    if (_texture != nullptr)
+    {
+        _vertices.resize(_count * 4);
+        threadPool.ParallelFor(_count, [this](size_t begin, size_t end) {
+            BuildVertices(begin, end);
+        }, VERTICES_CHUNK_SIZE);
+    }
+}
+
+void ProjectileSystem::CaptureVertices(std::vector<sf::Vertex>& vertices) const
+{
+    vertices.clear();
+    if (_vertices.getVertexCount() > 0)
+    {
+        vertices.assign(&_vertices[0], &_vertices[0] + _vertices.getVertexCount());
+    }
+}
+
+size_t ProjectileSystem::GetCount() const
+{
+    return _count;
+}
+
+sf::Vector2f ProjectileSystem::GetPosition(size_t p) const
+{
+    return sf::Vector2f(_xs[p], _ys[p]);
+}
+
+ProjectileSystem::Team ProjectileSystem::GetTeam(size_t p) const
+{
+    return _teams[p];
+}
+
+void ProjectileSystem::ShowSeen(sf::Vector2f const* positions, size_t count)
+{
+    _count = std::min(count, _capacity);
+    for (size_t p = 0; p < _count; p++)
+    {
+        _xs[p] = positions[p].x;
+        _ys[p] = positions[p].y;
+    }
+    _vertices.resize(_count * 4);
+    BuildVertices(0, _count);
+}
+
+void ProjectileSystem::Save(ByteBuffer& buffer) const
+{
+    buffer.Write(_count);
+    buffer.Write(_nextSerial);
+    buffer.WriteArray(_xs.data(), _count);
+    buffer.WriteArray(_ys.data(), _count);
+    buffer.WriteArray(_velocityXs.data(), _count);
+    buffer.WriteArray(_velocityYs.data(), _count);
+    buffer.WriteArray(_ticksLeft.data(), _count);
+    buffer.WriteArray(_teams.data(), _count);
+    buffer.WriteArray(_throwerIds.data(), _count);
+    buffer.WriteArray(_serials.data(), _count);
+}
+
+void ProjectileSystem::Load(ByteBuffer& buffer)
+{
+    size_t const count = buffer.Read<size_t>();
+    if (count > _capacity)
+    {
+        throw "Error: Loading more projectiles than the system can hold.";
+    }
+    _count = count;
+    _nextSerial = buffer.Read<uint32_t>();
+    buffer.ReadArray(_xs.data(), _count);
+    buffer.ReadArray(_ys.data(), _count);
+    buffer.ReadArray(_velocityXs.data(), _count);
+    buffer.ReadArray(_velocityYs.data(), _count);
+    buffer.ReadArray(_ticksLeft.data(), _count);
+    buffer.ReadArray(_teams.data(), _count);
+    buffer.ReadArray(_throwerIds.data(), _count);
+    buffer.ReadArray(_serials.data(), _count);
+}
+
+void ProjectileSystem::BuildGrid(ObjectPool<Entity>& enemies)
+{
+    size_t const enemiesCount = enemies.GetActiveCount();
+    _enemyRadius = (enemiesCount > 0) ? enemies.GetActive(0).GetFaceRadius() : 0.f;
+
+    // Counting sort of the enemies by cell
+    std::fill(_cellStarts.begin(), _cellStarts.end(), 0);
+    for (size_t e = 0; e < enemiesCount; e++)
+    {
+        sf::Vector2f const position = enemies.GetActive(e).GetPosition();
+        _enemyXs[e] = position.x;
+        _enemyYs[e] = position.y;
+        int const column = std::max(0, std::min(_columns - 1, (int)(position.x / CELL_SIZE)));
+        int const row = std::max(0, std::min(_rows - 1, (int)(position.y / CELL_SIZE)));
+        _enemyCells[e] = row * _columns + column;
+        _cellStarts[_enemyCells[e] + 1]++;
+    }
+    for (size_t c = 1; c < _cellStarts.size(); c++)
+    {
+        _cellStarts[c] += _cellStarts[c - 1];
+    }
+    for (size_t e = 0; e < enemiesCount; e++)
+    {
+        // Starts are shifted by one cell while scattering, and end up in place
+        _cellEnemies[_cellStarts[_enemyCells[e]]++] = (uint32_t)e;
+    }
+    for (size_t c = _cellStarts.size() - 1; c > 0; c--)
+    {
+        _cellStarts[c] = _cellStarts[c - 1];
+    }
+    _cellStarts[0] = 0;
+}
+
+uint32_t ProjectileSystem::Advance(
+    size_t p,
+    Entity const& player,
+    ObjectPool<Entity>& enemies,
+    Arena const& arena)
+{
+    sf::Vector2f const from(_xs[p], _ys[p]);
+    sf::Vector2f const delta(_velocityXs[p], _velocityYs[p]);
+    sf::Vector2f const to = from + delta;
+    _xs[p] = to.x;
+    _ys[p] = to.y;
+
+    if (!arena.HasLineOfSight(from, to))
+    {
+        return REMOVED;
+    }
+
+    if (_teams[p] == Team::Enemies)
+    {
+        if (player.IsAlive() && SweepCircle(from, delta, player.GetPosition(), player.GetFaceRadius() + _radius) >= 0.f)
+        {
+            return PLAYER_TARGET;
+        }
+    }
+    else
+    {
+        // Only cells around the path can hold enemies that the projectile reaches
+        float const reach = _enemyRadius + _radius;
+        int const left = std::max(0, (int)((std::min(from.x, to.x) - reach) / CELL_SIZE));
+        int const right = std::min(_columns - 1, (int)((std::max(from.x, to.x) + reach) / CELL_SIZE));
+        int const top = std::max(0, (int)((std::min(from.y, to.y) - reach) / CELL_SIZE));
+        int const bottom = std::min(_rows - 1, (int)((std::max(from.y, to.y) + reach) / CELL_SIZE));
+
+        uint32_t target = NO_TARGET;
+        float targetTime = 2.f;
+        for (int row = top; row <= bottom; row++)
+        {
+            for (int column = left; column <= right; column++)
+            {
+                int const cell = row * _columns + column;
+                for (uint32_t i = _cellStarts[cell]; i < _cellStarts[cell + 1]; i++)
+                {
+                    uint32_t const e = _cellEnemies[i];
+                    float const time = SweepCircle(from, delta, {_enemyXs[e], _enemyYs[e]}, reach);
+                    // Ties go to the lower index, so the result doesn't depend on the order of cells
+                    if (time >= 0.f && (time < targetTime || (time == targetTime && e < target))
+                        && enemies.GetActive(e).IsAlive())
+                    {
+                        target = e;
+                        targetTime = time;
+                    }
+                }
+            }
+        }
+        if (target != NO_TARGET)
+        {
+            return target;
+        }
+    }
+
+    _ticksLeft[p]--;
+    if (_ticksLeft[p] == 0 || to.x < 0.f || to.y < 0.f || to.x > _areaSize.x || to.y > _areaSize.y)
+    {
+        return REMOVED;
+    }
+    return NO_TARGET;
+}
+
+void ProjectileSystem::RecordHit(
+    size_t p,
+    Entity& target,
+    CommandQueue& commandQueue,
+    GameEventBus& eventBus)
+{
+    Commands::Command command{};
+    command.targetId = target.GetId();
+    command.sourceId = _throwerIds[p];
+    command.target = &target;
+
+    command.type = Commands::Command::Type::Damage;
+    command.sequence = PROJECTILE_SEQUENCE_BIT | _serials[p];
+    command.damage = PROJECTILE_DAMAGE;
+    commandQueue.Record(command);
+
+    float const speed = std::hypot(_velocityXs[p], _velocityYs[p]);
+    command.type = Commands::Command::Type::Knockback;
+    command.direction = sf::Vector2f(_velocityXs[p], _velocityYs[p]) / speed;
+    commandQueue.Record(command);
+
+    command.type = Commands::Command::Type::PlayAnimation;
+    command.animation = Commands::Animation::GetPunched;
+    commandQueue.Record(command);
+
+    // The thrower may be gone by the time the fist lands, so there is no attacker
+    eventBus.Publish(Events::Hit{nullptr, &target, PROJECTILE_DAMAGE});
+}
+
+void ProjectileSystem::Remove(size_t p)
+{
+    size_t const last = --_count;
+    _xs[p] = _xs[last];
+    _ys[p] = _ys[last];
+    _velocityXs[p] = _velocityXs[last];
+    _velocityYs[p] = _velocityYs[last];
+    _ticksLeft[p] = _ticksLeft[last];
+    _teams[p] = _teams[last];
+    _throwerIds[p] = _throwerIds[last];
+    _serials[p] = _serials[last];
+    _targets[p] = _targets[last];
+}
+
+void ProjectileSystem::BuildVertices(size_t begin, size_t end)
+{
+    sf::Vector2f const& textureSize = _imageSize;
+    for (size_t p = begin; p < end; p++)
+    {
+        float const left = _xs[p] - _size.x / 2.f;
+        float const top = _ys[p] - _size.y / 2.f;
+        sf::Vertex* quad = &_vertices[p * 4];
+        quad[0] = sf::Vertex({left, top}, {0.f, 0.f});
+        quad[1] = sf::Vertex({left + _size.x, top}, {textureSize.x, 0.f});
+        quad[2] = sf::Vertex({left + _size.x, top + _size.y}, textureSize);
+        quad[3] = sf::Vertex({left, top + _size.y}, {0.f, textureSize.y});
+    }
+}
+
+} // namespace FaceFight
@@ -0,0 +1,303 @@
+#pragma once
+
+#include "../Arena/Arena.h"
+#include "../Commands/CommandQueue.h"
+#include "../Entities/Entity.h"
+#include "../Events/Events.hpp"
+#include "../Parallel/ThreadPool.h"
+#include "../Pools/ObjectPool.hpp"
+#include "../Serialization/ByteBuffer.h"
+
+#include <SFML/Graphics.hpp>
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace FaceFight
+{
+
+/**
+ * A class for fists thrown as projectiles.
+ * 
+ * Projectiles are kept as a structure of arrays, packed densely,
+ * so a dead projectile's slot is reused by moving the last projectile into it,
+ * and no memory is allocated after the system is created.
+ * 
+ * Each update advances the projectiles by exactly one tick.
+ * A projectile sweeps the segment it travels on that tick against the entities,
+ * so even the fastest fists can't pass through an entity between two ticks.
+ * Enemies are found through a uniform grid built every tick,
+ * so each projectile only tests the enemies near its path.
+ * 
+ * All projectiles are drawn at once, from a single vertex array.
+ */
+class ProjectileSystem
+{
+
+  public:
+
+    /// The side that threw a projectile, projectiles only hit the other side
+    enum class Team : uint8_t { Player, Enemies };
+
+  public:
+
+    /**
+     * Creates a projectile system, allocating all memory it will need
+     * 
+     * @param[in] capacity
+     *  Maximum number of projectiles in flight at the same time
+     * @param[in] enemiesCapacity
+     *  Maximum number of enemies that projectiles can hit, which is the capacity of their pool
+     * @param[in] areaSize
+     *  Size of the area in which projectiles fly, starting at (0, 0).
+     *  Projectiles that leave it are removed.
+     */
+    ProjectileSystem(
+        size_t capacity,
+        size_t enemiesCapacity,
+        sf::Vector2f const& areaSize
+    );
+
+    /**
+     * Sets the texture with which projectiles are drawn,
+     * which also sets the size of projectiles for collisions
+     * 
+     * @param[in] texture
+     *  Texture of a projectile
+     * @param[in] scale
+     *  Scale at which the texture is drawn
+     */
+    void SetTexture(
+        sf::Texture const& texture,
+        sf::Vector2f const& scale
+    );
+
+    /**
+     * Sets the size of projectiles for collisions without a texture,
+     * for projectiles that are never drawn, such as on a dedicated server.
+     * Vertices aren't built until a texture is set.
+     * 
+     * @param[in] imageSize
+     *  Size of the image of a projectile
+     * @param[in] scale
+     *  Scale at which the image would be drawn
+     */
+    void SetSize(
+        sf::Vector2u const& imageSize,
+        sf::Vector2f const& scale
+    );
+
+    /**
+     * Throws a new projectile
+     * 
+     * @param[in] team
+     *  The side that throws the projectile
+     * @param[in] throwerId
+     *  ID of the thrower, recorded as the source of the projectile's hit
+     * @param[in] position
+     *  Initial position of the projectile's center
+     * @param[in] velocity
+     *  Velocity of the projectile, in pixels per tick
+     * 
+     * @return whether the projectile was thrown,
+     *  false if the system is already at its capacity
+     */
+    bool Throw(
+        Team team,
+        uint32_t throwerId,
+        sf::Vector2f const& position,
+        sf::Vector2f const& velocity
+    );
+
+    /**
+     * Advances all projectiles by one tick.
+     * Projectiles that hit an entity record damage, knockback and animation
+     * on the command queue, and publish a hit event.
+     * Projectiles that hit an obstacle, leave the area or run out of time are removed.
+     * 
+     * @param[in] player
+     *  The player, the only target of the enemies' projectiles
+     * @param[in] enemies
+     *  Pool of enemies, the targets of the player's projectiles
+     * @param[in] arena
+     *  The arena, whose obstacles stop projectiles
+     * @param[in] commandQueue
+     *  Queue where the hits are recorded
+     * @param[in] eventBus
+     *  Event bus where the hits are published
+     * @param[in] threadPool
+     *  Threads among which the projectiles are split
+     */
+    void Update(
+        Entity& player,
+        ObjectPool<Entity>& enemies,
+        Arena const& arena,
+        CommandQueue& commandQueue,
+        GameEventBus& eventBus,
+        ThreadPool& threadPool
+    );
+
+    /**
+     * Copies the quads of all projectiles, as of the last update, to be drawn with the projectiles' texture
+     * 
+     * @param[in] vertices
+     *  Vertices of a render snapshot, replaced by the quads
+     */
+    void CaptureVertices(std::vector<sf::Vertex>& vertices) const;
+
+    /**
+     * Returns the number of projectiles in flight
+     */
+    size_t GetCount() const;
+
+    /**
+     * Returns the position of the center of a projectile in flight
+     * 
+     * @param[in] p
+     *  Index of the projectile, less than GetCount()
+     */
+    sf::Vector2f GetPosition(size_t p) const;
+
+    /**
+     * Returns the team that threw a projectile in flight
+     * 
+     * @param[in] p
+     *  Index of the projectile, less than GetCount()
+     */
+    Team GetTeam(size_t p) const;
+
+    /**
+     * Replaces the projectiles with ones seen elsewhere, such as on a server,
+     * only to be drawn, without simulating them
+     * 
+     * @param[in] positions
+     *  Positions of the centers of the projectiles
+     * @param[in] count
+     *  Number of projectiles, at most the capacity
+     */
+    void ShowSeen(sf::Vector2f const* positions, size_t count);
+
+    /**
+     * Writes the projectiles in flight to a buffer
+     * 
+     * @param[in] buffer
+     *  Buffer to which the projectiles are written
+     */
+    void Save(ByteBuffer& buffer) const;
+
+    /**
+     * Reads projectiles written by Save() from a buffer, replacing the ones in flight.
+     * They are drawn as they were read after the next update.
+     * 
+     * @param[in] buffer
+     *  Buffer from which the projectiles are read
+     */
+    void Load(ByteBuffer& buffer);
+
+  private: /* functions */
+
+    /**
+     * Puts the enemies in the grid, sorted by cell
+     */
+    void BuildGrid(ObjectPool<Entity>& enemies);
+
+    /**
+     * Moves a projectile by one tick, and finds what it hits
+     * 
+     * @return the enemy index, PLAYER_TARGET, NO_TARGET or REMOVED
+     */
+    uint32_t Advance(
+        size_t p,
+        Entity const& player,
+        ObjectPool<Entity>& enemies,
+        Arena const& arena
+    );
+
+    /**
+     * Records the hit of a projectile on a target, and publishes it
+     */
+    void RecordHit(
+        size_t p,
+        Entity& target,
+        CommandQueue& commandQueue,
+        GameEventBus& eventBus
+    );
+
+    /**
+     * Removes a projectile, by moving the last projectile into its place
+     */
+    void Remove(size_t p);
+
+    /**
+     * Builds the quads of the projectiles in the given range
+     */
+    void BuildVertices(size_t begin, size_t end);
+
+  private: /* variables */
+
+    /// Outcomes of a tick for a projectile that didn't hit an enemy
+    static constexpr uint32_t NO_TARGET = UINT32_MAX;
+    static constexpr uint32_t PLAYER_TARGET = UINT32_MAX - 1;
+    static constexpr uint32_t REMOVED = UINT32_MAX - 2;
+
+    /// Maximum number of projectiles
+    size_t _capacity;
+
+    /// Size of the area in which projectiles fly
+    sf::Vector2f _areaSize;
+
+    /// Texture, size of its image, and size of a drawn projectile
+    sf::Texture const* _texture;
+    sf::Vector2f _imageSize;
+    sf::Vector2f _size;
+
+    /// Radius of a projectile, for collisions
+    float _radius;
+
+    /// Positions, velocities and remaining ticks of all projectiles
+    std::vector<float> _xs;
+    std::vector<float> _ys;
+    std::vector<float> _velocityXs;
+    std::vector<float> _velocityYs;
+    std::vector<uint32_t> _ticksLeft;
+
+    /// Team, thrower and serial number of all projectiles
+    std::vector<Team> _teams;
+    std::vector<uint32_t> _throwerIds;
+    std::vector<uint32_t> _serials;
+
+    /// What each projectile hit on the current tick
+    std::vector<uint32_t> _targets;
+
+    /// Number of projectiles in flight
+    size_t _count;
+
+    /// Serial number of the next thrown projectile
+    uint32_t _nextSerial;
+
+    /// Number of columns and rows of the enemy grid
+    int _columns;
+    int _rows;
+
+    /// Positions of the enemies, gathered for the grid
+    std::vector<float> _enemyXs;
+    std::vector<float> _enemyYs;
+
+    /// Where the enemies of each cell begin in the sorted list, and one past the last cell
+    std::vector<uint32_t> _cellStarts;
+
+    /// Indices of the enemies, sorted by cell
+    std::vector<uint32_t> _cellEnemies;
+
+    /// Cell of each enemy
+    std::vector<uint32_t> _enemyCells;
+
+    /// Radius of the enemies' faces, on the current tick
+    float _enemyRadius;
+
+    /// Quads of all projectiles
+    sf::VertexArray _vertices;
+};
+
+} // namespace FaceFight
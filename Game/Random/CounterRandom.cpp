@@ -0,0 +1,109 @@
+#include "CounterRandom.h"
+
+namespace
+{
+
+/// Multipliers of the Philox rounds
+uint32_t const PHILOX_M0 = 0xD2511F53;
+uint32_t const PHILOX_M1 = 0xCD9E8D57;
+
+/// Constants by which the key is bumped after each round
+uint32_t const PHILOX_W0 = 0x9E3779B9;
+uint32_t const PHILOX_W1 = 0xBB67AE85;
+
+int const PHILOX_ROUNDS = 10;
+
+/// Only the lower bits of the first counter word hold the purpose, the rest count blocks
+uint32_t const PURPOSE_MASK = 0xFFFF;
+int const BLOCK_SHIFT = 16;
+
+/**
+ * Multiplies two 32-bit numbers, and returns the higher and lower half of the result
+ */
+void MultiplyHighLow(uint32_t a, uint32_t b, uint32_t& high, uint32_t& low)
+{
+    uint64_t const product = (uint64_t)a * b;
+    high = (uint32_t)(product >> 32);
+    low = (uint32_t)product;
+}
+
+} // namespace
+
+CounterRandom::CounterRandom(uint64_t seed)
+    : _seed(seed),
+    _key{(uint32_t)seed, (uint32_t)(seed >> 32)}
+{}
+
+CounterRandom::Stream CounterRandom::GetStream(
+    uint32_t entity, uint64_t tick, uint32_t purpose) const
+{
+    return Stream(_key, {
+        purpose & PURPOSE_MASK,
+        entity,
+        (uint32_t)tick,
+        (uint32_t)(tick >> 32)
+    });
+}
+
+uint64_t CounterRandom::GetSeed() const
+{
+    return _seed;
+}
+
+std::array<uint32_t, 4> CounterRandom::Philox(
+    std::array<uint32_t, 4> counter,
+    std::array<uint32_t, 2> key)
+{
+    for (int r = 0; r < PHILOX_ROUNDS; r++)
+    {
+        uint32_t high0, low0, high1, low1;
+        MultiplyHighLow(PHILOX_M0, counter[0], high0, low0);
+        MultiplyHighLow(PHILOX_M1, counter[2], high1, low1);
+        counter = {
+            high1 ^ counter[1] ^ key[0],
+            low1,
+            high0 ^ counter[3] ^ key[1],
+            low0
+        };
+        key[0] += PHILOX_W0;
+        key[1] += PHILOX_W1;
+    }
+    return counter;
+}
+
+CounterRandom::Stream::Stream(
+    std::array<uint32_t, 2> const& key,
+    std::array<uint32_t, 4> const& counter)
+    : _key(key),
+    _counter(counter),
+    _block{},
+    _used(4) // no block has been generated yet
+{}
+
+uint32_t CounterRandom::Stream::NextUInt()
+{
+    if (_used == 4)
+    {
+        _block = Philox(_counter, _key);
+        _counter[0] += 1 << BLOCK_SHIFT;
+        _used = 0;
+    }
+    return _block[_used++];
+}
+
+uint32_t CounterRandom::Stream::NextUInt(uint32_t bound)
+{
+    // Taking the higher half of the product avoids the bias of the modulo towards small numbers
+    return (uint32_t)(((uint64_t)NextUInt() * bound) >> 32);
+}
+
+float CounterRandom::Stream::NextFloat()
+{
+    // 24 bits fit exactly into a float, so the result is never rounded up to 1
+    return (NextUInt() >> 8) * (1.f / (1 << 24));
+}
+
+float CounterRandom::Stream::NextFloat(float min, float max)
+{
+    return min + NextFloat() * (max - min);
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+/**
+ * A class for a counter-based random number generator, in the style of Philox.
+ * 
+ * Random numbers aren't drawn from a shared, changing state.
+ * Each number is a pure function of a seed and a counter,
+ * the counter being made of the entity, the tick and the purpose of the numbers.
+ * So any part of the game, on any thread and in any order,
+ * can draw random numbers without locks,
+ * and gets the same numbers every time the same match is played with the same seed.
+ */
+class CounterRandom
+{
+
+  public:
+
+    /**
+     * A stream of random numbers for a single entity, tick and purpose.
+     * Streams are cheap to create and are supposed to be used locally,
+     * then thrown away.
+     */
+    class Stream
+    {
+
+      public:
+
+        /**
+         * Returns the next random number of the stream,
+         * uniformly distributed over all 32-bit values
+         */
+        uint32_t NextUInt();
+
+        /**
+         * Returns the next random number of the stream,
+         * uniformly distributed in the range [0, bound)
+         * 
+         * @param[in] bound
+         *  Upper bound of the number, exclusive. Has to be greater than 0.
+         */
+        uint32_t NextUInt(uint32_t bound);
+
+        /**
+         * Returns the next random number of the stream,
+         * uniformly distributed in the range [0, 1)
+         */
+        float NextFloat();
+
+        /**
+         * Returns the next random number of the stream,
+         * uniformly distributed in the range [min, max)
+         * 
+         * @param[in] min
+         *  Lower bound of the number, inclusive
+         * @param[in] max
+         *  Upper bound of the number, exclusive
+         */
+        float NextFloat(float min, float max);
+
+      private:
+
+        friend class CounterRandom;
+
+        /**
+         * Creates a stream with the given key and counter.
+         * Streams are created through CounterRandom::GetStream()
+         */
+        Stream(std::array<uint32_t, 2> const& key, std::array<uint32_t, 4> const& counter);
+
+      private:
+
+        /// Key of the generator, made from the seed
+        std::array<uint32_t, 2> _key;
+
+        /// Counter of the next block of numbers
+        std::array<uint32_t, 4> _counter;
+
+        /// The last generated block of numbers
+        std::array<uint32_t, 4> _block;
+
+        /// Number of numbers of the last block that have been used
+        uint32_t _used;
+    };
+
+  public:
+
+    /**
+     * Creates a generator with the given seed
+     * 
+     * @param[in] seed
+     *  Seed of the match, the same seed gives the same numbers
+     */
+    CounterRandom(uint64_t seed);
+
+    /**
+     * Returns a stream of random numbers.
+     * The same arguments always give the same stream,
+     * and different arguments give unrelated streams.
+     * 
+     * @param[in] entity
+     *  ID of the entity the numbers are drawn for
+     * @param[in] tick
+     *  Tick of the simulation on which the numbers are drawn
+     * @param[in] purpose
+     *  What the numbers are used for, so that different systems
+     *  drawing for the same entity on the same tick get different numbers.
+     *  Only the lower 16 bits are used.
+     */
+    Stream GetStream(uint32_t entity, uint64_t tick, uint32_t purpose) const;
+
+    /**
+     * Returns the seed of the generator
+     */
+    uint64_t GetSeed() const;
+
+    /**
+     * Generates a block of random numbers from a counter and a key,
+     * with 10 rounds of Philox4x32
+     * 
+     * @param[in] counter
+     *  The counter of the block
+     * @param[in] key
+     *  The key of the generator
+     * 
+     * @return the block of four random numbers
+     */
+    static std::array<uint32_t, 4> Philox(
+        std::array<uint32_t, 4> counter,
+        std::array<uint32_t, 2> key
+    );
+
+  private:
+
+    /// Seed of the generator
+    uint64_t _seed;
+
+    /// Key made from the seed
+    std::array<uint32_t, 2> _key;
+};
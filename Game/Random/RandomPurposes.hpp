@@ -0,0 +1,26 @@
+/* A file containing the purposes for which the game draws random numbers */
+
+#pragma once
+
+#include <cstdint>
+
+namespace FaceFight
+{
+
+/**
+ * What random numbers are drawn for.
+ * Each purpose gets its own streams, so adding a new purpose
+ * never changes the numbers drawn for the existing ones.
+ * New purposes have to be added at the end.
+ */
+enum class RandomPurpose : uint32_t
+{
+    CriticalPunch,
+    PunchCooldown,
+    SpawnPosition,
+    BalanceSample,
+    PlannerRollout,
+    BehaviorChance
+};
+
+} // namespace FaceFight
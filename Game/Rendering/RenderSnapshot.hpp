@@ -0,0 +1,61 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+
+#include <string>
+#include <vector>
+
+namespace FaceFight
+{
+
+/// A textured rectangle to be drawn, placed where the simulation left it
+struct RenderSprite
+{
+    /// Texture of the sprite, and the part of it that is drawn
+    sf::Texture const* texture;
+    sf::IntRect textureRect;
+
+    /// Color the texture is multiplied by
+    sf::Color color;
+
+    /// Transform from the sprite's own coordinates to the window
+    sf::Transform transform;
+};
+
+/// Values shown by the HUD
+struct HudState
+{
+    /// Health of the player, and of the opponent in every mode but survival
+    int playerHealth = 0;
+    int enemyHealth = 0;
+
+    /// Indicates whether the wave is shown, instead of the opponent's health, in survival mode
+    bool showWave = false;
+    int wave = 0;
+
+    /// Text telling who won, empty while the fight goes on
+    sf::String winnerString;
+
+    /// Indicates whether the stats text is shown, and the text itself
+    bool showStats = false;
+    std::string statsString;
+};
+
+/**
+ * Everything needed to draw a frame, copied out of the match by the simulation thread,
+ * so that the render thread doesn't touch anything the simulation changes.
+ * Snapshots are reused from frame to frame, so their vectors keep their memory.
+ */
+struct RenderSnapshot
+{
+    /// Faces and fists, in the order they are drawn
+    std::vector<RenderSprite> sprites;
+
+    /// Quads of the thrown fists, textured by the fist texture
+    std::vector<sf::Vertex> projectileVertices;
+
+    /// Values shown by the HUD
+    HudState hud;
+};
+
+} // namespace FaceFight
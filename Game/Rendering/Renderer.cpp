@@ -0,0 +1,245 @@
+#include "Renderer.h"
+
+#include "../Entities/Entity.h"
+
+#include <cmath>
+
+namespace
+{
+
+float const WINNER_TEXT_OFFSET = 20.f;
+
+unsigned const WINNER_TEXT_SIZE = 100;
+
+sf::Color const WINNER_TEXT_BACKGROUND_COLOR = sf::Color(100, 100, 100, 200);
+
+unsigned const WAVE_TEXT_SIZE = 60;
+
+unsigned const STATS_TEXT_SIZE = 24;
+
+} // namespace
+
+namespace FaceFight
+{
+
+Renderer::Renderer(
+    sf::RenderWindow& window,
+    Arena const& arena,
+    sf::Texture const& projectileTexture,
+    sf::Font const& font)
+    : _window(window),
+    _windowSize(window.getSize()),
+    _arena(arena),
+    _projectileTexture(projectileTexture),
+    _playerHealthBar(
+        sf::Vector2f(100.f, 50.f),
+        sf::Vector2f(500.f, 40.f),
+        Entity::MAX_HEALTH
+    ),
+    _enemyHealthBar(
+        sf::Vector2f(1320.f, 50.f),
+        sf::Vector2f(500.f, 40.f),
+        Entity::MAX_HEALTH
+    ),
+    _shownWave(-1),
+    _running(false),
+    _frameMicroseconds(0),
+    _drawCallsCount(0)
+{
+    _winnerText.setFont(font);
+    _winnerText.setCharacterSize(WINNER_TEXT_SIZE);
+    _winnerTextBackground.setFillColor(WINNER_TEXT_BACKGROUND_COLOR);
+
+    _waveText.setFont(font);
+    _waveText.setCharacterSize(WAVE_TEXT_SIZE);
+    _waveText.setPosition(sf::Vector2f(1320.f, 30.f));
+
+    _statsText.setFont(font);
+    _statsText.setCharacterSize(STATS_TEXT_SIZE);
+    _statsText.setPosition(sf::Vector2f(100.f, 100.f));
+}
+
+Renderer::~Renderer()
+{
+    Stop();
+}
+
+RenderSnapshot& Renderer::GetNextSnapshot()
+{
+    return _snapshots.GetBack();
+}
+
+void Renderer::Publish()
+{
+    _snapshots.Publish();
+}
+
+void Renderer::Start()
+{
+    if (_running)
+    {
+        return;
+    }
+    // A context can only be active on one thread at a time
+    _window.setActive(false);
+    _running = true;
+    _thread = std::thread(&Renderer::RenderLoop, this);
+}
+
+void Renderer::Stop()
+{
+    if (!_running)
+    {
+        return;
+    }
+    _running = false;
+    _thread.join();
+}
+
+sf::Time Renderer::GetFrameTime() const
+{
+    return sf::microseconds(_frameMicroseconds.load(std::memory_order_relaxed));
+}
+
+size_t Renderer::GetDrawCallsCount() const
+{
+    return _drawCallsCount.load(std::memory_order_relaxed);
+}
+
+void Renderer::RenderLoop()
+{
+    _window.setActive(true);
+    while (_running)
+    {
+        sf::Clock frameClock;
+        // Without a new snapshot, the last one is drawn again, as the back buffer doesn't keep the frame
+        if (_snapshots.Acquire())
+        {
+            BuildDrawList(_snapshots.GetFront());
+        }
+        RenderSnapshot const& snapshot = _snapshots.GetFront();
+        UpdateHud(snapshot.hud);
+        size_t const drawCallsCount = Draw(snapshot);
+        _frameMicroseconds.store(frameClock.getElapsedTime().asMicroseconds(), std::memory_order_relaxed);
+        _drawCallsCount.store(drawCallsCount, std::memory_order_relaxed);
+
+        // Waits for the screen here, while the simulation goes on
+        _window.display();
+    }
+    _window.setActive(false);
+}
+
+void Renderer::BuildDrawList(RenderSnapshot const& snapshot)
+{
+    std::vector<RenderSprite> const& sprites = snapshot.sprites;
+    _spriteVertices.resize(sprites.size() * 4);
+    _batches.clear();
+    for (size_t s = 0; s < sprites.size(); s++)
+    {
+        // Same quad as a sprite with this texture rectangle would draw
+        RenderSprite const& sprite = sprites[s];
+        sf::IntRect const& rect = sprite.textureRect;
+        float const width = (float)std::abs(rect.width);
+        float const height = (float)std::abs(rect.height);
+        float const left = (float)rect.left;
+        float const right = left + rect.width;
+        float const top = (float)rect.top;
+        float const bottom = top + rect.height;
+
+        sf::Vertex* const quad = &_spriteVertices[s * 4];
+        quad[0] = sf::Vertex(sprite.transform.transformPoint(0.f, 0.f), sprite.color, {left, top});
+        quad[1] = sf::Vertex(sprite.transform.transformPoint(0.f, height), sprite.color, {left, bottom});
+        quad[2] = sf::Vertex(sprite.transform.transformPoint(width, height), sprite.color, {right, bottom});
+        quad[3] = sf::Vertex(sprite.transform.transformPoint(width, 0.f), sprite.color, {right, top});
+
+        if (_batches.empty() || _batches.back().texture != sprite.texture)
+        {
+            _batches.push_back(Batch{sprite.texture, s * 4, 0});
+        }
+        _batches.back().count += 4;
+    }
+}
+
+void Renderer::UpdateHud(HudState const& hud)
+{
+    _playerHealthBar.SetHealth(hud.playerHealth);
+    _enemyHealthBar.SetHealth(hud.enemyHealth);
+
+    if (hud.wave != _shownWave)
+    {
+        _shownWave = hud.wave;
+        _waveText.setString("Wave " + std::to_string(_shownWave));
+    }
+
+    if (hud.winnerString != _winnerText.getString())
+    {
+        _winnerText.setString(hud.winnerString);
+        if (hud.winnerString.isEmpty())
+        {
+            // The fight isn't over, so neither the text nor its background is shown
+            _winnerTextBackground.setSize({0.f, 0.f});
+        }
+        else
+        {
+            _winnerText.setPosition(sf::Vector2f(
+                _windowSize.x / 2 - _winnerText.getGlobalBounds().width / 2,
+                _windowSize.y / 2 - _winnerText.getGlobalBounds().height / 2
+            ));
+            _winnerTextBackground.setSize({
+                _winnerText.getGlobalBounds().width + WINNER_TEXT_OFFSET * 2,
+                _winnerText.getGlobalBounds().height + WINNER_TEXT_OFFSET * 2});
+            _winnerTextBackground.setPosition({
+                _winnerText.getGlobalBounds().left - WINNER_TEXT_OFFSET,
+                _winnerText.getGlobalBounds().top - WINNER_TEXT_OFFSET});
+        }
+    }
+
+    if (hud.showStats && hud.statsString != _shownStats)
+    {
+        _shownStats = hud.statsString;
+        _statsText.setString(_shownStats);
+    }
+}
+
+size_t Renderer::Draw(RenderSnapshot const& snapshot)
+{
+    size_t drawCallsCount = 0;
+    _window.clear();
+
+    _arena.Draw(_window);
+    drawCallsCount++;
+
+    for (Batch const& batch : _batches)
+    {
+        _window.draw(&_spriteVertices[batch.begin], batch.count, sf::Quads, sf::RenderStates(batch.texture));
+        drawCallsCount++;
+    }
+
+    if (!snapshot.projectileVertices.empty())
+    {
+        _window.draw(snapshot.projectileVertices.data(), snapshot.projectileVertices.size(),
+            sf::Quads, sf::RenderStates(&_projectileTexture));
+        drawCallsCount++;
+    }
+
+    _playerHealthBar.Draw(_window);
+    if (!snapshot.hud.showWave)
+    {
+        _enemyHealthBar.Draw(_window);
+    }
+    else
+    {
+        _window.draw(_waveText);
+    }
+
+    _window.draw(_winnerTextBackground);
+    _window.draw(_winnerText);
+
+    if (snapshot.hud.showStats)
+    {
+        _window.draw(_statsText);
+    }
+    return drawCallsCount;
+}
+
+} // namespace FaceFight
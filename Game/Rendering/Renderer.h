@@ -0,0 +1,171 @@
+#pragma once
+
+#include "RenderSnapshot.hpp"
+
+#include "../Arena/Arena.h"
+#include "../Entities/HealthBar.h"
+#include "../Parallel/TripleBuffer.hpp"
+
+#include <SFML/Graphics.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace FaceFight
+{
+
+/**
+ * A class drawing the game on its own thread, from snapshots published by the simulation.
+ * 
+ * The simulation fills the next snapshot and publishes it once per tick, without ever waiting for a frame,
+ * while the render thread draws the latest snapshot, and waits for the screen on its own.
+ * The render thread owns the window's context and the HUD for as long as it runs,
+ * while the thread that created the window keeps handling its events.
+ */
+class Renderer
+{
+
+  public:
+
+    /**
+     * Creates a renderer for a window, which isn't rendering yet
+     * 
+     * @param[in] window
+     *  Window that is drawn to
+     * @param[in] arena
+     *  Arena drawn under everything else, which mustn't change while rendering
+     * @param[in] projectileTexture
+     *  Texture of the thrown fists
+     * @param[in] font
+     *  Font of the HUD's texts
+     */
+    Renderer(
+        sf::RenderWindow& window,
+        Arena const& arena,
+        sf::Texture const& projectileTexture,
+        sf::Font const& font
+    );
+
+    Renderer(Renderer const&) = delete;
+    Renderer& operator=(Renderer const&) = delete;
+
+    /// Stops rendering
+    ~Renderer();
+
+    /**
+     * Returns the snapshot that the simulation fills for the next frame.
+     * It holds whatever was in it when it was last drawn, so everything in it has to be written again.
+     */
+    RenderSnapshot& GetNextSnapshot();
+
+    /**
+     * Publishes the snapshot returned by GetNextSnapshot(),
+     * which is then drawn by the next frame that starts
+     */
+    void Publish();
+
+    /**
+     * Starts the render thread, which takes over the window's context.
+     * The calling thread must not draw to the window until rendering stops.
+     */
+    void Start();
+
+    /**
+     * Stops the render thread once it finishes its frame, if it is running,
+     * and waits for it to give up the window's context
+     */
+    void Stop();
+
+    /**
+     * Returns the time that building and drawing the last frame took,
+     * without waiting for the screen
+     */
+    sf::Time GetFrameTime() const;
+
+    /**
+     * Returns the number of draw calls that drew the match in the last frame, the HUD aside
+     */
+    size_t GetDrawCallsCount() const;
+
+  private: /* functions */
+
+    /// The loop of the render thread
+    void RenderLoop();
+
+    /**
+     * Builds the quads of all sprites of a snapshot,
+     * grouped into batches of consecutive sprites sharing a texture, drawn at once
+     */
+    void BuildDrawList(RenderSnapshot const& snapshot);
+
+    /**
+     * Makes the HUD show the values of a snapshot,
+     * touching only the parts whose values have changed
+     */
+    void UpdateHud(HudState const& hud);
+
+    /**
+     * Draws a snapshot to the window, after its draw list has been built
+     * 
+     * @return number of draw calls that drew the match
+     */
+    size_t Draw(RenderSnapshot const& snapshot);
+
+  private: /* variables */
+
+    /// Consecutive quads of the draw list sharing a texture
+    struct Batch
+    {
+        sf::Texture const* texture;
+        size_t begin;
+        size_t count;
+    };
+
+    /// Window that is drawn to, and its size
+    sf::RenderWindow& _window;
+    sf::Vector2f _windowSize;
+
+    /// Arena drawn under everything else
+    Arena const& _arena;
+
+    /// Texture of the thrown fists
+    sf::Texture const& _projectileTexture;
+
+    /// Snapshots passed from the simulation to the render thread
+    TripleBuffer<RenderSnapshot> _snapshots;
+
+    /// Quads of the sprites of the latest snapshot, and their batches
+    std::vector<sf::Vertex> _spriteVertices;
+    std::vector<Batch> _batches;
+
+    /// Health bar for player's health
+    HealthBar _playerHealthBar;
+
+    /// Health bar for enemy's health, used in every mode but survival
+    HealthBar _enemyHealthBar;
+
+    /// Text showing the current wave, used in survival mode, and the wave it shows
+    sf::Text _waveText;
+    int _shownWave;
+
+    /// Text telling who won, and the rectangle behind it
+    sf::Text _winnerText;
+    sf::RectangleShape _winnerTextBackground;
+
+    /// Text showing performance counters, and the string it shows
+    sf::Text _statsText;
+    std::string _shownStats;
+
+    /// The render thread, and whether it should keep running
+    std::thread _thread;
+    std::atomic<bool> _running;
+
+    /// Time that the last frame took, in microseconds, and its number of draw calls
+    std::atomic<int64_t> _frameMicroseconds;
+    std::atomic<size_t> _drawCallsCount;
+};
+
+} // namespace FaceFight
@@ -0,0 +1,111 @@
+#include "SceneNode.h"
+
+SceneNode::SceneNode(
+    SceneNode const* parent)
+    : _parent(parent),
+    _position(0.f, 0.f),
+    _scale(1.f, 1.f),
+    _localBounds(0.f, 0.f, 0.f, 0.f),
+    _dirty(true),
+    _worldVersion(0),
+    _parentWorldVersion(0),
+    _stats{0, 0}
+{}
+
+void SceneNode::SetParent(SceneNode const* parent)
+{
+    _parent = parent;
+    _dirty = true;
+}
+
+void SceneNode::SetPosition(sf::Vector2f const& position)
+{
+    // Setting the same position again doesn't invalidate the cache
+    if (position != _position)
+    {
+        _position = position;
+        _dirty = true;
+    }
+}
+
+sf::Vector2f const& SceneNode::GetPosition() const
+{
+    return _position;
+}
+
+void SceneNode::SetScale(sf::Vector2f const& scale)
+{
+    if (scale != _scale)
+    {
+        _scale = scale;
+        _dirty = true;
+    }
+}
+
+void SceneNode::SetLocalBounds(sf::FloatRect const& localBounds)
+{
+    _localBounds = localBounds;
+    _dirty = true;
+}
+
+sf::FloatRect const& SceneNode::GetLocalBounds() const
+{
+    return _localBounds;
+}
+
+sf::Transform const& SceneNode::GetWorldTransform() const
+{
+    UpdateWorld();
+    return _worldTransform;
+}
+
+sf::FloatRect const& SceneNode::GetWorldBounds() const
+{
+    UpdateWorld();
+    return _worldBounds;
+}
+
+SceneNode::Stats const& SceneNode::GetStats() const
+{
+    return _stats;
+}
+
+void SceneNode::ResetStats()
+{
+    _stats = {0, 0};
+}
+
+void SceneNode::UpdateWorld() const
+{
+    // Make sure the parent's world is up to date first, so that we can compare versions
+    if (_parent != nullptr)
+    {
+        _parent->UpdateWorld();
+    }
+
+    bool parentChanged = (_parent != nullptr && _parent->_worldVersion != _parentWorldVersion);
+    if (!_dirty && !parentChanged)
+    {
+        _stats.reused++;
+        return;
+    }
+
+    sf::Transform localTransform;
+    localTransform.translate(_position);
+    localTransform.scale(_scale);
+
+    if (_parent != nullptr)
+    {
+        _worldTransform = _parent->_worldTransform * localTransform;
+        _parentWorldVersion = _parent->_worldVersion;
+    }
+    else
+    {
+        _worldTransform = localTransform;
+    }
+    _worldBounds = _worldTransform.transformRect(_localBounds);
+
+    _dirty = false;
+    _worldVersion++;
+    _stats.recomputed++;
+}
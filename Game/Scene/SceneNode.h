@@ -0,0 +1,158 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+
+/**
+ * A class for a node in a lightweight transform hierarchy (scene graph).
+ * Each node has a local transform, relative to its parent node,
+ * and a world transform, which is the parent's world transform combined with the local one.
+ * Both transforms are cached, and the world transform is recomputed
+ * only when the node or one of its ancestors has changed since it was last computed.
+ * 
+ * Nodes can also cache their local bounds, so that their world bounds
+ * can be retrieved without transforming anything, as long as nothing has changed.
+ * 
+ * @sidenote: Parent nodes must outlive their children.
+ */
+class SceneNode
+{
+
+  public:
+
+    /**
+     * Counters of world transform computations, used to measure how well caching works.
+     * Each node counts its own, so nodes updated on different threads, or in different matches, share nothing.
+     */
+    struct Stats
+    {
+        /// Number of times a world transform had to be recomputed
+        size_t recomputed;
+        /// Number of times a cached world transform could be reused
+        size_t reused;
+    };
+
+  public:
+
+    /**
+     * Creates a node at the origin of its parent
+     * 
+     * @param[in] parent (optional)
+     *  Pointer to the parent node, or nullptr if the node is a root
+     */
+    SceneNode(
+        SceneNode const* parent = nullptr
+    );
+
+    /**
+     * Sets the parent of the node
+     * 
+     * @param[in] parent
+     *  Pointer to the parent node, or nullptr if the node is a root
+     */
+    void SetParent(SceneNode const* parent);
+
+    /**
+     * Sets the position of the node, relative to its parent
+     * 
+     * @param[in] position
+     *  Local position of the node
+     */
+    void SetPosition(sf::Vector2f const& position);
+
+    /**
+     * Returns the position of the node, relative to its parent
+     */
+    sf::Vector2f const& GetPosition() const;
+
+    /**
+     * Sets the scale of the node, relative to its parent
+     * 
+     * @param[in] scale
+     *  Local scale of the node in the x and y direction
+     */
+    void SetScale(sf::Vector2f const& scale);
+
+    /**
+     * Sets the bounds of the node in its local coordinate system.
+     * Supposed to be called when the contents of the node change,
+     * for example when a texture or a scale is assigned to a sprite.
+     * 
+     * @param[in] localBounds
+     *  Bounding rectangle of the node's contents, in local coordinates
+     */
+    void SetLocalBounds(sf::FloatRect const& localBounds);
+
+    /**
+     * Returns the bounds of the node in its local coordinate system
+     */
+    sf::FloatRect const& GetLocalBounds() const;
+
+    /**
+     * Returns the world transform of the node,
+     * recomputing it only if the node or an ancestor has changed
+     * 
+     * @return transform from node's local coordinates to world coordinates
+     */
+    sf::Transform const& GetWorldTransform() const;
+
+    /**
+     * Returns the bounds of the node in world coordinates,
+     * recomputing them only if the node or an ancestor has changed
+     * 
+     * @return bounding rectangle of the node's contents, in world coordinates
+     */
+    sf::FloatRect const& GetWorldBounds() const;
+
+    /**
+     * Returns the counters of world transform computations of this node,
+     * accumulated since the last call to ResetStats()
+     */
+    Stats const& GetStats() const;
+
+    /**
+     * Resets the counters of world transform computations of this node.
+     * Supposed to be called once each frame, to get per-frame counters.
+     */
+    void ResetStats();
+
+  private: /* functions */
+
+    /**
+     * Recomputes the world transform and world bounds,
+     * if the node or an ancestor has changed, otherwise reuses the cached ones
+     */
+    void UpdateWorld() const;
+
+  private: /* variables */
+
+    /// Parent of the node, or nullptr if the node is a root
+    SceneNode const* _parent;
+
+    /// Position of the node, relative to its parent
+    sf::Vector2f _position;
+
+    /// Scale of the node, relative to its parent
+    sf::Vector2f _scale;
+
+    /// Bounds of the node's contents, in local coordinates
+    sf::FloatRect _localBounds;
+
+    /// Cached world transform of the node
+    mutable sf::Transform _worldTransform;
+
+    /// Cached bounds of the node's contents, in world coordinates
+    mutable sf::FloatRect _worldBounds;
+
+    /// Tells us whether the node's local transform or bounds changed since the world was computed
+    mutable bool _dirty;
+
+    /* Incremented each time the world transform is recomputed,
+       so that children can tell if their parent has changed */
+    mutable unsigned _worldVersion;
+
+    /// Version of the parent's world transform, that our world transform is based on
+    mutable unsigned _parentWorldVersion;
+
+    /// Counters of world transform computations of this node
+    mutable Stats _stats;
+};
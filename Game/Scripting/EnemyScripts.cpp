@@ -0,0 +1,153 @@
+#include "EnemyScripts.h"
+
+#include "../Geometry/Geometry.hpp"
+
+#include <algorithm>
+
+namespace
+{
+
+// An enemy has arrived where it walks once it is this close
+float const ARRIVE_DIST = 5.f;
+
+// An enemy stops walking after this many ticks, as something must be in its way
+uint64_t const WALK_MAX_TICKS = FaceFight::Match::TICK_RATE * 5;
+
+// An enemy walks up to this fraction of the punch distance before it punches
+float const PUNCH_REACH = 0.8f;
+
+// Time for which an enemy taunts the player after walking in, before it starts fighting
+uint64_t const TAUNT_TICKS = FaceFight::Match::TICK_RATE / 2;
+
+// Time between the punches of a combo
+uint64_t const COMBO_GAP_TICKS = 8;
+
+// Number of punches in a round of a combo, before the thrown fist
+int const COMBO_PUNCHES = 3;
+
+// Time for which a boss rests after each round of its combo
+uint64_t const COMBO_REST_TICKS = FaceFight::Match::TICK_RATE;
+
+/**
+ * Returns an enemy that still exists and is alive, while the player is alive too, or null otherwise
+ */
+FaceFight::Entity const* GetFighting(FaceFight::Match const& match, ObjectPool<FaceFight::Entity>::Handle enemy)
+{
+    FaceFight::Entity const* const entity = match.GetEnemies().Get(enemy);
+    return entity != nullptr && entity->IsAlive() && match.GetPlayer().IsAlive() ? entity : nullptr;
+}
+
+/**
+ * Presses a button of a scripted enemy for a tick, and releases it for a tick,
+ * so that the next press counts as well
+ */
+Script Press(
+    ScriptScheduler& scripts,
+    FaceFight::Match& match,
+    ObjectPool<FaceFight::Entity>::Handle enemy,
+    bool punch,
+    bool throwFist)
+{
+    // Enemies may move around in their pool between ticks, so they are looked up again after every wait
+    FaceFight::Entity const* entity = GetFighting(match, enemy);
+    if (entity == nullptr)
+    {
+        co_return;
+    }
+    match.SetScriptedInput(enemy, FaceFight::FighterInput{entity->GetPosition(), punch, throwFist});
+    co_await scripts.WaitTicks(1);
+
+    entity = GetFighting(match, enemy);
+    if (entity == nullptr)
+    {
+        co_return;
+    }
+    match.SetScriptedInput(enemy, FaceFight::FighterInput{entity->GetPosition(), false, false});
+    co_await scripts.WaitTicks(1);
+}
+
+} // namespace
+
+namespace FaceFight
+{
+
+Script WalkTo(ScriptScheduler& scripts, Match& match, ObjectPool<Entity>::Handle enemy, sf::Vector2f target)
+{
+    for (uint64_t tick = 0; tick < WALK_MAX_TICKS; tick++)
+    {
+        Entity const* const entity = GetFighting(match, enemy);
+        if (entity == nullptr)
+        {
+            co_return;
+        }
+        sf::Vector2f const toTarget = Geometry::GetVector(entity->GetPosition(), target);
+        float const dist = Geometry::GetVectorLength(toTarget);
+        if (dist <= ARRIVE_DIST)
+        {
+            co_return;
+        }
+        float const step = std::min(dist, match.GetParameters().enemySpeed);
+        match.SetScriptedInput(enemy, FighterInput{entity->GetPosition() + toTarget / dist * step, false, false});
+        co_await scripts.WaitTicks(1);
+    }
+}
+
+Script PunchPlayer(ScriptScheduler& scripts, Match& match, ObjectPool<Entity>::Handle enemy)
+{
+    // The player keeps moving, so the enemy heads for where they are on each tick
+    for (uint64_t tick = 0; tick < WALK_MAX_TICKS; tick++)
+    {
+        Entity const* const entity = GetFighting(match, enemy);
+        if (entity == nullptr)
+        {
+            co_return;
+        }
+        sf::Vector2f const toPlayer = Geometry::GetVector(entity->GetPosition(), match.GetPlayer().GetPosition());
+        float const dist = Geometry::GetVectorLength(toPlayer);
+        if (dist <= PUNCH_REACH * match.GetParameters().punchDist)
+        {
+            co_await Press(scripts, match, enemy, true, false);
+            co_return;
+        }
+        float const step = std::min(dist, match.GetParameters().enemySpeed);
+        match.SetScriptedInput(enemy, FighterInput{entity->GetPosition() + toPlayer / dist * step, false, false});
+        co_await scripts.WaitTicks(1);
+    }
+}
+
+Script ThrowAtPlayer(ScriptScheduler& scripts, Match& match, ObjectPool<Entity>::Handle enemy)
+{
+    co_await Press(scripts, match, enemy, false, true);
+}
+
+Script WalkIn(ScriptScheduler& scripts, Match& match, ObjectPool<Entity>::Handle enemy, sf::Vector2f spot)
+{
+    match.SetEnemyScripted(enemy, true);
+
+    co_await WalkTo(scripts, match, enemy, spot);
+    // A punch at the air, from too far away to land
+    co_await Press(scripts, match, enemy, true, false);
+    co_await scripts.WaitTicks(TAUNT_TICKS);
+
+    match.SetEnemyScripted(enemy, false);
+}
+
+Script BossCombo(ScriptScheduler& scripts, Match& match, ObjectPool<Entity>::Handle enemy, int rounds)
+{
+    match.SetEnemyScripted(enemy, true);
+
+    for (int round = 0; round < rounds && GetFighting(match, enemy) != nullptr; round++)
+    {
+        for (int punch = 0; punch < COMBO_PUNCHES; punch++)
+        {
+            co_await PunchPlayer(scripts, match, enemy);
+            co_await scripts.WaitTicks(COMBO_GAP_TICKS);
+        }
+        co_await ThrowAtPlayer(scripts, match, enemy);
+        co_await scripts.WaitTicks(COMBO_REST_TICKS);
+    }
+
+    match.SetEnemyScripted(enemy, false);
+}
+
+} // namespace FaceFight
@@ -0,0 +1,83 @@
+/* A file containing scripted sequences of enemies, and the steps they are built of */
+
+#pragma once
+
+#include "ScriptScheduler.h"
+
+#include "../Match.h"
+
+#include <SFML/System.hpp>
+
+namespace FaceFight
+{
+
+/**
+ * Walks a scripted enemy to a point, at the enemy speed, until it gets there,
+ * or it has walked for so long that an obstacle must be in the way
+ * 
+ * @param[in] scripts
+ *  Scripts of the match
+ * @param[in] match
+ *  The match of the enemy
+ * @param[in] enemy
+ *  Handle of the enemy, which the awaiting script has to have handed over to scripts
+ * @param[in] target
+ *  Point to walk to
+ */
+Script WalkTo(ScriptScheduler& scripts, Match& match, ObjectPool<Entity>::Handle enemy, sf::Vector2f target);
+
+/**
+ * Walks a scripted enemy up to the player, and punches them once
+ * 
+ * @param[in] scripts
+ *  Scripts of the match
+ * @param[in] match
+ *  The match of the enemy
+ * @param[in] enemy
+ *  Handle of the enemy, which the awaiting script has to have handed over to scripts
+ */
+Script PunchPlayer(ScriptScheduler& scripts, Match& match, ObjectPool<Entity>::Handle enemy);
+
+/**
+ * Makes a scripted enemy throw its fist at the player, from wherever it is
+ * 
+ * @param[in] scripts
+ *  Scripts of the match
+ * @param[in] match
+ *  The match of the enemy
+ * @param[in] enemy
+ *  Handle of the enemy, which the awaiting script has to have handed over to scripts
+ */
+Script ThrowAtPlayer(ScriptScheduler& scripts, Match& match, ObjectPool<Entity>::Handle enemy);
+
+/**
+ * Intro of an enemy: it walks to a spot, taunts the player with a punch at the air,
+ * and then starts fighting like any other enemy
+ * 
+ * @param[in] scripts
+ *  Scripts of the match
+ * @param[in] match
+ *  The match of the enemy
+ * @param[in] enemy
+ *  Handle of the enemy
+ * @param[in] spot
+ *  Point where the enemy stops to taunt the player
+ */
+Script WalkIn(ScriptScheduler& scripts, Match& match, ObjectPool<Entity>::Handle enemy, sf::Vector2f spot);
+
+/**
+ * Combo of a boss enemy: rounds of three quick punches followed by a thrown fist, with a rest after each,
+ * after which the boss fights like any other enemy
+ * 
+ * @param[in] scripts
+ *  Scripts of the match
+ * @param[in] match
+ *  The match of the enemy
+ * @param[in] enemy
+ *  Handle of the enemy
+ * @param[in] rounds
+ *  Number of rounds of the combo
+ */
+Script BossCombo(ScriptScheduler& scripts, Match& match, ObjectPool<Entity>::Handle enemy, int rounds);
+
+} // namespace FaceFight
@@ -0,0 +1,76 @@
+#include "ScriptFramePool.h"
+
+#include <new>
+
+ScriptFramePool::ScriptFramePool(size_t blockSize, size_t blocksPerChunk)
+    : _blockSize((sizeof(Header) + blockSize + sizeof(Header) - 1) / sizeof(Header) * sizeof(Header)),
+    _blocksPerChunk(blocksPerChunk),
+    _freeHead(nullptr),
+    _usedCount(0),
+    _oversizedCount(0)
+{}
+
+void* ScriptFramePool::Allocate(size_t size)
+{
+    Header* header;
+    if (sizeof(Header) + size > _blockSize)
+    {
+        // Unusually large frames are rare enough not to be worth a block size of their own
+        header = static_cast<Header*>(::operator new(sizeof(Header) + size));
+        header->pool = nullptr;
+        _oversizedCount++;
+        return header + 1;
+    }
+
+    if (_freeHead == nullptr)
+    {
+        // Headers are as large as the alignment of blocks, so chunks are arrays of them
+        size_t const headersPerBlock = _blockSize / sizeof(Header);
+        _chunks.emplace_back(new Header[headersPerBlock * _blocksPerChunk]);
+        Header* const chunk = _chunks.back().get();
+        for (size_t b = _blocksPerChunk; b-- > 0;)
+        {
+            FreeBlock* const block = reinterpret_cast<FreeBlock*>(chunk + b * headersPerBlock);
+            block->next = _freeHead;
+            _freeHead = block;
+        }
+    }
+
+    FreeBlock* const block = _freeHead;
+    _freeHead = block->next;
+    header = reinterpret_cast<Header*>(block);
+    header->pool = this;
+    _usedCount++;
+    return header + 1;
+}
+
+void ScriptFramePool::Deallocate(void* frame)
+{
+    Header* const header = static_cast<Header*>(frame) - 1;
+    ScriptFramePool* const pool = header->pool;
+    if (pool == nullptr)
+    {
+        ::operator delete(header);
+        return;
+    }
+
+    FreeBlock* const block = reinterpret_cast<FreeBlock*>(header);
+    block->next = pool->_freeHead;
+    pool->_freeHead = block;
+    pool->_usedCount--;
+}
+
+size_t ScriptFramePool::GetUsedCount() const
+{
+    return _usedCount;
+}
+
+size_t ScriptFramePool::GetBlocksCount() const
+{
+    return _chunks.size() * _blocksPerChunk;
+}
+
+size_t ScriptFramePool::GetOversizedCount() const
+{
+    return _oversizedCount;
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <cstddef>
+
+/**
+ * A class for a pool of memory blocks holding the frames of script coroutines.
+ * 
+ * Blocks are all of the same size, and are carved out of chunks that are allocated
+ * only when every block is taken, and kept until the pool is destroyed.
+ * Freed blocks go to a free list, so once the pool has grown to the number of scripts
+ * that run at the same time, starting and finishing scripts never touches the global heap.
+ * Each frame is preceded by a header telling which pool it came from,
+ * and frames larger than a block come from the global heap instead.
+ * 
+ * The pool is not thread-safe, scripts are started and finished on a single thread.
+ */
+class ScriptFramePool
+{
+
+  public:
+
+    /**
+     * Creates an empty pool
+     * 
+     * @param[in] blockSize (optional)
+     *  Size of the largest frame that the pool holds, without the header
+     * @param[in] blocksPerChunk (optional)
+     *  Number of blocks allocated at once, when the pool grows
+     */
+    ScriptFramePool(
+        size_t blockSize = BLOCK_SIZE_DEFAULT,
+        size_t blocksPerChunk = BLOCKS_PER_CHUNK_DEFAULT
+    );
+
+    ScriptFramePool(ScriptFramePool const&) = delete;
+    ScriptFramePool& operator=(ScriptFramePool const&) = delete;
+
+    /**
+     * Returns memory for a frame, from a free block if it fits in one
+     * 
+     * @param[in] size
+     *  Size of the frame
+     */
+    void* Allocate(size_t size);
+
+    /**
+     * Returns the memory of a frame to where it came from,
+     * either the pool that allocated it, or the global heap
+     * 
+     * @param[in] frame
+     *  Memory returned by Allocate() of any pool
+     */
+    static void Deallocate(void* frame);
+
+    /**
+     * Returns the number of frames taken from the pool, and not returned yet
+     */
+    size_t GetUsedCount() const;
+
+    /**
+     * Returns the number of blocks of the pool, both taken and free
+     */
+    size_t GetBlocksCount() const;
+
+    /**
+     * Returns the number of frames that were too large for a block,
+     * and came from the global heap
+     */
+    size_t GetOversizedCount() const;
+
+  private:
+
+    /// The default size of a block, enough for scripts with a few local variables
+    static constexpr size_t BLOCK_SIZE_DEFAULT = 512;
+
+    /// The default number of blocks of a chunk
+    static constexpr size_t BLOCKS_PER_CHUNK_DEFAULT = 64;
+
+    /// Written before each frame, aligned so that the frame is aligned as well
+    struct alignas(std::max_align_t) Header
+    {
+        /// Pool that allocated the frame, or null for the global heap
+        ScriptFramePool* pool;
+    };
+
+    /// A free block, linked to the next free one
+    struct FreeBlock
+    {
+        FreeBlock* next;
+    };
+
+  private: /* variables */
+
+    /// Size of a block, header included, rounded up to keep every block aligned
+    size_t _blockSize;
+
+    /// Number of blocks allocated at once
+    size_t _blocksPerChunk;
+
+    /// Chunks of blocks, kept until the pool is destroyed
+    std::vector<std::unique_ptr<Header[]>> _chunks;
+
+    /// Head of the list of free blocks
+    FreeBlock* _freeHead;
+
+    /// Number of frames taken from the pool, and of frames taken from the global heap
+    size_t _usedCount;
+    size_t _oversizedCount;
+};
@@ -0,0 +1,172 @@
+#include "ScriptScheduler.h"
+
+#include <utility>
+
+Script::promise_type::FinalAwaiter::FinalAwaiter(promise_type& promise)
+    : _promise(promise)
+{}
+
+std::coroutine_handle<> Script::promise_type::FinalAwaiter::await_suspend(std::coroutine_handle<> handle) noexcept
+{
+    // An awaited script goes back to the script awaiting it, which then destroys it
+    if (_promise._continuation)
+    {
+        return _promise._continuation;
+    }
+
+    // A started script frees itself, its frame being unused from here on
+    ScriptScheduler& scheduler = *_promise._scheduler;
+    if (_promise._exception && !scheduler._failure)
+    {
+        scheduler._failure = _promise._exception;
+    }
+    scheduler.Unlink(_promise);
+    handle.destroy();
+    return std::noop_coroutine();
+}
+
+void Script::promise_type::unhandled_exception()
+{
+    _exception = std::current_exception();
+}
+
+void Script::promise_type::Resume()
+{
+    _handle.resume();
+}
+
+Script::promise_type::promise_type(ScriptScheduler& scheduler)
+    : _scheduler(&scheduler),
+    _prev(nullptr),
+    _next(nullptr)
+{}
+
+Script::Script(promise_type& promise)
+    : _promise(&promise)
+{}
+
+Script::Script(Script&& other) noexcept
+    : _promise(std::exchange(other._promise, nullptr))
+{}
+
+Script::~Script()
+{
+    if (_promise != nullptr)
+    {
+        _promise->_handle.destroy();
+    }
+}
+
+std::coroutine_handle<> Script::await_suspend(std::coroutine_handle<> awaiting) noexcept
+{
+    // The awaited script runs right away, and transfers back when it ends
+    _promise->_continuation = awaiting;
+    return _promise->_handle;
+}
+
+void Script::await_resume() const
+{
+    if (_promise->_exception)
+    {
+        std::rethrow_exception(_promise->_exception);
+    }
+}
+
+ScriptScheduler::TickAwaiter::TickAwaiter(ScriptScheduler& scheduler, uint64_t ticks)
+    : _scheduler(scheduler),
+    _ticks(ticks)
+{}
+
+ScriptScheduler::ScriptScheduler(size_t capacity)
+    : _wheel(capacity),
+    _runningHead(nullptr),
+    _runningCount(0)
+{}
+
+ScriptScheduler::~ScriptScheduler()
+{
+    StopAll();
+}
+
+void ScriptScheduler::Start(Script script)
+{
+    Script::promise_type& promise = *std::exchange(script._promise, nullptr);
+
+    // Every started script may be waiting, and the wheel grows by half again, so that it doesn't on every start
+    if (_runningCount >= _wheel.GetCapacity())
+    {
+        _wheel.Reserve(_runningCount + _runningCount / 2 + 1);
+    }
+
+    promise._next = _runningHead;
+    if (_runningHead != nullptr)
+    {
+        _runningHead->_prev = &promise;
+    }
+    _runningHead = &promise;
+    _runningCount++;
+
+    promise._handle.resume();
+    ThrowFailure();
+}
+
+ScriptScheduler::TickAwaiter ScriptScheduler::WaitTicks(uint64_t ticks)
+{
+    return TickAwaiter(*this, ticks);
+}
+
+void ScriptScheduler::Update()
+{
+    _wheel.Advance();
+    ThrowFailure();
+}
+
+void ScriptScheduler::StopAll()
+{
+    // Timers of the waiting scripts would otherwise resume destroyed frames
+    _wheel.Reset(_wheel.GetTick());
+    while (_runningHead != nullptr)
+    {
+        Script::promise_type& promise = *_runningHead;
+        Unlink(promise);
+        // Scripts that the destroyed one awaits are destroyed with its frame
+        promise._handle.destroy();
+    }
+}
+
+size_t ScriptScheduler::GetRunningCount() const
+{
+    return _runningCount;
+}
+
+ScriptFramePool const& ScriptScheduler::GetFramePool() const
+{
+    return _framePool;
+}
+
+void ScriptScheduler::Unlink(Script::promise_type& promise)
+{
+    if (promise._prev != nullptr)
+    {
+        promise._prev->_next = promise._next;
+    }
+    else
+    {
+        _runningHead = promise._next;
+    }
+    if (promise._next != nullptr)
+    {
+        promise._next->_prev = promise._prev;
+    }
+    promise._prev = nullptr;
+    promise._next = nullptr;
+    _runningCount--;
+}
+
+void ScriptScheduler::ThrowFailure()
+{
+    if (_failure)
+    {
+        std::rethrow_exception(std::exchange(_failure, nullptr));
+    }
+}
@@ -0,0 +1,328 @@
+#pragma once
+
+#include "ScriptFramePool.h"
+
+#include "../Timing/TimerWheel.h"
+
+#include <coroutine>
+#include <exception>
+#include <cstddef>
+#include <cstdint>
+
+class ScriptScheduler;
+
+/**
+ * A class for a script, a coroutine that plays out a sequence over many ticks,
+ * written as sequential code that waits with co_await.
+ * 
+ * The first parameter of every script is the scheduler that runs it,
+ * whose pool holds the script's frame, so starting a script doesn't touch the global heap:
+ * 
+ *     Script Combo(ScriptScheduler& scripts, ...)
+ *     {
+ *         co_await scripts.WaitTicks(30);
+ *         co_await Punch(scripts, ...);
+ *     }
+ * 
+ * A script does nothing until it is either started by the scheduler,
+ * or awaited by another script, which then continues once the awaited script ends.
+ */
+class Script
+{
+
+  public:
+
+    /**
+     * State of a script's coroutine, which lives in its frame.
+     * Scripts that take their scheduler first get a PooledPromise, which adds the frame's allocation,
+     * and the ones that don't are left with this one, and rejected, as they have nowhere to allocate from.
+     */
+    class promise_type
+    {
+
+        friend class Script;
+        friend class ScriptScheduler;
+
+      public:
+
+        /// Ends a script, either continuing the script that awaited it, or letting the scheduler free it
+        class FinalAwaiter
+        {
+
+          public:
+
+            explicit FinalAwaiter(promise_type& promise);
+
+            bool await_ready() const noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> handle) noexcept;
+            void await_resume() const noexcept {}
+
+          private: /* variables */
+
+            promise_type& _promise;
+        };
+
+      public:
+
+        static void* operator new(std::size_t size) = delete;
+
+        std::suspend_always initial_suspend() const noexcept { return {}; }
+        FinalAwaiter final_suspend() noexcept { return FinalAwaiter(*this); }
+        void return_void() const noexcept {}
+        void unhandled_exception();
+
+        /**
+         * Resumes the script from where it waits, called by the scheduler's timers
+         */
+        void Resume();
+
+      protected: /* functions */
+
+        /**
+         * Sets up the state of a script
+         * 
+         * @param[in] scheduler
+         *  Scheduler running the script, the script's first parameter
+         */
+        explicit promise_type(ScriptScheduler& scheduler);
+
+      protected: /* variables */
+
+        /// The script's coroutine, whose frame holds this state
+        std::coroutine_handle<> _handle;
+
+      private: /* variables */
+
+        /// Scheduler running the script
+        ScriptScheduler* _scheduler;
+
+        /// Script awaiting this one, if it was awaited
+        std::coroutine_handle<> _continuation;
+
+        /// Exception that ended the script, passed on to whoever awaits or runs it
+        std::exception_ptr _exception;
+
+        /// Neighbours in the scheduler's list of started scripts, while this one is started
+        promise_type* _prev;
+        promise_type* _next;
+    };
+
+    /**
+     * State of a script's coroutine, for a script with the given parameters after its scheduler.
+     * Its operators new and delete are plain members of the same class, rather than templates,
+     * so that compilers can tell that they match.
+     */
+    template <class... Args>
+    class PooledPromise : public promise_type
+    {
+
+      public:
+
+        /**
+         * Sets up the state of a script, with the parameters of the script
+         * 
+         * @param[in] scheduler
+         *  Scheduler running the script, the script's first parameter
+         */
+        PooledPromise(ScriptScheduler& scheduler, Args const&...);
+
+        /**
+         * Allocates the frame of a script from the pool of its scheduler,
+         * with the parameters of the script
+         */
+        static void* operator new(std::size_t size, ScriptScheduler& scheduler, Args const&...);
+
+        /// Returns the frame of a script to the pool it was allocated from
+        static void operator delete(void* frame, std::size_t size);
+
+        Script get_return_object();
+    };
+
+  public:
+
+    Script(Script&& other) noexcept;
+    Script& operator=(Script&&) = delete;
+    Script(Script const&) = delete;
+    Script& operator=(Script const&) = delete;
+
+    /// Destroys the script, unless it has been started, and so belongs to the scheduler
+    ~Script();
+
+    /// Awaiting a script runs it within the awaiting script, which continues once it ends
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept;
+    void await_resume() const;
+
+  private: /* functions */
+
+    explicit Script(promise_type& promise);
+
+  private: /* variables */
+
+    /// State of the script's coroutine, null once it has been handed over to the scheduler
+    promise_type* _promise;
+
+    friend class ScriptScheduler;
+};
+
+/**
+ * A class for running many scripts at the same time, advanced once per tick.
+ * 
+ * Waiting scripts are kept in a timing wheel, so a tick resumes only the scripts
+ * whose wait ends on it, however many scripts are waiting.
+ * A started script waits on one timer at most, whatever scripts it awaits,
+ * so the wheel grows with the number of started scripts, like the pool with their frames.
+ * Frames of scripts come from the scheduler's pool.
+ * Scripts live in their coroutines' frames, so they can't be saved in snapshots,
+ * and should be stopped whenever the state that they drive is replaced.
+ */
+class ScriptScheduler
+{
+
+    friend class Script;
+
+  public:
+
+    /// Awaited by a script to wait for a number of ticks
+    class TickAwaiter
+    {
+
+      public:
+
+        TickAwaiter(ScriptScheduler& scheduler, uint64_t ticks);
+
+        bool await_ready() const noexcept { return false; }
+        template <class Promise>
+        void await_suspend(std::coroutine_handle<Promise> handle);
+        void await_resume() const noexcept {}
+
+      private: /* variables */
+
+        ScriptScheduler& _scheduler;
+        uint64_t _ticks;
+    };
+
+  public:
+
+    /**
+     * Creates a scheduler without any scripts
+     * 
+     * @param[in] capacity
+     *  Number of scripts that can be started at the same time before the wheel has to grow
+     */
+    ScriptScheduler(size_t capacity);
+
+    ScriptScheduler(ScriptScheduler const&) = delete;
+    ScriptScheduler& operator=(ScriptScheduler const&) = delete;
+
+    /// Destroys the scripts that are still running
+    ~ScriptScheduler();
+
+    /**
+     * Starts a script, which runs until it first waits, right away.
+     * The scheduler takes the script over, and frees it when it ends.
+     * 
+     * @param[in] script
+     *  A script that hasn't run yet
+     */
+    void Start(Script script);
+
+    /**
+     * Returns what a script awaits to wait for a number of ticks
+     * 
+     * @param[in] ticks
+     *  Number of ticks to wait, where 0 is treated as 1, the rest of the current tick being gone
+     */
+    TickAwaiter WaitTicks(uint64_t ticks);
+
+    /**
+     * Advances by one tick, and resumes the scripts whose wait ends on it.
+     * An exception that ended a script is thrown again, after all the scripts of the tick have run.
+     * 
+     * This function is supposed to be called once each tick.
+     */
+    void Update();
+
+    /**
+     * Destroys all started scripts, whether they wait or not
+     */
+    void StopAll();
+
+    /**
+     * Returns the number of started scripts that haven't ended yet
+     */
+    size_t GetRunningCount() const;
+
+    /**
+     * Returns the pool holding the frames of scripts
+     */
+    ScriptFramePool const& GetFramePool() const;
+
+  private: /* functions */
+
+    /**
+     * Removes an ended or destroyed script from the list of started scripts
+     */
+    void Unlink(Script::promise_type& promise);
+
+    /**
+     * Throws the exception that ended a started script, if there was one
+     */
+    void ThrowFailure();
+
+  private: /* variables */
+
+    /// Timers of the waiting scripts
+    TimerWheel _wheel;
+
+    /// Pool holding the frames of scripts
+    ScriptFramePool _framePool;
+
+    /// Head of the list of started scripts
+    Script::promise_type* _runningHead;
+
+    /// Number of started scripts
+    size_t _runningCount;
+
+    /// Exception that ended a started script, thrown again by the scheduler
+    std::exception_ptr _failure;
+};
+
+template <class... Args>
+Script::PooledPromise<Args...>::PooledPromise(ScriptScheduler& scheduler, Args const&...)
+    : promise_type(scheduler)
+{}
+
+template <class... Args>
+void* Script::PooledPromise<Args...>::operator new(std::size_t size, ScriptScheduler& scheduler, Args const&...)
+{
+    return scheduler._framePool.Allocate(size);
+}
+
+template <class... Args>
+void Script::PooledPromise<Args...>::operator delete(void* frame, std::size_t)
+{
+    ScriptFramePool::Deallocate(frame);
+}
+
+template <class... Args>
+Script Script::PooledPromise<Args...>::get_return_object()
+{
+    _handle = std::coroutine_handle<PooledPromise>::from_promise(*this);
+    return Script(*this);
+}
+
+template <class Promise>
+void ScriptScheduler::TickAwaiter::await_suspend(std::coroutine_handle<Promise> handle)
+{
+    // The awaiting script is the innermost one, so it is the one that is resumed
+    Script::promise_type* const promise = &handle.promise();
+    _scheduler._wheel.Schedule<Script::promise_type, &Script::promise_type::Resume>(_ticks, promise);
+}
+
+/// Scripts that take their scheduler first get a promise that allocates their frames from its pool
+template <class... Args>
+struct std::coroutine_traits<Script, ScriptScheduler&, Args...>
+{
+    using promise_type = Script::PooledPromise<Args...>;
+};
@@ -0,0 +1,26 @@
+#include "BitReader.h"
+
+BitReader::BitReader(
+    ByteBuffer& buffer)
+    : _buffer(buffer),
+    _bits(0),
+    _bitsCount(0)
+{}
+
+uint32_t BitReader::Read(unsigned bits)
+{
+    while (_bitsCount < bits)
+    {
+        _bits |= (uint64_t)_buffer.Read<uint8_t>() << _bitsCount;
+        _bitsCount += 8;
+    }
+    uint32_t const value = (uint32_t)(_bits & ((uint64_t(1) << bits) - 1));
+    _bits >>= bits;
+    _bitsCount -= bits;
+    return value;
+}
+
+bool BitReader::ReadFlag()
+{
+    return Read(1) != 0;
+}
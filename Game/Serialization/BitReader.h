@@ -0,0 +1,51 @@
+#pragma once
+
+#include "ByteBuffer.h"
+
+#include <cstdint>
+
+/**
+ * A class for reading values packed bit by bit with a BitWriter,
+ * in the same order and with the same numbers of bits as they were written.
+ */
+class BitReader
+{
+
+  public:
+
+    /**
+     * Creates a reader that unpacks bits from the next bytes of the given buffer
+     * 
+     * @param[in] buffer
+     *  Buffer from which the bits are read
+     */
+    BitReader(ByteBuffer& buffer);
+
+    /**
+     * Reads a value
+     * 
+     * @param[in] bits
+     *  Number of bits of the value, at most 32
+     * 
+     * @return the value read
+     */
+    uint32_t Read(unsigned bits);
+
+    /**
+     * Reads a single bit
+     * 
+     * @return the bit read
+     */
+    bool ReadFlag();
+
+  private: /* variables */
+
+    /// Buffer from which the bits are read
+    ByteBuffer& _buffer;
+
+    /// Bits read from the buffer but not returned yet, from the lowest one
+    uint64_t _bits;
+
+    /// Number of bits read from the buffer but not returned yet
+    unsigned _bitsCount;
+};
@@ -0,0 +1,35 @@
+#include "BitWriter.h"
+
+BitWriter::BitWriter(
+    ByteBuffer& buffer)
+    : _buffer(buffer),
+    _bits(0),
+    _bitsCount(0)
+{}
+
+void BitWriter::Write(uint32_t value, unsigned bits)
+{
+    _bits |= (uint64_t)(value & (uint32_t)((uint64_t(1) << bits) - 1)) << _bitsCount;
+    _bitsCount += bits;
+    while (_bitsCount >= 8)
+    {
+        _buffer.Write((uint8_t)_bits);
+        _bits >>= 8;
+        _bitsCount -= 8;
+    }
+}
+
+void BitWriter::WriteFlag(bool value)
+{
+    Write(value ? 1 : 0, 1);
+}
+
+void BitWriter::Flush()
+{
+    if (_bitsCount > 0)
+    {
+        _buffer.Write((uint8_t)_bits);
+        _bits = 0;
+        _bitsCount = 0;
+    }
+}
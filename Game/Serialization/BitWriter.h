@@ -0,0 +1,59 @@
+#pragma once
+
+#include "ByteBuffer.h"
+
+#include <cstdint>
+
+/**
+ * A class for packing values into a byte buffer bit by bit,
+ * each value taking only as many bits as it needs.
+ * Bits are gathered in a word, and written to the buffer a byte at a time,
+ * so the writer has to be flushed after the last value.
+ */
+class BitWriter
+{
+
+  public:
+
+    /**
+     * Creates a writer that packs bits at the end of the given buffer
+     * 
+     * @param[in] buffer
+     *  Buffer to which the bits are written
+     */
+    BitWriter(ByteBuffer& buffer);
+
+    /**
+     * Writes the lowest bits of a value
+     * 
+     * @param[in] value
+     *  The value to be written, which has to fit in the given number of bits
+     * @param[in] bits
+     *  Number of bits to be written, at most 32
+     */
+    void Write(uint32_t value, unsigned bits);
+
+    /**
+     * Writes a single bit
+     * 
+     * @param[in] value
+     *  The bit to be written
+     */
+    void WriteFlag(bool value);
+
+    /**
+     * Writes the bits that don't fill a whole byte yet, padded with zeros
+     */
+    void Flush();
+
+  private: /* variables */
+
+    /// Buffer to which the bits are written
+    ByteBuffer& _buffer;
+
+    /// Bits that haven't been written to the buffer yet, from the lowest one
+    uint64_t _bits;
+
+    /// Number of bits that haven't been written to the buffer yet
+    unsigned _bitsCount;
+};
@@ -0,0 +1,55 @@
+#include "ByteBuffer.h"
+
+ByteBuffer::ByteBuffer(
+    size_t capacity)
+    : _data(new uint8_t[capacity]),
+    _capacity(capacity),
+    _size(0),
+    _readPosition(0)
+{}
+
+void ByteBuffer::Clear()
+{
+    _size = 0;
+    _readPosition = 0;
+}
+
+void ByteBuffer::Rewind()
+{
+    _readPosition = 0;
+}
+
+uint8_t const* ByteBuffer::GetData() const
+{
+    return _data.get();
+}
+
+size_t ByteBuffer::GetSize() const
+{
+    return _size;
+}
+
+size_t ByteBuffer::GetCapacity() const
+{
+    return _capacity;
+}
+
+void ByteBuffer::WriteBytes(void const* bytes, size_t count)
+{
+    if (count > _capacity - _size)
+    {
+        throw "Error: Byte buffer capacity exceeded.";
+    }
+    std::memcpy(_data.get() + _size, bytes, count);
+    _size += count;
+}
+
+void ByteBuffer::ReadBytes(void* bytes, size_t count)
+{
+    if (count > _size - _readPosition)
+    {
+        throw "Error: Reading past the end of a byte buffer.";
+    }
+    std::memcpy(bytes, _data.get() + _readPosition, count);
+    _readPosition += count;
+}
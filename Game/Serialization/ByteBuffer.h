@@ -0,0 +1,152 @@
+#pragma once
+
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+/**
+ * A class for a flat buffer of bytes, into which values are written one after another,
+ * and from which they are read back in the same order.
+ * 
+ * Only trivially copyable values can be written, and they are copied as they are in memory,
+ * so a buffer can only be read back by the same build of the program, on the same machine.
+ * That makes writing and reading as cheap as copying memory.
+ * 
+ * The buffer has a fixed capacity, allocated once when it is created,
+ * so writing to it never allocates memory, and it can be reused by clearing it.
+ */
+class ByteBuffer
+{
+
+  public:
+
+    /**
+     * Creates an empty buffer, allocating memory for the given number of bytes
+     * 
+     * @param[in] capacity
+     *  Maximum number of bytes that can be written to the buffer
+     */
+    ByteBuffer(size_t capacity);
+
+    ByteBuffer(ByteBuffer const&) = delete;
+    ByteBuffer& operator=(ByteBuffer const&) = delete;
+
+    /**
+     * Writes a value at the end of the buffer
+     * 
+     * @param[in] value
+     *  The value to be written
+     */
+    template <class T>
+    void Write(T const& value);
+
+    /**
+     * Writes an array of values at the end of the buffer
+     * 
+     * @param[in] values
+     *  Pointer to the first value to be written
+     * @param[in] count
+     *  Number of values to be written
+     */
+    template <class T>
+    void WriteArray(T const* values, size_t count);
+
+    /**
+     * Reads the next value from the buffer
+     * 
+     * @return the value read
+     */
+    template <class T>
+    T Read();
+
+    /**
+     * Reads the next array of values from the buffer
+     * 
+     * @param[in] values
+     *  Pointer to where the first value will be read
+     * @param[in] count
+     *  Number of values to be read
+     */
+    template <class T>
+    void ReadArray(T* values, size_t count);
+
+    /**
+     * Empties the buffer, so that it can be written again from the beginning
+     */
+    void Clear();
+
+    /**
+     * Moves reading back to the beginning of the buffer,
+     * so that what was written can be read again
+     */
+    void Rewind();
+
+    /**
+     * Returns a pointer to the bytes written to the buffer
+     */
+    uint8_t const* GetData() const;
+
+    /**
+     * Returns the number of bytes written to the buffer
+     */
+    size_t GetSize() const;
+
+    /**
+     * Returns the maximum number of bytes that can be written to the buffer
+     */
+    size_t GetCapacity() const;
+
+  private: /* functions */
+
+    /// Copies bytes to the end of the buffer
+    void WriteBytes(void const* bytes, size_t count);
+
+    /// Copies the next bytes from the buffer
+    void ReadBytes(void* bytes, size_t count);
+
+  private: /* variables */
+
+    /// Memory of the buffer
+    std::unique_ptr<uint8_t[]> _data;
+
+    /// Maximum number of bytes in the buffer
+    size_t _capacity;
+
+    /// Number of bytes written to the buffer
+    size_t _size;
+
+    /// Number of bytes read from the buffer since the last rewind
+    size_t _readPosition;
+};
+
+template <class T>
+void ByteBuffer::Write(T const& value)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable values can be written");
+    WriteBytes(&value, sizeof(T));
+}
+
+template <class T>
+void ByteBuffer::WriteArray(T const* values, size_t count)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable values can be written");
+    WriteBytes(values, sizeof(T) * count);
+}
+
+template <class T>
+T ByteBuffer::Read()
+{
+    static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable values can be read");
+    T value;
+    ReadBytes(&value, sizeof(T));
+    return value;
+}
+
+template <class T>
+void ByteBuffer::ReadArray(T* values, size_t count)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable values can be read");
+    ReadBytes(values, sizeof(T) * count);
+}
@@ -0,0 +1,90 @@
+#include "ColumnWriter.h"
+
+namespace
+{
+
+// Marks the beginning of a file
+uint32_t const COLUMNS_MAGIC = 0x46464354; // "FFCT"
+
+// Version of the file layout
+uint32_t const COLUMNS_VERSION = 1;
+
+/**
+ * Writes a value to a file as it is in memory
+ */
+template <class T>
+void WriteValue(std::ofstream& file, T const& value)
+{
+    file.write(reinterpret_cast<char const*>(&value), sizeof(T));
+}
+
+} // namespace
+
+ColumnWriter::ColumnWriter(
+    std::string const& filename,
+    std::vector<std::string> const& columns,
+    size_t rowsPerGroup)
+    : _file(filename, std::ios::binary | std::ios::trunc),
+    _columnsCount(columns.size()),
+    _rowsPerGroup(rowsPerGroup),
+    _group(columns.size() * rowsPerGroup),
+    _groupRowsCount(0),
+    _rowsCount(0)
+{
+    if (!_file)
+    {
+        throw "Error: Cannot create table file: " + filename;
+    }
+
+    WriteValue(_file, COLUMNS_MAGIC);
+    WriteValue(_file, COLUMNS_VERSION);
+    WriteValue(_file, (uint32_t)_columnsCount);
+    for (std::string const& column : columns)
+    {
+        WriteValue(_file, (uint32_t)column.size());
+        _file.write(column.data(), column.size());
+    }
+}
+
+ColumnWriter::~ColumnWriter()
+{
+    Flush();
+}
+
+void ColumnWriter::WriteRow(double const* values)
+{
+    for (size_t c = 0; c < _columnsCount; c++)
+    {
+        _group[c * _rowsPerGroup + _groupRowsCount] = values[c];
+    }
+    _groupRowsCount++;
+    _rowsCount++;
+
+    if (_groupRowsCount == _rowsPerGroup)
+    {
+        Flush();
+    }
+}
+
+void ColumnWriter::Flush()
+{
+    if (_groupRowsCount == 0)
+    {
+        return;
+    }
+
+    // Each column's values are already next to each other, only the unused rows are skipped
+    WriteValue(_file, (uint32_t)_groupRowsCount);
+    for (size_t c = 0; c < _columnsCount; c++)
+    {
+        _file.write(reinterpret_cast<char const*>(&_group[c * _rowsPerGroup]),
+            sizeof(double) * _groupRowsCount);
+    }
+    _file.flush();
+    _groupRowsCount = 0;
+}
+
+uint64_t ColumnWriter::GetRowsCount() const
+{
+    return _rowsCount;
+}
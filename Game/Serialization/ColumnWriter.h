@@ -0,0 +1,88 @@
+#pragma once
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * A class for a table of numbers streamed to a file column by column,
+ * so that a single column of a large table can be read without reading the rest.
+ * 
+ * Rows are gathered in memory into groups of a fixed number of rows,
+ * and each full group is written to the file with the values of each column one after another.
+ * The file starts with a header naming the columns, followed by the groups:
+ * 
+ *  - magic number 0x46464354 ("FFCT") and version, both as 32-bit integers,
+ *  - number of columns as a 32-bit integer,
+ *  - for each column, the length of its name as a 32-bit integer, followed by the name,
+ *  - for each group, the number of its rows as a 32-bit integer,
+ *    followed by that many doubles of each column in turn.
+ * 
+ * Numbers are written as they are in memory, so the file is read on a machine with the same byte order.
+ * The last group, which may not be full, is written when the writer is flushed or destroyed.
+ */
+class ColumnWriter
+{
+
+  public:
+
+    /**
+     * Creates the file and writes its header
+     * 
+     * @param[in] filename
+     *  Path of the file, which is overwritten if it exists
+     * @param[in] columns
+     *  Names of the columns
+     * @param[in] rowsPerGroup
+     *  Number of rows gathered in memory before they are written
+     */
+    ColumnWriter(std::string const& filename, std::vector<std::string> const& columns, size_t rowsPerGroup);
+
+    ColumnWriter(ColumnWriter const&) = delete;
+    ColumnWriter& operator=(ColumnWriter const&) = delete;
+
+    /**
+     * Writes the rows that haven't been written yet
+     */
+    ~ColumnWriter();
+
+    /**
+     * Adds a row at the end of the table
+     * 
+     * @param[in] values
+     *  Value of each column of the row
+     */
+    void WriteRow(double const* values);
+
+    /**
+     * Writes the rows gathered so far as a group, even if it isn't full
+     */
+    void Flush();
+
+    /**
+     * Returns the number of rows added so far
+     */
+    uint64_t GetRowsCount() const;
+
+  private: /* variables */
+
+    /// The file
+    std::ofstream _file;
+
+    /// Number of columns
+    size_t _columnsCount;
+
+    /// Number of rows in a full group
+    size_t _rowsPerGroup;
+
+    /// Values of the rows of the current group, column by column
+    std::vector<double> _group;
+
+    /// Number of rows in the current group
+    size_t _groupRowsCount;
+
+    /// Number of rows added so far
+    uint64_t _rowsCount;
+};
@@ -0,0 +1,208 @@
+#include "TimerWheel.h"
+
+TimerWheel::TimerWheel(
+    size_t capacity)
+    : _timers(capacity),
+    _freeHead(capacity > 0 ? 0 : NO_TIMER),
+    _tick(0)
+{
+    // Chain all timers in the free list
+    for (size_t t = 0; t < capacity; t++)
+    {
+        _timers[t].next = (t + 1 < capacity) ? t + 1 : NO_TIMER;
+        _timers[t].generation = 0;
+    }
+    _slotHeads.fill(NO_TIMER);
+}
+
+bool TimerWheel::Cancel(TimerId timerId)
+{
+    if (timerId.index >= _timers.size()
+        || _timers[timerId.index].generation != timerId.generation)
+    {
+        return false;
+    }
+    Unlink(timerId.index);
+    Free(timerId.index);
+    return true;
+}
+
+uint64_t TimerWheel::GetRemainingTicks(TimerId timerId) const
+{
+    if (timerId.index >= _timers.size()
+        || _timers[timerId.index].generation != timerId.generation)
+    {
+        return 0;
+    }
+    return _timers[timerId.index].expires - _tick;
+}
+
+void TimerWheel::Reserve(size_t capacity)
+{
+    size_t const oldCapacity = _timers.size();
+    if (capacity <= oldCapacity)
+    {
+        return;
+    }
+
+    // Timers are referred to by index, so the scheduled ones stay where they are, and the new ones join the free list
+    _timers.resize(capacity);
+    for (size_t t = oldCapacity; t < capacity; t++)
+    {
+        _timers[t].next = (t + 1 < capacity) ? t + 1 : _freeHead;
+        _timers[t].generation = 0;
+    }
+    _freeHead = oldCapacity;
+}
+
+size_t TimerWheel::GetCapacity() const
+{
+    return _timers.size();
+}
+
+void TimerWheel::Reset(uint64_t tick)
+{
+    for (uint32_t& head : _slotHeads)
+    {
+        uint32_t timer = head;
+        while (timer != NO_TIMER)
+        {
+            uint32_t const next = _timers[timer].next;
+            Free(timer);
+            timer = next;
+        }
+        head = NO_TIMER;
+    }
+    _tick = tick;
+}
+
+void TimerWheel::Advance()
+{
+    _tick++;
+
+    /* Each time a wheel completes a full turn,
+       the next slot of the coarser wheel is moved down */
+    for (unsigned level = 1; level < LEVELS; level++)
+    {
+        if ((_tick & ((uint64_t(1) << (SLOT_BITS * level)) - 1)) != 0)
+        {
+            break;
+        }
+        Cascade(level);
+    }
+
+    /* Move the current slot to the firing list first,
+       so that callbacks can safely schedule new timers or cancel the ones not fired yet */
+    uint32_t const slot = _tick & (SLOTS - 1);
+    _slotHeads[FIRING_SLOT] = _slotHeads[slot];
+    _slotHeads[slot] = NO_TIMER;
+    for (uint32_t timer = _slotHeads[FIRING_SLOT]; timer != NO_TIMER; timer = _timers[timer].next)
+    {
+        _timers[timer].slot = FIRING_SLOT;
+    }
+
+    while (_slotHeads[FIRING_SLOT] != NO_TIMER)
+    {
+        uint32_t const timer = _slotHeads[FIRING_SLOT];
+        Callback const callback = _timers[timer].callback;
+        void* const object = _timers[timer].object;
+
+        Unlink(timer);
+        Free(timer);
+        callback(object);
+    }
+}
+
+uint64_t TimerWheel::GetTick() const
+{
+    return _tick;
+}
+
+TimerWheel::TimerId TimerWheel::ScheduleCallback(
+    uint64_t delay, Callback callback, void* object)
+{
+    if (_freeHead == NO_TIMER)
+    {
+        throw "Error: Timer wheel capacity exceeded.";
+    }
+
+    uint32_t const timer = _freeHead;
+    _freeHead = _timers[timer].next;
+
+    _timers[timer].expires = _tick + (delay > 0 ? delay : 1);
+    _timers[timer].callback = callback;
+    _timers[timer].object = object;
+    Insert(timer);
+
+    return {timer, _timers[timer].generation};
+}
+
+void TimerWheel::Insert(uint32_t timer)
+{
+    // Timers too far in the future wait in the coarsest wheel, and get reinserted later
+    uint64_t const maxDelta = (uint64_t(1) << (SLOT_BITS * LEVELS)) - 1;
+    uint64_t delta = _timers[timer].expires - _tick;
+    uint64_t expires = _timers[timer].expires;
+    if (delta > maxDelta)
+    {
+        delta = maxDelta;
+        expires = _tick + maxDelta;
+    }
+
+    // Find the finest wheel that can hold the timer
+    unsigned level = 0;
+    while (level + 1 < LEVELS && delta >= (uint64_t(1) << (SLOT_BITS * (level + 1))))
+    {
+        level++;
+    }
+    uint32_t const slot = level * SLOTS + ((expires >> (SLOT_BITS * level)) & (SLOTS - 1));
+
+    Timer& t = _timers[timer];
+    t.slot = slot;
+    t.prev = NO_TIMER;
+    t.next = _slotHeads[slot];
+    if (t.next != NO_TIMER)
+    {
+        _timers[t.next].prev = timer;
+    }
+    _slotHeads[slot] = timer;
+}
+
+void TimerWheel::Unlink(uint32_t timer)
+{
+    Timer& t = _timers[timer];
+    if (t.prev != NO_TIMER)
+    {
+        _timers[t.prev].next = t.next;
+    }
+    else
+    {
+        _slotHeads[t.slot] = t.next;
+    }
+    if (t.next != NO_TIMER)
+    {
+        _timers[t.next].prev = t.prev;
+    }
+}
+
+void TimerWheel::Free(uint32_t timer)
+{
+    // A new generation invalidates all handles to the timer
+    _timers[timer].generation++;
+    _timers[timer].next = _freeHead;
+    _freeHead = timer;
+}
+
+void TimerWheel::Cascade(unsigned level)
+{
+    uint32_t const slot = level * SLOTS + ((_tick >> (SLOT_BITS * level)) & (SLOTS - 1));
+    uint32_t timer = _slotHeads[slot];
+    _slotHeads[slot] = NO_TIMER;
+
+    while (timer != NO_TIMER)
+    {
+        uint32_t const next = _timers[timer].next;
+        Insert(timer);
+        timer = next;
+    }
+}
@@ -0,0 +1,205 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * A class for a hierarchical timing wheel,
+ * which schedules callbacks to be called at some future tick.
+ * 
+ * Timers are kept in slots of several wheels, each wheel being coarser than the previous one.
+ * Timers that are close to expiring are in the finest wheel, one slot per tick.
+ * Timers further in the future are in coarser wheels,
+ * and are moved down to finer wheels as their time comes closer.
+ * That way scheduling and cancelling a timer is O(1),
+ * and advancing the wheel by a tick only touches the timers that expire on that tick,
+ * instead of touching every counter of every object each tick.
+ * 
+ * All timers come from a pool that is allocated up front, and grows only when asked to,
+ * so scheduling never allocates.
+ */
+class TimerWheel
+{
+
+  public:
+
+    /// Handle to a scheduled timer, used to cancel it
+    struct TimerId
+    {
+        uint32_t index;
+        uint32_t generation;
+    };
+
+  public:
+
+    /**
+     * Creates a timer wheel at tick 0
+     * 
+     * @param[in] capacity (optional)
+     *  Maximum number of timers that can be scheduled at the same time
+     */
+    TimerWheel(
+        size_t capacity = CAPACITY_DEFAULT
+    );
+
+    /**
+     * Schedules a member function of an object to be called after the given number of ticks
+     * 
+     * @param[in] delay
+     *  Number of ticks after which the function will be called.
+     *  A delay of 0 is treated as 1, since the current tick has already been processed.
+     * @param[in] object
+     *  Pointer to the object whose function will be called
+     * 
+     * @return handle to the scheduled timer
+     */
+    template <class ObjectType, void (ObjectType::*Handler)()>
+    TimerId Schedule(uint64_t delay, ObjectType* object);
+
+    /**
+     * Cancels a scheduled timer, if it has not expired yet
+     * 
+     * @param[in] timerId
+     *  Handle to the timer to be cancelled
+     * 
+     * @return true if the timer was cancelled, false if it had already expired or been cancelled
+     */
+    bool Cancel(TimerId timerId);
+
+    /**
+     * Returns the number of ticks left until a scheduled timer expires
+     * 
+     * @param[in] timerId
+     *  Handle to the timer
+     * 
+     * @return ticks until the timer expires, or 0 if it has already expired or been cancelled
+     */
+    uint64_t GetRemainingTicks(TimerId timerId) const;
+
+    /**
+     * Makes room for at least the given number of timers, keeping the scheduled ones
+     * 
+     * @param[in] capacity
+     *  Number of timers that can be scheduled at the same time
+     */
+    void Reserve(size_t capacity);
+
+    /**
+     * Returns the number of timers that can be scheduled at the same time
+     */
+    size_t GetCapacity() const;
+
+    /**
+     * Cancels all scheduled timers, and moves the wheel to the given tick.
+     * Handles to the cancelled timers become invalid.
+     * 
+     * @param[in] tick
+     *  The new current tick of the wheel
+     */
+    void Reset(uint64_t tick);
+
+    /**
+     * Advances the wheel by one tick,
+     * and calls the functions of all timers that expire on the new tick.
+     * 
+     * This function is supposed to be called once each tick.
+     */
+    void Advance();
+
+    /**
+     * Returns the current tick of the wheel
+     */
+    uint64_t GetTick() const;
+
+  private:
+
+    /// Number of bits of the tick used to index slots in a single wheel
+    static constexpr unsigned SLOT_BITS = 6;
+
+    /// Number of slots in each wheel
+    static constexpr unsigned SLOTS = 1 << SLOT_BITS;
+
+    /// Number of wheels, from the finest to the coarsest
+    static constexpr unsigned LEVELS = 4;
+
+    /// Index of the list holding the timers that are being fired on the current tick
+    static constexpr uint32_t FIRING_SLOT = LEVELS * SLOTS;
+
+    /// Index used in place of a pointer to no timer
+    static constexpr uint32_t NO_TIMER = UINT32_MAX;
+
+    /// The default capacity of the wheel, in timers
+    static constexpr size_t CAPACITY_DEFAULT = 1024;
+
+    /// A function called when a timer expires, with the object it was scheduled for
+    using Callback = void (*)(void*);
+
+    /// A scheduled timer, which lives in a slot's doubly linked list
+    struct Timer
+    {
+        uint64_t expires;
+        Callback callback;
+        void* object;
+        uint32_t next;
+        uint32_t prev;
+        uint32_t slot;
+        uint32_t generation;
+    };
+
+  private: /* functions */
+
+    /**
+     * Calls the handler of the given object.
+     * Instances of this function are what the timers' callbacks point to.
+     */
+    template <class ObjectType, void (ObjectType::*Handler)()>
+    static void CallHandler(void* object);
+
+    /**
+     * Takes a timer from the pool and puts it in the wheel
+     * 
+     * @return handle to the scheduled timer
+     */
+    TimerId ScheduleCallback(uint64_t delay, Callback callback, void* object);
+
+    /// Puts the timer in the slot corresponding to its expiry time
+    void Insert(uint32_t timer);
+
+    /// Removes the timer from the slot where it is
+    void Unlink(uint32_t timer);
+
+    /// Returns the timer to the pool
+    void Free(uint32_t timer);
+
+    /// Moves all timers of the given slot down to finer wheels
+    void Cascade(unsigned level);
+
+  private: /* variables */
+
+    /// Pool of all timers, both scheduled and free
+    std::vector<Timer> _timers;
+
+    /// Head of the list of free timers in the pool
+    uint32_t _freeHead;
+
+    /* Heads of the lists of timers in each slot of each wheel,
+       followed by the head of the list of timers being fired */
+    std::array<uint32_t, LEVELS * SLOTS + 1> _slotHeads;
+
+    /// The current tick
+    uint64_t _tick;
+};
+
+template <class ObjectType, void (ObjectType::*Handler)()>
+TimerWheel::TimerId TimerWheel::Schedule(uint64_t delay, ObjectType* object)
+{
+    return ScheduleCallback(delay, &CallHandler<ObjectType, Handler>, object);
+}
+
+template <class ObjectType, void (ObjectType::*Handler)()>
+void TimerWheel::CallHandler(void* object)
+{
+    (static_cast<ObjectType*>(object)->*Handler)();
+}
@@ -0,0 +1,185 @@
+#include "BatchEnvironment.h"
+
+#include "../AI/ScriptedBot.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+
+// Maximum size of a snapshot of a match, which every match measures its own initial state with
+size_t const SNAPSHOT_PROBE_CAPACITY = 1024 * 1024;
+
+// Distance that the policy's fighter moves on a tick at most
+float const AGENT_SPEED = 10.f;
+
+// Value above which an action's button is held
+float const BUTTON_THRESHOLD = 0.5f;
+
+// Matches are taken by threads a few at a time, since a single match is little work
+size_t const ENVIRONMENTS_CHUNK_SIZE = 8;
+
+} // namespace
+
+namespace FaceFight
+{
+
+BatchEnvironment::BatchEnvironment(BatchEnvironmentSettings const& settings, MatchAssets const& assets)
+    : _settings(settings),
+    _assets(assets),
+    _threadPool(settings.workersCount)
+{
+}
+
+void BatchEnvironment::Reset(size_t count, float* observations)
+{
+    _environments.clear();
+    _environments.resize(count);
+
+    ByteBuffer probe(SNAPSHOT_PROBE_CAPACITY);
+    for (size_t e = 0; e < count; e++)
+    {
+        Environment& environment = _environments[e];
+
+        /* Each match steps on a single thread, so it has no workers of its own.
+           Whichever worker steps it, the match records its commands as its own thread 0 */
+        MatchSettings matchSettings;
+        matchSettings.mode = GameMode::Versus;
+        matchSettings.seed = _settings.seed + e;
+        matchSettings.size = _settings.size;
+        matchSettings.maxEnemies = 1;
+        matchSettings.maxProjectiles = _settings.maxProjectiles;
+        matchSettings.workersCount = 0;
+        environment.match.reset(new Match(matchSettings, _assets));
+
+        // Initial state is kept in a buffer of exactly its size, since there may be thousands of them
+        probe.Clear();
+        environment.match->SaveSnapshot(probe);
+        environment.initialState.reset(new ByteBuffer(probe.GetSize()));
+        environment.initialState->WriteArray(probe.GetData(), probe.GetSize());
+
+        environment.episode = 0;
+        environment.agentHealth = environment.match->GetOpponent().GetHealth();
+        environment.botHealth = environment.match->GetPlayer().GetHealth();
+        Observe(environment, observations + e * OBSERVATION_SIZE);
+    }
+}
+
+void BatchEnvironment::Step(float const* actions, float* observations, float* rewards, uint8_t* dones)
+{
+    _threadPool.ParallelFor(_environments.size(), [&](size_t begin, size_t end) {
+        for (size_t e = begin; e < end; e++)
+        {
+            StepEnvironment(e, actions + e * ACTION_SIZE, observations + e * OBSERVATION_SIZE,
+                rewards[e], dones[e]);
+        }
+    }, ENVIRONMENTS_CHUNK_SIZE);
+}
+
+size_t BatchEnvironment::GetCount() const
+{
+    return _environments.size();
+}
+
+uint64_t BatchEnvironment::GetEpisodesCount(size_t e) const
+{
+    return _environments[e].episode;
+}
+
+void BatchEnvironment::StepEnvironment(size_t e, float const* action, float* observation, float& reward, uint8_t& done)
+{
+    Environment& environment = _environments[e];
+    Match& match = *environment.match;
+    Entity const& agent = match.GetOpponent();
+    Entity const& bot = match.GetPlayer();
+
+    // Policy moves its fighter in a direction, as far as it can go in a tick
+    FighterInput agentInput;
+    agentInput.target = agent.GetPosition() + AGENT_SPEED * sf::Vector2f(
+        std::max(-1.f, std::min(action[0], 1.f)),
+        std::max(-1.f, std::min(action[1], 1.f)));
+    agentInput.punch = action[2] > BUTTON_THRESHOLD;
+    agentInput.throwFist = action[3] > BUTTON_THRESHOLD;
+
+    match.Update(ScriptedBot::GetInput(match, 0), agentInput);
+
+    // Policy is rewarded for the damage it deals, and for the damage it avoids
+    int const agentHealth = agent.GetHealth();
+    int const botHealth = bot.GetHealth();
+    reward = (float)((environment.botHealth - botHealth) - (environment.agentHealth - agentHealth))
+        / Entity::MAX_HEALTH;
+    environment.agentHealth = agentHealth;
+    environment.botHealth = botHealth;
+
+    bool const won = botHealth <= 0 && agentHealth > 0;
+    bool const lost = agentHealth <= 0 && botHealth > 0;
+    reward += won ? 1.f : lost ? -1.f : 0.f;
+    done = agentHealth <= 0 || botHealth <= 0 || match.GetTick() >= _settings.maxTicks;
+
+    if (done)
+    {
+        RestartEpisode(e);
+    }
+    Observe(environment, observation);
+}
+
+void BatchEnvironment::RestartEpisode(size_t e)
+{
+    Environment& environment = _environments[e];
+    environment.episode++;
+
+    // Each episode of each match gets its own seed, so that no two of them play out the same
+    environment.initialState->Rewind();
+    environment.match->LoadSnapshot(*environment.initialState);
+    environment.match->SetSeed(_settings.seed + e + environment.episode * _environments.size());
+
+    environment.agentHealth = environment.match->GetOpponent().GetHealth();
+    environment.botHealth = environment.match->GetPlayer().GetHealth();
+}
+
+void BatchEnvironment::Observe(Environment const& environment, float* observation) const
+{
+    Match const& match = *environment.match;
+    Entity const& agent = match.GetOpponent();
+    Entity const& bot = match.GetPlayer();
+    sf::Vector2f const agentPosition = agent.GetPosition();
+    sf::Vector2f const botPosition = bot.GetPosition();
+
+    // The nearest fist thrown by the bot is the one the policy has to dodge first
+    ProjectileSystem const& projectiles = match.GetProjectiles();
+    sf::Vector2f nearestFistOffset;
+    float nearestFistDistanceSquared = std::numeric_limits<float>::max();
+    for (size_t p = 0; p < projectiles.GetCount(); p++)
+    {
+        if (projectiles.GetTeam(p) != ProjectileSystem::Team::Player)
+        {
+            continue;
+        }
+        sf::Vector2f const offset = projectiles.GetPosition(p) - agentPosition;
+        float const distanceSquared = offset.x * offset.x + offset.y * offset.y;
+        if (distanceSquared < nearestFistDistanceSquared)
+        {
+            nearestFistDistanceSquared = distanceSquared;
+            nearestFistOffset = offset;
+        }
+    }
+    bool const fistThrown = nearestFistDistanceSquared < std::numeric_limits<float>::max();
+
+    observation[0] = agentPosition.x / _settings.size.x;
+    observation[1] = agentPosition.y / _settings.size.y;
+    observation[2] = botPosition.x / _settings.size.x;
+    observation[3] = botPosition.y / _settings.size.y;
+    observation[4] = (float)agent.GetHealth() / Entity::MAX_HEALTH;
+    observation[5] = (float)bot.GetHealth() / Entity::MAX_HEALTH;
+    observation[6] = agent.CanPunch() ? 1.f : 0.f;
+    observation[7] = bot.CanPunch() ? 1.f : 0.f;
+    observation[8] = agent.IsGettingPunched() ? 1.f : 0.f;
+    observation[9] = bot.IsGettingPunched() ? 1.f : 0.f;
+    observation[10] = nearestFistOffset.x / _settings.size.x;
+    observation[11] = nearestFistOffset.y / _settings.size.y;
+    observation[12] = fistThrown ? 1.f : 0.f;
+    observation[13] = (float)match.GetTick() / _settings.maxTicks;
+}
+
+} // namespace FaceFight
@@ -0,0 +1,198 @@
+#pragma once
+
+#include "../Match.h"
+
+#include "../Parallel/ThreadPool.h"
+#include "../Serialization/ByteBuffer.h"
+
+#include <SFML/System.hpp>
+
+#include <memory>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace FaceFight
+{
+
+/// How the matches of a batch environment are set up
+struct BatchEnvironmentSettings
+{
+    /// Seed of the first match, each next match takes the next seed
+    uint64_t seed = 0;
+
+    /// Size of the arena of every match
+    sf::Vector2f size;
+
+    /// Number of ticks after which an episode ends even if no one has won
+    uint64_t maxTicks = 60 * Match::TICK_RATE;
+
+    /// Maximum number of fists in flight in a single match
+    size_t maxProjectiles = 64;
+
+    /// Number of worker threads stepping matches, besides the calling thread
+    size_t workersCount = ThreadPool::GetDefaultWorkersCount();
+};
+
+/**
+ * A class for many independent duels stepped in lockstep, on which bot policies are trained.
+ * 
+ * In every match, the policy being trained controls the opponent,
+ * and the player is controlled by a scripted bot.
+ * Observations, actions, rewards and ends of episodes of all matches
+ * are passed in flat arrays owned by the caller, one row per match,
+ * so they can be handed to a training framework as they are.
+ * 
+ * Matches are spread across a pool of threads, each match stepped on a single thread.
+ * Every match allocates all of its memory when the environment is reset,
+ * so stepping doesn't allocate at all.
+ * An episode that ends is restarted right away from the match's initial state with a new seed,
+ * and the observation written for it is the first one of the new episode.
+ */
+class BatchEnvironment
+{
+
+  public:
+
+    /**
+     * Number of floats describing what the policy sees in a single match:
+     * its own and the bot's position, relative to the arena's size,
+     * its own and the bot's health, relative to the maximum health,
+     * whether it and the bot can punch, whether it and the bot are getting punched,
+     * the offset to the nearest fist thrown at it, relative to the arena's size,
+     * whether there is such a fist, and how far the episode has gone
+     */
+    static constexpr size_t OBSERVATION_SIZE = 14;
+
+    /**
+     * Number of floats of an action in a single match:
+     * the direction in which to move, each coordinate from -1 to 1,
+     * and whether the punch and the throw buttons are held, when above 0.5
+     */
+    static constexpr size_t ACTION_SIZE = 4;
+
+  public:
+
+    /**
+     * Sets up an environment without any matches, until it is reset
+     * 
+     * @param[in] settings
+     *  How the matches are set up
+     * @param[in] assets
+     *  Resources of the matches, loaded without textures, which have to outlive the environment
+     */
+    BatchEnvironment(BatchEnvironmentSettings const& settings, MatchAssets const& assets);
+
+    BatchEnvironment(BatchEnvironment const&) = delete;
+    BatchEnvironment& operator=(BatchEnvironment const&) = delete;
+
+    /**
+     * Creates the given number of new matches, in place of the previous ones,
+     * and writes what the policy sees in each of them
+     * 
+     * @param[in] count
+     *  Number of matches
+     * @param[in] observations
+     *  Array of count * OBSERVATION_SIZE floats to which the observations are written
+     */
+    void Reset(size_t count, float* observations);
+
+    /**
+     * Steps every match once, with the policy's actions
+     * 
+     * @param[in] actions
+     *  Array of GetCount() * ACTION_SIZE floats with the actions taken in each match
+     * @param[in] observations
+     *  Array of GetCount() * OBSERVATION_SIZE floats to which the observations are written
+     * @param[in] rewards
+     *  Array of GetCount() floats to which the rewards are written:
+     *  the damage dealt minus the damage taken, relative to the maximum health,
+     *  and one more or one less when the match is won or lost
+     * @param[in] dones
+     *  Array of GetCount() flags telling which episodes ended on this step
+     */
+    void Step(float const* actions, float* observations, float* rewards, uint8_t* dones);
+
+    /**
+     * Returns the number of matches
+     */
+    size_t GetCount() const;
+
+    /**
+     * Returns the number of episodes that ended in a match since it was reset
+     * 
+     * @param[in] e
+     *  Index of the match
+     */
+    uint64_t GetEpisodesCount(size_t e) const;
+
+  private:
+
+    /// A match and what is needed to restart its episodes
+    struct Environment
+    {
+        std::unique_ptr<Match> match;
+
+        /// Snapshot of the match as it was created, from which every episode starts
+        std::unique_ptr<ByteBuffer> initialState;
+
+        /// Number of episodes that ended so far
+        uint64_t episode;
+
+        /// Health of the policy's and the bot's fighters after the last step
+        int agentHealth;
+        int botHealth;
+    };
+
+  private: /* functions */
+
+    /**
+     * Steps a single match, restarting its episode if it ended
+     * 
+     * @param[in] e
+     *  Index of the match
+     * @param[in] action
+     *  ACTION_SIZE floats of the policy's action
+     * @param[in] observation
+     *  OBSERVATION_SIZE floats to which the observation is written
+     * @param[in] reward
+     *  Where the reward is written
+     * @param[in] done
+     *  Where the end of the episode is written
+     */
+    void StepEnvironment(size_t e, float const* action, float* observation, float& reward, uint8_t& done);
+
+    /**
+     * Restores a match to its initial state, with a seed of its next episode
+     * 
+     * @param[in] e
+     *  Index of the match
+     */
+    void RestartEpisode(size_t e);
+
+    /**
+     * Writes what the policy sees in a match
+     * 
+     * @param[in] environment
+     *  The match
+     * @param[in] observation
+     *  OBSERVATION_SIZE floats to which the observation is written
+     */
+    void Observe(Environment const& environment, float* observation) const;
+
+  private: /* variables */
+
+    /// How the matches are set up
+    BatchEnvironmentSettings _settings;
+
+    /// Resources of the matches
+    MatchAssets const& _assets;
+
+    /// The matches
+    std::vector<Environment> _environments;
+
+    /// Threads among which matches are spread
+    ThreadPool _threadPool;
+};
+
+} // namespace FaceFight
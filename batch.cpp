@@ -0,0 +1,144 @@
+#include "Game/Training/BatchEnvironment.h"
+#include "Game/Resources/ResourceHandler.hpp"
+#include "Game/Resources/ResourceIDs.hpp"
+
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+// Number of memory allocations made by the whole program so far
+std::atomic<size_t> allocationsCount(0);
+
+// Value that the arrays filled by the environment hold before each call, so unwritten values stand out
+float const UNWRITTEN_FLOAT = NAN;
+uint8_t const UNWRITTEN_FLAG = 0xFF;
+
+} // namespace
+
+// Every allocation is counted, so that stepping can be checked not to allocate
+void* operator new(size_t size)
+{
+    allocationsCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size > 0 ? size : 1))
+    {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+    std::free(memory);
+}
+
+int main(int argc, char* argv[])
+{
+    /* A benchmark of the training environment is set up with the next, optional arguments:
+       number of matches, number of steps, and number of worker threads */
+    size_t const count = argc > 1 ? std::stoul(argv[1]) : 256;
+    size_t const stepsCount = argc > 2 ? std::stoul(argv[2]) : 1000;
+
+    FaceFight::BatchEnvironmentSettings settings;
+    settings.size = sf::Vector2f(1920.f, 1080.f);
+    settings.maxTicks = 10 * FaceFight::Match::TICK_RATE;
+    if (argc > 3)
+    {
+        settings.workersCount = std::stoul(argv[3]);
+    }
+
+    // Images are enough to build the masks, without a window there are no textures
+    using FaceFight::Resources::Texture::Id;
+    std::string const resourcesDir = "Game/Resources/";
+    Resources::ResourceHandler<Id, sf::Image> imageHandler;
+    imageHandler.Load(Id::Naruto, resourcesDir + "Textures/naruto.png");
+    imageHandler.Load(Id::Sasuke, resourcesDir + "Textures/sasuke.png");
+    imageHandler.Load(Id::Fist, resourcesDir + "Textures/fist.png");
+    FaceFight::MatchAssets const assets(
+        imageHandler.Get(Id::Naruto),
+        imageHandler.Get(Id::Sasuke),
+        imageHandler.Get(Id::Fist),
+        resourcesDir + "Arenas/arena.txt");
+
+    using FaceFight::BatchEnvironment;
+    BatchEnvironment environment(settings, assets);
+    std::vector<float> observations(count * BatchEnvironment::OBSERVATION_SIZE, UNWRITTEN_FLOAT);
+    std::vector<float> actions(count * BatchEnvironment::ACTION_SIZE);
+    std::vector<float> rewards(count);
+    std::vector<uint8_t> dones(count);
+    environment.Reset(count, observations.data());
+
+    // Every value the environment should have written is checked after every call
+    auto const checkWritten = [&](std::string const& call) {
+        for (float const observation : observations)
+        {
+            if (!std::isfinite(observation))
+            {
+                throw "Error: " + call + " left an observation unwritten.";
+            }
+        }
+        for (size_t e = 0; e < count; e++)
+        {
+            if (!std::isfinite(rewards[e]) || dones[e] > 1)
+            {
+                throw "Error: " + call + " left a reward or an end of episode unwritten.";
+            }
+        }
+    };
+    std::fill(rewards.begin(), rewards.end(), 0.f);
+    std::fill(dones.begin(), dones.end(), 0);
+    checkWritten("Reset");
+
+    // The policy is stood in for by actions that change every few steps, and differ between matches
+    sf::Time stepTime;
+    size_t stepAllocationsCount = 0;
+    size_t endedCount = 0;
+    for (size_t step = 0; step < stepsCount; step++)
+    {
+        for (size_t a = 0; a < actions.size(); a++)
+        {
+            actions[a] = std::sin((float)(a * 7 + step / 10 * 13));
+        }
+        std::fill(observations.begin(), observations.end(), UNWRITTEN_FLOAT);
+        std::fill(rewards.begin(), rewards.end(), UNWRITTEN_FLOAT);
+        std::fill(dones.begin(), dones.end(), UNWRITTEN_FLAG);
+
+        size_t const allocationsBefore = allocationsCount.load(std::memory_order_relaxed);
+        sf::Clock clock;
+        environment.Step(actions.data(), observations.data(), rewards.data(), dones.data());
+        stepTime += clock.getElapsedTime();
+        stepAllocationsCount += allocationsCount.load(std::memory_order_relaxed) - allocationsBefore;
+
+        checkWritten("Step");
+        for (uint8_t const done : dones)
+        {
+            endedCount += done;
+        }
+    }
+
+    double const matchSteps = (double)count * stepsCount;
+    std::cout << "Matches: " << count
+        << ", steps: " << stepsCount
+        << ", episodes ended: " << endedCount
+        << ", step: " << stepTime.asMicroseconds() * 1000.0 / matchSteps << " ns per match"
+        << ", match steps per second: " << matchSteps / stepTime.asSeconds()
+        << ", allocations while stepping: " << stepAllocationsCount
+        << std::endl;
+
+    if (stepAllocationsCount > 0)
+    {
+        throw "Error: Stepping the environment allocated memory.";
+    }
+    return 0;
+}
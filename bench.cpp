@@ -0,0 +1,92 @@
+#include "Game/Entities/Entity.h"
+
+#include <SFML/System.hpp>
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+// Entities are punched once per this many frames, so that their animations are playing most of the time
+size_t const PUNCH_PERIOD = 15;
+
+// Distance between neighbouring entities of the grid they start on
+float const GRID_SPACING = 10.f;
+
+// Number of entities in a row of the grid
+size_t const GRID_WIDTH = 100;
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    /* A benchmark of the per-entity update cost is set up with the next, optional arguments:
+       number of entities, and number of frames */
+    size_t const entitiesCount = argc > 1 ? std::stoul(argv[1]) : 10000;
+    size_t const framesCount = argc > 2 ? std::stoul(argv[2]) : 600;
+
+    // Entities fight in pairs, without textures, as only their updates are measured
+    std::vector<std::unique_ptr<FaceFight::Entity>> entities;
+    for (size_t e = 0; e < entitiesCount; e++)
+    {
+        entities.emplace_back(new FaceFight::Entity());
+        entities.back()->Move(sf::Vector2f(
+            (e % GRID_WIDTH) * GRID_SPACING,
+            (e / GRID_WIDTH) * GRID_SPACING));
+    }
+    for (size_t e = 0; e + 1 < entitiesCount; e += 2)
+    {
+        entities[e]->SetEnemy(entities[e + 1].get());
+        entities[e + 1]->SetEnemy(entities[e].get());
+    }
+
+    sf::Time updateTime;
+    sf::Time moveTime;
+    for (size_t frame = 0; frame < framesCount; frame++)
+    {
+        // Punches are played the way the command queue plays them, without a match around the entities
+        if (frame % PUNCH_PERIOD == 0)
+        {
+            for (size_t e = 0; e + 1 < entitiesCount; e += 2)
+            {
+                FaceFight::Commands::Command command{};
+                command.type = FaceFight::Commands::Command::Type::PlayAnimation;
+                command.animation = FaceFight::Commands::Animation::Punch;
+                entities[e]->Execute(command);
+
+                command.type = FaceFight::Commands::Command::Type::Knockback;
+                command.direction = sf::Vector2f(1.f, 0.f);
+                entities[e + 1]->Execute(command);
+
+                command.type = FaceFight::Commands::Command::Type::PlayAnimation;
+                command.animation = FaceFight::Commands::Animation::GetPunched;
+                entities[e + 1]->Execute(command);
+            }
+        }
+
+        sf::Clock clock;
+        for (std::unique_ptr<FaceFight::Entity>& entity : entities)
+        {
+            entity->Update();
+        }
+        updateTime += clock.restart();
+
+        for (std::unique_ptr<FaceFight::Entity>& entity : entities)
+        {
+            entity->Move(sf::Vector2f(0.01f, 0.f));
+        }
+        moveTime += clock.getElapsedTime();
+    }
+
+    double const updates = (double)entitiesCount * framesCount;
+    std::cout << "Entities: " << entitiesCount
+        << ", frames: " << framesCount
+        << ", update: " << updateTime.asMicroseconds() * 1000.0 / updates << " ns per entity"
+        << ", move: " << moveTime.asMicroseconds() * 1000.0 / updates << " ns per entity"
+        << std::endl;
+
+    return 0;
+}
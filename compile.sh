@@ -1,2 +1,8 @@
 export LD_LIBRARY_PATH=SFML-2.5.1/lib
-g++ main.cpp Game/*.cpp Game/Entities/*.cpp -o game -I SFML-2.5.1/include -L SFML-2.5.1/lib -l sfml-graphics -l sfml-audio -l sfml-window -l sfml-system
\ No newline at end of file
+g++ -std=c++20 main.cpp Game/*.cpp Game/*/*.cpp -o game -pthread -I SFML-2.5.1/include -L SFML-2.5.1/lib -l sfml-graphics -l sfml-audio -l sfml-window -l sfml-network -l sfml-system
+g++ -std=c++20 dedicated.cpp Game/Match.cpp Game/DedicatedServer.cpp Game/*/*.cpp -o dedicated-server -pthread -I SFML-2.5.1/include -L SFML-2.5.1/lib -l sfml-graphics -l sfml-window -l sfml-network -l sfml-system
+g++ -std=c++20 sweep.cpp Game/Match.cpp Game/*/*.cpp -o balance-sweep -pthread -I SFML-2.5.1/include -L SFML-2.5.1/lib -l sfml-graphics -l sfml-window -l sfml-network -l sfml-system
+g++ -std=c++20 -O2 bench.cpp Game/Match.cpp Game/*/*.cpp -o entity-bench -pthread -I SFML-2.5.1/include -L SFML-2.5.1/lib -l sfml-graphics -l sfml-window -l sfml-network -l sfml-system
+g++ -std=c++20 -O2 batch.cpp Game/Match.cpp Game/*/*.cpp -o batch-bench -pthread -I SFML-2.5.1/include -L SFML-2.5.1/lib -l sfml-graphics -l sfml-window -l sfml-network -l sfml-system
+g++ -std=c++20 -O2 scripts.cpp Game/Match.cpp Game/*/*.cpp -o script-bench -pthread -I SFML-2.5.1/include -L SFML-2.5.1/lib -l sfml-graphics -l sfml-window -l sfml-network -l sfml-system
+g++ -std=c++20 -O2 mlp.cpp Game/Match.cpp Game/*/*.cpp -o mlp-check -pthread -I SFML-2.5.1/include -L SFML-2.5.1/lib -l sfml-graphics -l sfml-window -l sfml-network -l sfml-system
\ No newline at end of file
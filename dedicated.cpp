@@ -0,0 +1,83 @@
+#include "Game/DedicatedServer.h"
+#include "Game/Resources/ResourceHandler.hpp"
+#include "Game/Resources/ResourceIDs.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+int main(int argc, char* argv[])
+{
+    /* A dedicated server is set up with the next arguments:
+       number of matches, port of the first side of the first match, seed of the first match,
+       width and height of the clients' screens,
+       and optionally the number of seconds to run, "bots" to play the sides without a client,
+       and the number of worker threads, one less than the number of hardware threads by default */
+    if (argc < 6)
+    {
+        throw "Error: Dedicated server needs a number of matches, a base port, a seed, a width and a height.";
+    }
+    FaceFight::DedicatedServerSettings settings;
+    settings.matchesCount = std::stoul(argv[1]);
+    settings.basePort = (unsigned short)std::stoul(argv[2]);
+    settings.seed = std::stoull(argv[3]);
+    settings.size = sf::Vector2f(std::stof(argv[4]), std::stof(argv[5]));
+    uint64_t seconds = UINT64_MAX / FaceFight::Match::TICK_RATE;
+    if (argc > 6)
+    {
+        seconds = std::stoull(argv[6]);
+    }
+    settings.botsForMissingClients = argc > 7 && std::string(argv[7]) == "bots";
+    if (argc > 8)
+    {
+        settings.workersCount = std::stoul(argv[8]);
+    }
+
+    // Images are enough to build the masks, without a window there are no textures
+    using FaceFight::Resources::Texture::Id;
+    std::string const resourcesDir = "Game/Resources/";
+    Resources::ResourceHandler<Id, sf::Image> imageHandler;
+    imageHandler.Load(Id::Naruto, resourcesDir + "Textures/naruto.png");
+    imageHandler.Load(Id::Sasuke, resourcesDir + "Textures/sasuke.png");
+    imageHandler.Load(Id::Fist, resourcesDir + "Textures/fist.png");
+    FaceFight::MatchAssets const assets(
+        imageHandler.Get(Id::Naruto),
+        imageHandler.Get(Id::Sasuke),
+        imageHandler.Get(Id::Fist),
+        resourcesDir + "Arenas/arena.txt");
+
+    FaceFight::DedicatedServer server(settings, assets);
+
+    // Reports how long matches take every second, and how many of them would fit on a single core
+    for (uint64_t s = 0; s < seconds; s++)
+    {
+        server.Run(FaceFight::Match::TICK_RATE);
+
+        size_t playing = 0;
+        sf::Time totalLatency;
+        sf::Time maxLatency;
+        for (size_t m = 0; m < server.GetMatchesCount(); m++)
+        {
+            if (server.IsPlaying(m))
+            {
+                playing++;
+                totalLatency += server.GetTickLatency(m);
+            }
+            maxLatency = std::max(maxLatency, server.GetMaxTickLatency(m));
+        }
+        sf::Int64 const meanLatency = playing > 0 ? totalLatency.asMicroseconds() / (sf::Int64)playing : 0;
+        sf::Int64 const tickPeriod = sf::seconds(1.f / FaceFight::Match::TICK_RATE).asMicroseconds();
+
+        std::cout << "Matches playing: " << playing << "/" << server.GetMatchesCount()
+            << ", tick: " << server.GetTickTime().asMicroseconds() << " us"
+            << " on " << server.GetThreadsCount() << " threads"
+            << ", match tick mean: " << meanLatency << " us, max: " << maxLatency.asMicroseconds() << " us"
+            << ", late ticks: " << server.GetLateTicksCount()
+            << ", matches per core at " << FaceFight::Match::TICK_RATE << " Hz: "
+            << (meanLatency > 0 ? tickPeriod / meanLatency : 0)
+            << std::endl;
+    }
+
+    return 0;
+}
@@ -1,8 +1,127 @@
 #include "Game/Game.h"
 
-int main()
+#include <cstdint>
+#include <string>
+
+int main(int argc, char* argv[])
 {
-    FaceFight::Game game;
+    // Survival, versus, server, client and planned duel modes are chosen with their arguments, duel is the default
+    FaceFight::GameMode mode = FaceFight::GameMode::Duel;
+    if (argc > 1 && std::string(argv[1]) == "survival")
+    {
+        mode = FaceFight::GameMode::Survival;
+    }
+    else if (argc > 1 && std::string(argv[1]) == "versus")
+    {
+        mode = FaceFight::GameMode::Versus;
+    }
+    else if (argc > 1 && std::string(argv[1]) == "server")
+    {
+        mode = FaceFight::GameMode::Server;
+    }
+    else if (argc > 1 && std::string(argv[1]) == "client")
+    {
+        mode = FaceFight::GameMode::Client;
+    }
+    else if (argc > 1 && std::string(argv[1]) == "planner")
+    {
+        mode = FaceFight::GameMode::PlannedDuel;
+    }
+
+    // The seed of the match can be given as the second argument, to replay the same match
+    uint64_t seed = 0;
+    if (argc > 2)
+    {
+        seed = std::stoull(argv[2]);
+    }
+
+    /* A versus match is connected with the next arguments:
+       side, local port, remote address, remote port,
+       and optionally artificial latency in milliseconds and packet loss in percent */
+    FaceFight::VersusSettings versus;
+    if (mode == FaceFight::GameMode::Versus)
+    {
+        if (argc < 7)
+        {
+            throw "Error: Versus mode needs a side, a local port, a remote address and a remote port.";
+        }
+        versus.side = std::stoul(argv[3]);
+        versus.localPort = (unsigned short)std::stoul(argv[4]);
+        versus.remoteAddress = argv[5];
+        versus.remotePort = (unsigned short)std::stoul(argv[6]);
+        if (argc > 7)
+        {
+            versus.latency = sf::milliseconds(std::stoi(argv[7]));
+            versus.jitter = versus.latency / 4.f;
+        }
+        if (argc > 8)
+        {
+            versus.lossRate = std::stof(argv[8]) / 100.f;
+        }
+    }
+
+    /* A server is connected with the next arguments: local port,
+       and optionally artificial latency in milliseconds and packet loss in percent.
+       It accepts the first client that contacts it */
+    if (mode == FaceFight::GameMode::Server)
+    {
+        if (argc < 4)
+        {
+            throw "Error: Server mode needs a local port.";
+        }
+        versus.localPort = (unsigned short)std::stoul(argv[3]);
+        if (argc > 4)
+        {
+            versus.latency = sf::milliseconds(std::stoi(argv[4]));
+            versus.jitter = versus.latency / 4.f;
+        }
+        if (argc > 5)
+        {
+            versus.lossRate = std::stof(argv[5]) / 100.f;
+        }
+    }
+
+    /* A client is connected with the next arguments:
+       local port, server address, server port,
+       and optionally artificial latency in milliseconds and packet loss in percent */
+    if (mode == FaceFight::GameMode::Client)
+    {
+        if (argc < 6)
+        {
+            throw "Error: Client mode needs a local port, a server address and a server port.";
+        }
+        versus.localPort = (unsigned short)std::stoul(argv[3]);
+        versus.remoteAddress = argv[4];
+        versus.remotePort = (unsigned short)std::stoul(argv[5]);
+        if (argc > 6)
+        {
+            versus.latency = sf::milliseconds(std::stoi(argv[6]));
+            versus.jitter = versus.latency / 4.f;
+        }
+        if (argc > 7)
+        {
+            versus.lossRate = std::stof(argv[7]) / 100.f;
+        }
+    }
+
+    /* Enemies of duel and survival modes can be controlled by a file given as the third argument,
+       a behavior tree if it is a text file, and the weights of a policy network otherwise */
+    std::string policyFile;
+    std::string behaviorFile;
+    if ((mode == FaceFight::GameMode::Duel || mode == FaceFight::GameMode::Survival) && argc > 3)
+    {
+        std::string const file = argv[3];
+        if (file.size() >= 4 && file.compare(file.size() - 4, 4, ".txt") == 0)
+        {
+            behaviorFile = file;
+        }
+        else
+        {
+            policyFile = file;
+        }
+    }
+
+    FaceFight::Game game(mode, seed, versus, policyFile, behaviorFile);
     game.Run();
 
     return 0;
@@ -0,0 +1,116 @@
+#include "Game/Match.h"
+#include "Game/Neural/QuantizedMlp.h"
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+// Layout of the weights file written when none is given
+uint32_t const WEIGHTS_MAGIC = 0x46464E4E; // "FFNN"
+uint32_t const WEIGHTS_VERSION = 1;
+
+// Widths of the layers of the network written when none is given, from the inputs to the outputs
+size_t const LAYER_WIDTHS[] = {
+    FaceFight::Match::POLICY_OBSERVATIONS_COUNT, 64, 64, FaceFight::Match::POLICY_ACTIONS_COUNT
+};
+
+/**
+ * Writes a value to a weights file as it is in memory
+ */
+template <class T>
+void WriteValue(std::ofstream& file, T value)
+{
+    file.write(reinterpret_cast<char const*>(&value), sizeof(T));
+}
+
+/**
+ * Writes a weights file of a network shaped like an enemy policy, with random weights and biases
+ */
+void WriteRandomWeights(std::string const& filename, std::mt19937& random)
+{
+    std::ofstream file(filename, std::ios::binary);
+    std::uniform_real_distribution<float> value(-1.f, 1.f);
+    size_t const layersCount = std::size(LAYER_WIDTHS) - 1;
+    WriteValue(file, WEIGHTS_MAGIC);
+    WriteValue(file, WEIGHTS_VERSION);
+    WriteValue(file, (uint32_t)layersCount);
+    for (size_t l = 0; l < layersCount; l++)
+    {
+        WriteValue(file, (uint32_t)LAYER_WIDTHS[l]);
+        WriteValue(file, (uint32_t)LAYER_WIDTHS[l + 1]);
+        for (size_t w = 0; w < (LAYER_WIDTHS[l] + 1) * LAYER_WIDTHS[l + 1]; w++)
+        {
+            WriteValue(file, value(random));
+        }
+    }
+    if (!file)
+    {
+        throw "Error: Cannot write weights file: " + filename;
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    /* A check that every kernel of the network gives the same outputs is set up with the next, optional arguments:
+       path of a weights file, where "random" writes one shaped like an enemy policy, number of rows, and seed */
+    std::string filename = argc > 1 ? argv[1] : "random";
+    size_t const rowsCount = argc > 2 ? std::stoul(argv[2]) : 4096;
+    std::mt19937 random(argc > 3 ? std::stoul(argv[3]) : 0);
+    if (filename == "random")
+    {
+        filename = (std::filesystem::temp_directory_path() / "mlp-check.weights").string();
+        WriteRandomWeights(filename, random);
+    }
+
+    using Kernel = QuantizedMlp::Kernel;
+    QuantizedMlp const scalar(filename, Kernel::Scalar);
+    std::vector<float> inputs(rowsCount * scalar.GetInputsCount());
+    std::uniform_real_distribution<float> input(-1.f, 1.f);
+    for (float& value : inputs)
+    {
+        value = input(random);
+    }
+
+    ThreadPool threadPool;
+    QuantizedMlp::Workspace scalarWorkspace(scalar, rowsCount);
+    std::vector<float> expected(rowsCount * scalar.GetOutputsCount());
+    scalar.Run(inputs.data(), rowsCount, expected.data(), scalarWorkspace, threadPool);
+
+    // Kernels are ordered from the narrowest, and a CPU that has one has all the narrower ones
+    Kernel const best = QuantizedMlp::GetBestKernel();
+    for (Kernel const kernel : {Kernel::Avx2, Kernel::AvxVnni})
+    {
+        if (kernel > best)
+        {
+            std::cout << QuantizedMlp::GetKernelName(kernel) << ": not supported by this CPU" << std::endl;
+            continue;
+        }
+
+        QuantizedMlp const mlp(filename, kernel);
+        QuantizedMlp::Workspace workspace(mlp, rowsCount);
+        std::vector<float> outputs(expected.size());
+        mlp.Run(inputs.data(), rowsCount, outputs.data(), workspace, threadPool);
+
+        size_t differentCount = 0;
+        for (size_t o = 0; o < outputs.size(); o++)
+        {
+            differentCount += outputs[o] != expected[o];
+        }
+        std::cout << QuantizedMlp::GetKernelName(kernel) << ": " << differentCount << " of "
+            << outputs.size() << " outputs differ from " << QuantizedMlp::GetKernelName(Kernel::Scalar)
+            << std::endl;
+        if (differentCount > 0)
+        {
+            throw "Error: Kernel gives different outputs: " + std::string(QuantizedMlp::GetKernelName(kernel));
+        }
+    }
+    return 0;
+}
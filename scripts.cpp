@@ -0,0 +1,71 @@
+#include "Game/Match.h"
+
+#include <SFML/System.hpp>
+
+#include <iostream>
+#include <string>
+
+namespace
+{
+
+/**
+ * Waits a few ticks at a time, as many times as given, counting every time it resumes
+ */
+Script Idle(ScriptScheduler& scripts, size_t waitsCount, size_t* resumesCount)
+{
+    for (size_t w = 0; w < waitsCount; w++)
+    {
+        co_await scripts.WaitTicks(1 + w % 3);
+        ++*resumesCount;
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    /* A benchmark of running scripts is set up with the next, optional arguments:
+       number of scripts running at the same time, and number of waits of each script */
+    size_t const scriptsCount = argc > 1 ? std::stoul(argv[1]) : 10000;
+    size_t const waitsCount = argc > 2 ? std::stoul(argv[2]) : 30;
+
+    // The scheduler starts as large as a match's, and has to grow for this many scripts
+    ScriptScheduler scripts(FaceFight::MatchSettings().maxScripts);
+
+    /* The first round grows the frame pool and the timing wheel, and the second one is measured,
+       starting and ending the same number of scripts without growing either */
+    size_t blocksCount = 0;
+    for (size_t round = 0; round < 2; round++)
+    {
+        size_t resumesCount = 0;
+        for (size_t s = 0; s < scriptsCount; s++)
+        {
+            scripts.Start(Idle(scripts, waitsCount, &resumesCount));
+        }
+        sf::Clock clock;
+        size_t ticksCount = 0;
+        while (scripts.GetRunningCount() > 0)
+        {
+            scripts.Update();
+            ticksCount++;
+        }
+        sf::Time const time = clock.getElapsedTime();
+
+        if (round == 0)
+        {
+            blocksCount = scripts.GetFramePool().GetBlocksCount();
+            continue;
+        }
+        std::cout << "Scripts: " << scriptsCount
+            << ", ticks: " << ticksCount
+            << ", resumes: " << resumesCount
+            << ", tick: " << (float)time.asMicroseconds() / ticksCount << " us"
+            << ", frame blocks: " << scripts.GetFramePool().GetBlocksCount()
+            << std::endl;
+        if (scripts.GetFramePool().GetBlocksCount() != blocksCount)
+        {
+            throw "Error: Frame pool grew after it was warm.";
+        }
+    }
+    return 0;
+}
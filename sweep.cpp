@@ -0,0 +1,73 @@
+#include "Game/Balance/BalanceSweep.h"
+#include "Game/Resources/ResourceHandler.hpp"
+#include "Game/Resources/ResourceIDs.hpp"
+
+#include <iostream>
+#include <string>
+
+int main(int argc, char* argv[])
+{
+    /* A balance sweep is set up with the next arguments:
+       path of the output table, "grid" or "random", number of parameter sets of a random search,
+       number of matches per parameter set, seed, width and height of the arena,
+       and any number of axes, each as parameter=min:max:steps */
+    if (argc < 8)
+    {
+        throw "Error: Balance sweep needs an output, a search, samples, matches per set, a seed, a width and a height.";
+    }
+    std::string const output = argv[1];
+    FaceFight::BalanceSweepSettings settings;
+    settings.search = std::string(argv[2]) == "random"
+        ? FaceFight::BalanceSweepSettings::Search::Random
+        : FaceFight::BalanceSweepSettings::Search::Grid;
+    settings.samplesCount = std::stoul(argv[3]);
+    settings.matchesPerSet = std::stoul(argv[4]);
+    settings.seed = std::stoull(argv[5]);
+    settings.size = sf::Vector2f(std::stof(argv[6]), std::stof(argv[7]));
+    for (int a = 8; a < argc; a++)
+    {
+        std::string const axisText = argv[a];
+        size_t const equals = axisText.find('=');
+        size_t const firstColon = axisText.find(':', equals);
+        size_t const secondColon = axisText.find(':', firstColon + 1);
+        if (equals == std::string::npos || firstColon == std::string::npos)
+        {
+            throw "Error: Axis has to be given as parameter=min:max:steps, got: " + axisText;
+        }
+        FaceFight::SweepAxis axis;
+        axis.parameter = axisText.substr(0, equals);
+        axis.min = std::stod(axisText.substr(equals + 1, firstColon - equals - 1));
+        axis.max = std::stod(axisText.substr(firstColon + 1, secondColon - firstColon - 1));
+        axis.steps = secondColon != std::string::npos ? std::stoul(axisText.substr(secondColon + 1)) : 1;
+        settings.axes.push_back(axis);
+    }
+
+    // Images are enough to build the masks, without a window there are no textures
+    using FaceFight::Resources::Texture::Id;
+    std::string const resourcesDir = "Game/Resources/";
+    Resources::ResourceHandler<Id, sf::Image> imageHandler;
+    imageHandler.Load(Id::Naruto, resourcesDir + "Textures/naruto.png");
+    imageHandler.Load(Id::Sasuke, resourcesDir + "Textures/sasuke.png");
+    imageHandler.Load(Id::Fist, resourcesDir + "Textures/fist.png");
+    FaceFight::MatchAssets const assets(
+        imageHandler.Get(Id::Naruto),
+        imageHandler.Get(Id::Sasuke),
+        imageHandler.Get(Id::Fist),
+        resourcesDir + "Arenas/arena.txt");
+
+    FaceFight::BalanceSweep sweep(settings, assets);
+    ColumnWriter table(output, sweep.GetColumns(), 1024);
+
+    sf::Clock clock;
+    sweep.Run(table);
+    float const seconds = clock.getElapsedTime().asSeconds();
+
+    size_t const matches = sweep.GetSetsCount() * settings.matchesPerSet;
+    std::cout << "Parameter sets: " << sweep.GetSetsCount()
+        << ", matches: " << matches
+        << ", time: " << seconds << " s"
+        << ", matches per second: " << matches / seconds
+        << std::endl;
+
+    return 0;
+}